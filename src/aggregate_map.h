@@ -0,0 +1,246 @@
+#pragma once
+
+#include <functional>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "binary_tree.h"
+
+namespace containers {
+// Monoids for aggregate_map. A monoid names its result as result_type and
+// has identity(), of(value) for a single mapped value and combine(a, b),
+// which has to be associative with identity() as its neutral element.
+template <class T>
+struct SumMonoid {
+  using result_type = T;
+  T identity() const { return T(); }
+  T of(const T& value) const { return value; }
+  T combine(const T& a, const T& b) const { return a + b; }
+};
+
+template <class T>
+struct MinMonoid {
+  using result_type = T;
+  T identity() const {
+    return std::numeric_limits<T>::has_infinity
+               ? std::numeric_limits<T>::infinity()
+               : std::numeric_limits<T>::max();
+  }
+  T of(const T& value) const { return value; }
+  T combine(const T& a, const T& b) const { return b < a ? b : a; }
+};
+
+template <class T>
+struct MaxMonoid {
+  using result_type = T;
+  T identity() const {
+    return std::numeric_limits<T>::has_infinity
+               ? -std::numeric_limits<T>::infinity()
+               : std::numeric_limits<T>::lowest();
+  }
+  T of(const T& value) const { return value; }
+  T combine(const T& a, const T& b) const { return a < b ? b : a; }
+};
+
+template <class T>
+struct CountMonoid {
+  using result_type = size_t;
+  size_t identity() const { return 0; }
+  size_t of(const T&) const { return 1; }
+  size_t combine(size_t a, size_t b) const { return a + b; }
+};
+
+// Keeps the combined mapped values of a subtree, in key order.
+template <class Value, class Monoid>
+struct MonoidSummary {
+  using summary_type = typename Monoid::result_type;
+
+  void operator()(summary_type& summary, const Value& value,
+                  const summary_type* left, const summary_type* right) const {
+    Monoid monoid;
+    summary = monoid.of(value.second);
+    if (left) summary = monoid.combine(*left, summary);
+    if (right) summary = monoid.combine(summary, *right);
+  }
+};
+
+// Ordered map whose tree keeps the mapped values of every subtree combined
+// by Monoid, so aggregate(lo, hi) combines the values of all keys in
+// [lo, hi) in O(log n) from the summaries along two descents. The monoid
+// need not be commutative: values are combined in key order. Monoid is
+// default constructed whenever it is used.
+//
+// Mapped values have to be changed through insert_or_assign or update,
+// which recompute the summaries above them. Writing through an iterator
+// leaves them stale.
+template <class Key, class T, class Monoid = SumMonoid<T>,
+          class Compare = std::less<Key>,
+          class Allocator = std::allocator<std::pair<const Key, T>>>
+class aggregate_map
+    : public containers::BinaryTree<
+          std::pair<const Key, T>,
+          containers::SelectFirst<std::pair<const Key, T>>, Compare, Allocator,
+          MonoidSummary<std::pair<const Key, T>, Monoid>> {
+ public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<const key_type, mapped_type>;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using key_compare = Compare;
+  using allocator_type = Allocator;
+  using result_type = typename Monoid::result_type;
+  using tree =
+      containers::BinaryTree<value_type, containers::SelectFirst<value_type>,
+                             Compare, Allocator,
+                             MonoidSummary<value_type, Monoid>>;
+  using iterator = typename tree::iterator;
+  using const_iterator = typename tree::const_iterator;
+  using size_type = size_t;
+
+  using node = typename tree::Node;
+
+  aggregate_map() : tree::BinaryTree() {}
+  explicit aggregate_map(const Allocator& alloc) : tree::BinaryTree(alloc) {}
+  explicit aggregate_map(const Compare& comp,
+                         const Allocator& alloc = Allocator())
+      : tree::BinaryTree(comp, alloc) {}
+  // Input sorted by key is built into a balanced tree in linear time, with
+  // every summary computed once.
+  template <class InputIt>
+  aggregate_map(InputIt first, InputIt last, const Compare& comp = Compare(),
+                const Allocator& alloc = Allocator())
+      : tree::BinaryTree(comp, alloc) {
+    this->assign_range(first, last, true);
+  }
+  explicit aggregate_map(std::initializer_list<value_type> const& items,
+                         const Allocator& alloc = Allocator())
+      : tree::BinaryTree(alloc) {
+    this->assign_range(items.begin(), items.end(), true);
+  }
+  aggregate_map(const aggregate_map& m) : tree::BinaryTree(m) {}
+  aggregate_map(aggregate_map&& m) : tree::BinaryTree(std::move(m)) {}
+  ~aggregate_map() {}
+
+  aggregate_map& operator=(const aggregate_map& m) {
+    tree::operator=(m);
+    return *this;
+  }
+
+  aggregate_map& operator=(aggregate_map&& m) {
+    tree::operator=(std::move(m));
+    return *this;
+  }
+
+  // Replaces the contents with [first, last), in linear time if it is sorted.
+  template <class InputIt>
+  void assign_sorted(InputIt first, InputIt last) {
+    this->assign_range(first, last, true);
+  }
+
+  const T& at(const Key& key) const {
+    node* n = this->find_node(key);
+    if (n == nullptr)
+      throw std::out_of_range("There's no obj in map with such key");
+    return std::get<1>(n->key);
+  }
+
+  std::pair<iterator, bool> insert(const value_type& value) {
+    return tree::insert(value);
+  }
+
+  std::pair<iterator, bool> insert(const Key& key, const T& obj) {
+    return tree::insert(value_type(key, obj));
+  }
+
+  template <class M>
+  std::pair<iterator, bool> insert_or_assign(const Key& key, M&& obj) {
+    node* parent_node;
+    bool left;
+    node* found = this->find_unique(key, parent_node, left);
+    if (found) {
+      std::get<1>(found->key) = std::forward<M>(obj);
+      this->update_summaries(iterator(found));
+      return std::pair<iterator, bool>{iterator(found), false};
+    }
+    return std::pair<iterator, bool>{
+        iterator(this->insert_node(parent_node, left, key,
+                                   std::forward<M>(obj))),
+        true};
+  }
+
+  // Calls f with the value mapped to key, if there is one, and recomputes
+  // the summaries above it. Returns whether key was present.
+  template <class F>
+  bool update(const Key& key, F f) {
+    node* n = this->find_node(key);
+    if (n == nullptr) return false;
+    f(std::get<1>(n->key));
+    this->update_summaries(iterator(n));
+    return true;
+  }
+
+  using tree::erase;
+
+  // Returns the number of elements erased, 0 or 1.
+  size_type erase(const Key& key) {
+    node* n = this->find_node(key);
+    if (n == nullptr) return 0;
+    tree::erase(iterator(n));
+    return 1;
+  }
+
+  // Returns the combined values of all elements, in O(1).
+  result_type aggregate() const {
+    node* root = this->root_node();
+    return root ? root->summary : Monoid().identity();
+  }
+
+  // Returns the combined values of the elements with keys in [lo, hi). The
+  // descent stops at the first key in the range, below which the range
+  // covers a suffix of the left subtree and a prefix of the right one.
+  result_type aggregate(const Key& lo, const Key& hi) const {
+    Monoid monoid;
+    Compare compare = this->key_comp();
+    if (!compare(lo, hi)) return monoid.identity();
+    node* n = this->root_node();
+    while (n) {
+      if (compare(key_of(n), lo))
+        n = n->right;
+      else if (!compare(key_of(n), hi))
+        n = n->left;
+      else
+        break;
+    }
+    if (n == nullptr) return monoid.identity();
+    result_type res = monoid.identity();
+    for (node* i = n->left; i;) {
+      if (compare(key_of(i), lo)) {
+        i = i->right;
+      } else {
+        result_type part = monoid.of(std::get<1>(i->key));
+        if (i->right) part = monoid.combine(part, i->right->summary);
+        res = monoid.combine(part, res);
+        i = i->left;
+      }
+    }
+    res = monoid.combine(res, monoid.of(std::get<1>(n->key)));
+    for (node* i = n->right; i;) {
+      if (compare(key_of(i), hi)) {
+        if (i->left) res = monoid.combine(res, i->left->summary);
+        res = monoid.combine(res, monoid.of(std::get<1>(i->key)));
+        i = i->right;
+      } else {
+        i = i->left;
+      }
+    }
+    return res;
+  }
+
+ private:
+  static const Key& key_of(const node* n) { return std::get<0>(n->key); }
+};
+}  // namespace containers
@@ -0,0 +1,25 @@
+#include <atomic>
+#include <cstdio>
+#include <list>
+#include <map>
+#include <queue>
+#include <set>
+#include <stack>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "benchmarks/benchmark.h"
+#include "containers.h"
+
+#include "benchmarks/btree_benchmark.cpp"
+#include "benchmarks/concurrent_benchmark.cpp"
+#include "benchmarks/flat_benchmark.cpp"
+#include "benchmarks/hash_benchmark.cpp"
+#include "benchmarks/node_pool_benchmark.cpp"
+#include "benchmarks/parallel_benchmark.cpp"
+#include "benchmarks/serialize_benchmark.cpp"
+#include "benchmarks/tree_benchmark.cpp"
+
+int main(int argc, char** argv) { return benchmark::run(argc, argv); }
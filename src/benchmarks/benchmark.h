@@ -0,0 +1,123 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <vector>
+
+namespace benchmark {
+// Number of calls to the global operator new, counted by the replacement
+// below so every case can report allocations per operation. Cases that
+// run on several threads allocate concurrently, hence the atomic.
+inline std::atomic<size_t>& allocations() {
+  static std::atomic<size_t> count{0};
+  return count;
+}
+
+inline size_t& last_allocations() {
+  static size_t count = 0;
+  return count;
+}
+
+using Function = void (*)(size_t);
+
+struct Case {
+  const char* name;
+  Function function;
+};
+
+inline std::vector<Case>& registry() {
+  static std::vector<Case> cases;
+  return cases;
+}
+
+struct Registrar {
+  Registrar(const char* name, Function function) {
+    registry().push_back(Case{name, function});
+  }
+};
+
+// Runs f once and returns the elapsed wall time in seconds. The number of
+// allocations made by f is kept in last_allocations().
+template <class F>
+double measure(F&& f) {
+  size_t allocations_before = allocations().load(std::memory_order_relaxed);
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  f();
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  last_allocations() =
+      allocations().load(std::memory_order_relaxed) - allocations_before;
+  return elapsed.count();
+}
+
+inline void report(const char* name, size_t n, double seconds) {
+  std::printf("  %-40s %12zu ops %10.3f s %10.1f ns/op %9.5f allocs/op\n",
+              name, n, seconds, n ? seconds * 1e9 / n : 0.0,
+              n ? static_cast<double>(last_allocations()) / n : 0.0);
+}
+
+// Keeps the optimizer from discarding a computed value.
+template <class T>
+void keep(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+inline std::vector<int> sorted_keys(size_t n) {
+  std::vector<int> keys(n);
+  for (size_t i = 0; i < n; ++i) keys[i] = static_cast<int>(i);
+  return keys;
+}
+
+inline std::vector<int> reverse_sorted_keys(size_t n) {
+  std::vector<int> keys = sorted_keys(n);
+  std::reverse(keys.begin(), keys.end());
+  return keys;
+}
+
+// Sorted keys with one in a hundred swapped with a key up to 16 places
+// away, like a stream of timestamps that arrive slightly out of order.
+inline std::vector<int> nearly_sorted_keys(size_t n) {
+  std::vector<int> keys = sorted_keys(n);
+  std::mt19937 gen(42);
+  for (size_t i = 0; i + 16 < n; i += 100)
+    std::swap(keys[i], keys[i + 1 + gen() % 16]);
+  return keys;
+}
+
+inline std::vector<int> random_keys(size_t n) {
+  std::vector<int> keys = sorted_keys(n);
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+  return keys;
+}
+
+inline int run(int argc, char** argv) {
+  size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+  for (const Case& c : registry()) {
+    std::printf("%s (n = %zu)\n", c.name, n);
+    c.function(n);
+  }
+  return 0;
+}
+}  // namespace benchmark
+
+void* operator new(size_t size) {
+  benchmark::allocations().fetch_add(1, std::memory_order_relaxed);
+  void* pointer = std::malloc(size ? size : 1);
+  if (pointer == nullptr) throw std::bad_alloc();
+  return pointer;
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+
+void operator delete(void* pointer, size_t) noexcept { std::free(pointer); }
+
+#define BENCHMARK(name)                                          \
+  void name(size_t n);                                           \
+  static benchmark::Registrar name##_registrar(#name, &name);    \
+  void name(size_t n)
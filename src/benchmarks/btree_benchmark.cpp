@@ -0,0 +1,31 @@
+// Insert, lookup and scan throughput of btree_map against the BinaryTree
+// backed map.
+
+template <class Map>
+void insert_find_scan(const char* name, const std::vector<int>& keys) {
+  std::string prefix(name);
+  Map map;
+  benchmark::report((prefix + " random insert").c_str(), keys.size(),
+                    benchmark::measure([&] {
+                      for (int key : keys) map.insert(key, key);
+                    }));
+  benchmark::report((prefix + " random find").c_str(), keys.size(),
+                    benchmark::measure([&] {
+                      for (int key : keys) benchmark::keep(map.find(key));
+                    }));
+  benchmark::report((prefix + " scan").c_str(), keys.size(),
+                    benchmark::measure([&] {
+                      long sum = 0;
+                      for (typename Map::iterator i = map.begin();
+                           i != map.end(); ++i)
+                        sum += (*i).second;
+                      benchmark::keep(sum);
+                    }));
+}
+
+BENCHMARK(btree_map_against_map) {
+  std::vector<int> keys = benchmark::random_keys(n);
+  insert_find_scan<containers::btree_map<int, int>>("containers::btree_map",
+                                                    keys);
+  insert_find_scan<containers::map<int, int>>("containers::map", keys);
+}
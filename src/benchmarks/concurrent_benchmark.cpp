@@ -0,0 +1,47 @@
+// Throughput of concurrent_map against a map behind one mutex, with every
+// thread running nine lookups per write on random keys.
+
+// Splits n operations over the given number of threads, each calling
+// op(key, write) for its share of the keys.
+template <class F>
+double run_threads(size_t threads, const std::vector<int>& keys, F op) {
+  return benchmark::measure([&] {
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+      workers.emplace_back([&keys, &op, t, threads] {
+        for (size_t i = t; i < keys.size(); i += threads)
+          op(keys[i], i % 10 == 0);
+      });
+    }
+    for (std::thread& worker : workers) worker.join();
+  });
+}
+
+BENCHMARK(concurrent_map_throughput) {
+  std::vector<int> keys = benchmark::random_keys(n);
+  size_t max_threads = std::max<size_t>(
+      4, containers::ThreadPool::default_threads());
+  for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+    std::string suffix = " " + std::to_string(threads) + " threads";
+    containers::concurrent_map<int, int> sharded;
+    for (size_t i = 0; i < n; i += 2) sharded.insert(keys[i], keys[i]);
+    benchmark::report(("concurrent_map" + suffix).c_str(), n,
+                      run_threads(threads, keys, [&](int key, bool write) {
+                        if (write)
+                          sharded.insert_or_assign(key, key);
+                        else
+                          benchmark::keep(sharded.contains(key));
+                      }));
+    containers::map<int, int> map;
+    std::mutex mutex;
+    for (size_t i = 0; i < n; i += 2) map.insert(keys[i], keys[i]);
+    benchmark::report(("map with one mutex" + suffix).c_str(), n,
+                      run_threads(threads, keys, [&](int key, bool write) {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        if (write)
+                          map.insert_or_assign(key, key);
+                        else
+                          benchmark::keep(map.contains(key));
+                      }));
+  }
+}
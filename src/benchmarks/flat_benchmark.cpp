@@ -0,0 +1,38 @@
+// Construction and lookup of flat_set against the BinaryTree backed set.
+
+BENCHMARK(flat_set_against_set) {
+  std::vector<int> keys = benchmark::random_keys(n);
+  {
+    containers::flat_set<int> set;
+    benchmark::report("containers::flat_set range build", n,
+                      benchmark::measure([&] {
+                        containers::flat_set<int> built(keys.begin(),
+                                                        keys.end());
+                        set.swap(built);
+                      }));
+    benchmark::report("containers::flat_set random find", n,
+                      benchmark::measure([&] {
+                        for (int key : keys) benchmark::keep(set.find(key));
+                      }));
+  }
+  {
+    containers::flat_set<int> set;
+    size_t count = std::min<size_t>(n, 100000);
+    benchmark::report("containers::flat_set random insert", count,
+                      benchmark::measure([&] {
+                        for (size_t i = 0; i < count; ++i)
+                          set.insert(keys[i]);
+                      }));
+  }
+  {
+    containers::set<int> set;
+    benchmark::report("containers::set random insert", n,
+                      benchmark::measure([&] {
+                        for (int key : keys) set.insert(key);
+                      }));
+    benchmark::report("containers::set random find", n,
+                      benchmark::measure([&] {
+                        for (int key : keys) benchmark::keep(set.find(key));
+                      }));
+  }
+}
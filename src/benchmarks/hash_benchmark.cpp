@@ -0,0 +1,30 @@
+// Insert and point lookup throughput of unordered_map against the BinaryTree
+// backed map and std::unordered_map.
+
+template <class Map>
+void insert_find_miss(const char* name, const std::vector<int>& keys) {
+  std::string prefix(name);
+  Map map;
+  benchmark::report((prefix + " insert").c_str(), keys.size(),
+                    benchmark::measure([&] {
+                      for (int key : keys) map[key] = key;
+                    }));
+  benchmark::report((prefix + " find").c_str(), keys.size(),
+                    benchmark::measure([&] {
+                      for (int key : keys) benchmark::keep(map.find(key));
+                    }));
+  int size = static_cast<int>(keys.size());
+  benchmark::report((prefix + " find missing").c_str(), keys.size(),
+                    benchmark::measure([&] {
+                      for (int key : keys)
+                        benchmark::keep(map.find(key + size));
+                    }));
+}
+
+BENCHMARK(unordered_map_against_map) {
+  std::vector<int> keys = benchmark::random_keys(n);
+  insert_find_miss<containers::unordered_map<int, int>>(
+      "containers::unordered_map", keys);
+  insert_find_miss<std::unordered_map<int, int>>("std::unordered_map", keys);
+  insert_find_miss<containers::map<int, int>>("containers::map", keys);
+}
@@ -0,0 +1,54 @@
+// Allocation churn of the node based containers against their std
+// counterparts. The pooled containers allocate one slab per many nodes.
+
+template <class List>
+void list_churn(const char* name, size_t n) {
+  List list;
+  benchmark::report(name, n, benchmark::measure([&] {
+                      for (size_t i = 0; i < n; ++i) {
+                        list.push_back(static_cast<int>(i));
+                        if (i % 4 == 3) {
+                          list.pop_front();
+                          list.pop_front();
+                        }
+                      }
+                      list.clear();
+                    }));
+}
+
+template <class Set>
+void set_churn(const char* name, const std::vector<int>& keys) {
+  Set set;
+  benchmark::report(name, keys.size(), benchmark::measure([&] {
+                      for (size_t i = 0; i < keys.size(); ++i) {
+                        set.insert(keys[i]);
+                        if (i % 2) set.erase(set.find(keys[i / 2]));
+                      }
+                      set.clear();
+                    }));
+}
+
+template <class Queue>
+void queue_churn(const char* name, size_t n) {
+  Queue queue;
+  benchmark::report(name, n, benchmark::measure([&] {
+                      for (size_t i = 0; i < n; ++i) {
+                        int value = static_cast<int>(i);
+                        queue.push(value);
+                        if (i % 64 == 63)
+                          while (!queue.empty()) queue.pop();
+                      }
+                    }));
+}
+
+BENCHMARK(node_allocation_churn) {
+  list_churn<containers::list<int>>("list push/pop containers::list", n);
+  list_churn<std::list<int>>("list push/pop std::list", n);
+  std::vector<int> keys = benchmark::random_keys(n);
+  set_churn<containers::set<int>>("insert/erase containers::set", keys);
+  set_churn<std::set<int>>("insert/erase std::set", keys);
+  queue_churn<containers::queue<int>>("push/pop containers::queue", n);
+  queue_churn<std::queue<int, std::list<int>>>("push/pop std::queue<list>", n);
+  queue_churn<containers::stack<int>>("push/pop containers::stack", n);
+  queue_churn<std::stack<int, std::list<int>>>("push/pop std::stack<list>", n);
+}
@@ -0,0 +1,36 @@
+// Scaling of the parallel BinaryTree operations from one thread up to the
+// number of hardware threads.
+
+BENCHMARK(tree_parallel_scaling) {
+  std::vector<int> keys = benchmark::random_keys(n);
+  std::vector<int> others;
+  for (size_t i = 0; i < n; i += 2) others.push_back(keys[i] + 1);
+  size_t max_threads = containers::ThreadPool::default_threads();
+  for (size_t threads = 1;; threads = std::min(threads * 2, max_threads)) {
+    containers::ThreadPool pool(threads);
+    std::string suffix = " " + std::to_string(threads) + " threads";
+    containers::set<int> set;
+    benchmark::report(("assign" + suffix).c_str(), n, benchmark::measure([&] {
+                        set.assign(keys.begin(), keys.end(), pool);
+                      }));
+    containers::set<int> other;
+    other.assign(others.begin(), others.end(), pool);
+    benchmark::report(("set_union" + suffix).c_str(), n + others.size(),
+                      benchmark::measure([&] { set.set_union(other, pool); }));
+    std::atomic<long long> sum{0};
+    benchmark::report(("for_each" + suffix).c_str(), set.size(),
+                      benchmark::measure([&] {
+                        set.for_each([&sum](int key) { sum += key; }, pool);
+                      }));
+    benchmark::keep(sum.load());
+    containers::multiset<int> multiset;
+    multiset.assign(keys.begin(), keys.end(), pool);
+    containers::multiset<int> other_multiset;
+    other_multiset.assign(others.begin(), others.end(), pool);
+    benchmark::report(("multiset set_union" + suffix).c_str(),
+                      n + others.size(), benchmark::measure([&] {
+                        multiset.set_union(other_multiset, pool);
+                      }));
+    if (threads == max_threads) break;
+  }
+}
@@ -0,0 +1,67 @@
+// Cold start of a map of n random keys: rebuilding it from a text dump with
+// one insert per row, against loading a binary snapshot. The files are
+// written first, so they are read from the page cache.
+BENCHMARK(serialize_cold_start) {
+  const char* text_path = "benchmark_dump.txt";
+  const char* snapshot_path = "benchmark_map.snapshot";
+  containers::map<int, int> map;
+  for (int key : benchmark::random_keys(n)) map.insert(key, key);
+  benchmark::report("write text dump", n, benchmark::measure([&] {
+                      std::FILE* file = std::fopen(text_path, "w");
+                      for (const std::pair<const int, int>& item : map)
+                        std::fprintf(file, "%d %d\n", item.first, item.second);
+                      std::fclose(file);
+                    }));
+  benchmark::report("save snapshot", n, benchmark::measure([&] {
+                      containers::save(map, snapshot_path);
+                    }));
+  benchmark::report("rebuild from text dump", n, benchmark::measure([&] {
+                      containers::map<int, int> loaded;
+                      std::FILE* file = std::fopen(text_path, "r");
+                      int key, value;
+                      while (std::fscanf(file, "%d %d", &key, &value) == 2)
+                        loaded.insert(key, value);
+                      std::fclose(file);
+                      benchmark::keep(loaded.size());
+                    }));
+  benchmark::report("load snapshot", n, benchmark::measure([&] {
+                      containers::map<int, int> loaded;
+                      containers::load(loaded, snapshot_path);
+                      benchmark::keep(loaded.size());
+                    }));
+  std::remove(text_path);
+  std::remove(snapshot_path);
+}
+
+// Startup of a read-only table of n random keys followed by n random finds:
+// loading a map snapshot into a tree, against mapping a prebuilt
+// mapped_flat_map and searching the mapped keys in place.
+BENCHMARK(serialize_mapped_table) {
+  const char* snapshot_path = "benchmark_map.snapshot";
+  const char* table_path = "benchmark_map.table";
+  std::vector<int> keys = benchmark::random_keys(n);
+  containers::map<int, int> map;
+  for (int key : keys) map.insert(key, key);
+  containers::save(map, snapshot_path);
+  containers::mapped_flat_map<int, int>::build(map, table_path);
+  benchmark::report("load snapshot, then find", n, benchmark::measure([&] {
+                      containers::map<int, int> loaded;
+                      containers::load(loaded, snapshot_path);
+                      size_t found = 0;
+                      for (int key : keys) found += loaded.contains(key);
+                      benchmark::keep(found);
+                    }));
+  benchmark::report("open mapped table, then find", n,
+                    benchmark::measure([&] {
+                      containers::mapped_flat_map<int, int> table(table_path);
+                      size_t found = 0;
+                      for (int key : keys) found += table.contains(key);
+                      benchmark::keep(found);
+                    }));
+  benchmark::report("open mapped table", n, benchmark::measure([&] {
+                      containers::mapped_flat_map<int, int> table(table_path);
+                      benchmark::keep(table.size());
+                    }));
+  std::remove(snapshot_path);
+  std::remove(table_path);
+}
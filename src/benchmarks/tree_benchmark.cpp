@@ -0,0 +1,305 @@
+// Insertion and lookup order benchmarks for the BinaryTree containers
+// against std::map.
+
+void insert_and_find(const char* order, const std::vector<int>& keys) {
+  std::string name(order);
+  {
+    containers::map<int, int> map;
+    benchmark::report((name + " insert containers::map").c_str(), keys.size(),
+                      benchmark::measure([&] {
+                        for (int key : keys) map.insert(key, key);
+                      }));
+    benchmark::report((name + " find containers::map").c_str(), keys.size(),
+                      benchmark::measure([&] {
+                        for (int key : keys) benchmark::keep(map.find(key));
+                      }));
+  }
+  {
+    std::map<int, int> map;
+    benchmark::report((name + " insert std::map").c_str(), keys.size(),
+                      benchmark::measure([&] {
+                        for (int key : keys) map.insert({key, key});
+                      }));
+    benchmark::report((name + " find std::map").c_str(), keys.size(),
+                      benchmark::measure([&] {
+                        for (int key : keys) benchmark::keep(map.find(key));
+                      }));
+  }
+}
+
+BENCHMARK(tree_insertion_order) {
+  insert_and_find("sorted", benchmark::sorted_keys(n));
+  insert_and_find("reverse sorted", benchmark::reverse_sorted_keys(n));
+  insert_and_find("random", benchmark::random_keys(n));
+}
+
+// Inserts the keys one by one, either plainly or with the previous result
+// or end() as the hint.
+void hinted_insert(const char* order, const std::vector<int>& keys) {
+  std::string name(order);
+  benchmark::report((name + " insert containers::map").c_str(), keys.size(),
+                    benchmark::measure([&] {
+                      containers::map<int, int> map;
+                      for (int key : keys) map.insert(key, key);
+                      benchmark::keep(map.size());
+                    }));
+  benchmark::report((name + " hinted containers::map").c_str(), keys.size(),
+                    benchmark::measure([&] {
+                      containers::map<int, int> map;
+                      for (int key : keys)
+                        map.emplace_hint(map.end(), key, key);
+                      benchmark::keep(map.size());
+                    }));
+  benchmark::report((name + " hinted std::map").c_str(), keys.size(),
+                    benchmark::measure([&] {
+                      std::map<int, int> map;
+                      for (int key : keys)
+                        map.emplace_hint(map.end(), key, key);
+                      benchmark::keep(map.size());
+                    }));
+  benchmark::report((name + " insert containers::multiset").c_str(),
+                    keys.size(), benchmark::measure([&] {
+                      containers::multiset<int> multiset;
+                      for (int key : keys) multiset.insert(key);
+                      benchmark::keep(multiset.size());
+                    }));
+  benchmark::report((name + " hinted containers::multiset").c_str(),
+                    keys.size(), benchmark::measure([&] {
+                      containers::multiset<int> multiset;
+                      containers::multiset<int>::iterator hint =
+                          multiset.end();
+                      for (int key : keys) hint = multiset.insert(hint, key);
+                      benchmark::keep(multiset.size());
+                    }));
+}
+
+BENCHMARK(tree_hinted_insert) {
+  hinted_insert("sorted", benchmark::sorted_keys(n));
+  hinted_insert("nearly sorted", benchmark::nearly_sorted_keys(n));
+  hinted_insert("random", benchmark::random_keys(n));
+}
+
+BENCHMARK(tree_sorted_build) {
+  std::vector<std::pair<int, int>> items;
+  for (int key : benchmark::sorted_keys(n)) items.push_back({key, key});
+  benchmark::report("sorted range containers::map", n,
+                    benchmark::measure([&] {
+                      containers::map<int, int> map(items.begin(),
+                                                    items.end());
+                      benchmark::keep(map.size());
+                    }));
+  benchmark::report("sorted inserts containers::map", n,
+                    benchmark::measure([&] {
+                      containers::map<int, int> map;
+                      for (const auto& item : items) map.insert(item);
+                      benchmark::keep(map.size());
+                    }));
+  benchmark::report("sorted range std::map", n, benchmark::measure([&] {
+                      std::map<int, int> map(items.begin(), items.end());
+                      benchmark::keep(map.size());
+                    }));
+}
+
+// Copies a map into a new one and into one that already has n elements.
+BENCHMARK(tree_copy) {
+  containers::map<int, int> map;
+  std::map<int, int> std_map;
+  for (int key : benchmark::random_keys(n)) {
+    map.insert(key, key);
+    std_map.insert({key, key});
+  }
+  benchmark::report("copy containers::map", n, benchmark::measure([&] {
+                      containers::map<int, int> copy(map);
+                      benchmark::keep(copy.size());
+                    }));
+  containers::map<int, int> target(map);
+  benchmark::report("copy assignment containers::map", n,
+                    benchmark::measure([&] {
+                      target = map;
+                      benchmark::keep(target.size());
+                    }));
+  benchmark::report("copy std::map", n, benchmark::measure([&] {
+                      std::map<int, int> copy(std_map);
+                      benchmark::keep(copy.size());
+                    }));
+}
+
+// Builds a persistent_map, then takes versions of it between updates: a
+// snapshot of the persistent_map shares all nodes, while keeping a version of
+// a map means copying it.
+BENCHMARK(tree_persistent_snapshot) {
+  std::vector<int> keys = benchmark::random_keys(n);
+  containers::persistent_map<int, int> persistent;
+  benchmark::report("insert containers::persistent_map", n,
+                    benchmark::measure([&] {
+                      for (int key : keys) persistent.insert(key, key);
+                    }));
+  containers::map<int, int> map;
+  for (int key : keys) map.insert(key, key);
+  size_t versions = std::min<size_t>(n, 1024);
+  benchmark::report("snapshot and update persistent_map", versions,
+                    benchmark::measure([&] {
+                      for (size_t i = 0; i < versions; ++i) {
+                        containers::persistent_map<int, int>::snapshot_type
+                            snapshot = persistent.snapshot();
+                        persistent.insert_or_assign(keys[i], -keys[i]);
+                        benchmark::keep(snapshot.size());
+                      }
+                    }));
+  versions = std::min<size_t>(versions, 16);
+  benchmark::report("copy and update containers::map", versions,
+                    benchmark::measure([&] {
+                      for (size_t i = 0; i < versions; ++i) {
+                        containers::map<int, int> copy(map);
+                        map.insert_or_assign(keys[i], -keys[i]);
+                        benchmark::keep(copy.size());
+                      }
+                    }));
+}
+
+// Looks up random keys in batches of 256, one by one and with find_many.
+BENCHMARK(tree_find_many) {
+  containers::set<int> set;
+  std::set<int> std_set;
+  for (int key : benchmark::random_keys(n)) {
+    set.insert(key);
+    std_set.insert(key);
+  }
+  std::vector<int> keys = benchmark::random_keys(n);
+  const size_t kBatch = 256;
+  containers::vector<containers::set<int>::iterator> found;
+  found.reserve(kBatch);
+  benchmark::report("find containers::set", n, benchmark::measure([&] {
+                      for (size_t i = 0; i < n; i += kBatch) {
+                        found.clear();
+                        size_t end = std::min(n, i + kBatch);
+                        for (size_t j = i; j < end; ++j)
+                          found.push_back(set.find(keys[j]));
+                        benchmark::keep(found.data());
+                      }
+                    }));
+  benchmark::report("find_many containers::set", n, benchmark::measure([&] {
+                      for (size_t i = 0; i < n; i += kBatch) {
+                        found.clear();
+                        set.find_many(keys.begin() + i,
+                                      keys.begin() + std::min(n, i + kBatch),
+                                      found);
+                        benchmark::keep(found.data());
+                      }
+                    }));
+  benchmark::report("find std::set", n, benchmark::measure([&] {
+                      for (int key : keys) benchmark::keep(std_set.find(key));
+                    }));
+}
+
+// Finds the intervals containing random points among n intervals of up to
+// 64 points, with interval_map and by scanning a map from start to end
+// downwards from the point, which has to go on to the longest interval.
+BENCHMARK(tree_interval_stabbing) {
+  std::vector<int> starts = benchmark::random_keys(n);
+  containers::interval_map<int, int> intervals;
+  containers::map<int, int> ends;
+  for (int start : starts) {
+    int end = start + 1 + start % 64;
+    intervals.insert(start, end, start);
+    ends.insert(start, end);
+  }
+  size_t queries = std::min<size_t>(n, 100000);
+  containers::vector<containers::interval_map<int, int>::iterator> found;
+  benchmark::report("stabbing containers::interval_map", queries,
+                    benchmark::measure([&] {
+                      for (size_t i = 0; i < queries; ++i) {
+                        found.clear();
+                        intervals.stabbing(starts[i], found);
+                        benchmark::keep(found.size());
+                      }
+                    }));
+  benchmark::report("scan containers::map", queries, benchmark::measure([&] {
+                      for (size_t i = 0; i < queries; ++i) {
+                        size_t hits = 0;
+                        containers::map<int, int>::iterator j =
+                            ends.upper_bound(starts[i]);
+                        while (j != ends.begin()) {
+                          --j;
+                          if (starts[i] - std::get<0>(*j) >= 64) break;
+                          if (starts[i] < std::get<1>(*j)) ++hits;
+                        }
+                        benchmark::keep(hits);
+                      }
+                    }));
+}
+
+// Sums the values of random windows of n / 100 keys, from the summaries of
+// an aggregate_map and by iterating a map between the two keys.
+BENCHMARK(tree_range_aggregate) {
+  std::vector<int> keys = benchmark::random_keys(n);
+  std::vector<std::pair<const int, long>> sorted;
+  for (int key : benchmark::sorted_keys(n)) sorted.emplace_back(key, key);
+  containers::aggregate_map<int, long> sums(sorted.begin(), sorted.end());
+  containers::map<int, long> map(sorted.begin(), sorted.end());
+  size_t queries = std::min<size_t>(n, 10000);
+  int window = static_cast<int>(n / 100) + 1;
+  benchmark::report("aggregate containers::aggregate_map", queries,
+                    benchmark::measure([&] {
+                      for (size_t i = 0; i < queries; ++i)
+                        benchmark::keep(
+                            sums.aggregate(keys[i], keys[i] + window));
+                    }));
+  benchmark::report("iterate containers::map", queries,
+                    benchmark::measure([&] {
+                      for (size_t i = 0; i < queries; ++i) {
+                        long sum = 0;
+                        for (containers::map<int, long>::iterator j =
+                                 map.lower_bound(keys[i]);
+                             j != map.end() &&
+                             std::get<0>(*j) < keys[i] + window;
+                             ++j)
+                          sum += std::get<1>(*j);
+                        benchmark::keep(sum);
+                      }
+                    }));
+  benchmark::report("insert_or_assign aggregate_map", queries,
+                    benchmark::measure([&] {
+                      for (size_t i = 0; i < queries; ++i)
+                        sums.insert_or_assign(keys[i], 1L);
+                    }));
+}
+
+// Adds n / 64 random keys to a set of n keys, half of them already there.
+BENCHMARK(tree_set_algebra) {
+  std::vector<int> keys;
+  for (int key : benchmark::sorted_keys(n)) keys.push_back(2 * key);
+  std::vector<int> few = benchmark::random_keys(n);
+  few.resize(n / 64);
+  std::sort(few.begin(), few.end());
+  {
+    containers::set<int> large(keys.begin(), keys.end());
+    containers::set<int> small(few.begin(), few.end());
+    benchmark::report("set_union containers::set", few.size(),
+                      benchmark::measure([&] {
+                        large.set_union(small);
+                        benchmark::keep(large.size());
+                      }));
+  }
+  {
+    containers::set<int> large(keys.begin(), keys.end());
+    containers::set<int> small(few.begin(), few.end());
+    benchmark::report("merge containers::set", few.size(),
+                      benchmark::measure([&] {
+                        large.merge(small);
+                        benchmark::keep(large.size());
+                      }));
+  }
+  {
+    std::set<int> large(keys.begin(), keys.end());
+    std::set<int> small(few.begin(), few.end());
+    benchmark::report("std::set_union std::set", few.size(),
+                      benchmark::measure([&] {
+                        std::set<int> res;
+                        std::set_union(large.begin(), large.end(),
+                                       small.begin(), small.end(),
+                                       std::inserter(res, res.end()));
+                        benchmark::keep(res.size());
+                      }));
+  }
+}
@@ -1,27 +1,86 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
+#include <functional>
 #include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "key_of_value.h"
+#include "node_pool.h"
+#include "thread_pool.h"
+#include "vector.h"
 
 namespace containers {
-template <class T>
+// Summary policy of a BinaryTree that keeps no summaries.
+struct NoSummary {
+  using summary_type = void;
+};
+
+// Storage for the summary of a node's subtree, empty without one, so a node
+// of a tree without summaries is no larger.
+template <class S>
+struct SubtreeSummary {
+  S summary;
+};
+
+template <>
+struct SubtreeSummary<void> {};
+
+// Keys are ordered by Compare, which must be a strict weak ordering. Lookups
+// call it once per level. If Compare defines is_transparent, find, contains
+// and count also accept any type the comparator can order against a key.
+//
+// Summarize can keep a summary of every subtree in its root, such as the
+// largest value in it. It names the type as summary_type and is called as
+// Summarize()(summary, value, left, right) to compute the summary of a node
+// from its element and the summaries of its children, nullptr for a missing
+// child. Every insertion, removal, rotation and rebuild recomputes the
+// summaries it affects, at O(1) per node on the way.
+template <class T, class KeyOfValue = Identity<T>,
+          class Compare = std::less<typename KeyOfValue::key_type>,
+          class Allocator = std::allocator<T>, class Summarize = NoSummary>
 class BinaryTree {
  public:
+  using key_type = typename KeyOfValue::key_type;
   using value_type = T;
   using reference = value_type&;
   using const_reference = const value_type&;
   using size_type = size_t;
+  using key_compare = Compare;
+  using allocator_type = Allocator;
+  using summary_type = typename Summarize::summary_type;
 
-  struct Node {
-    value_type key;
+  enum Color : unsigned char { kRed, kBlack };
+
+  // The subtree size and the color share one word, so a node is no larger
+  // than before the size was added.
+  struct Node : SubtreeSummary<summary_type> {
+    size_type count : std::numeric_limits<size_type>::digits - 1;
+    Color color : 1;
     Node* parent;
     Node* left;
     Node* right;
+    value_type key;
 
     Node()
-        : key(value_type()), parent(nullptr), left(nullptr), right(nullptr) {}
-    explicit Node(value_type k, Node* p = nullptr)
-        : key(value_type(k)), parent(p), left(nullptr), right(nullptr) {}
+        : count(1),
+          color(kRed),
+          parent(nullptr),
+          left(nullptr),
+          right(nullptr),
+          key(value_type()) {}
+    // Constructs the value in place from args.
+    template <class... Args>
+    explicit Node(std::in_place_t, Args&&... args)
+        : count(1),
+          color(kRed),
+          parent(nullptr),
+          left(nullptr),
+          right(nullptr),
+          key(std::forward<Args>(args)...) {}
   };
 
   class iterator {
@@ -34,13 +93,14 @@ class BinaryTree {
 
     iterator& operator++() {
       if (pointer_->right) {
-        pointer_ = min_node();
-      } else if (pointer_->parent && pointer_ == pointer_->parent->left) {
-        pointer_ = pointer_->parent;
-      } else if (pointer_->parent) {
-        while (pointer_->parent->parent && pointer_ == pointer_->parent->right)
-          pointer_ = pointer_->parent;
-        pointer_ = pointer_->parent;
+        pointer_ = minimum(pointer_->right);
+      } else {
+        Node* p = pointer_->parent;
+        while (pointer_ == p->right) {
+          pointer_ = p;
+          p = p->parent;
+        }
+        if (pointer_->right != p) pointer_ = p;
       }
       return *this;
     }
@@ -52,14 +112,17 @@ class BinaryTree {
     }
 
     iterator& operator--() {
-      if (pointer_->left) {
-        pointer_ = max_node();
-      } else if (pointer_->parent && pointer_->parent->left) {
-        while (pointer_->parent->parent && pointer_ == pointer_->parent->left)
-          pointer_ = pointer_->parent;
-        pointer_ = pointer_->parent;
-      } else if (pointer_->parent && pointer_->parent->right) {
-        pointer_ = pointer_->parent;
+      if (pointer_->color == kRed && pointer_->parent->parent == pointer_) {
+        pointer_ = pointer_->right;
+      } else if (pointer_->left) {
+        pointer_ = maximum(pointer_->left);
+      } else {
+        Node* p = pointer_->parent;
+        while (pointer_ == p->left) {
+          pointer_ = p;
+          p = p->parent;
+        }
+        pointer_ = p;
       }
       return *this;
     }
@@ -81,18 +144,6 @@ class BinaryTree {
 
    private:
     Node* pointer_;
-
-    Node* min_node() {
-      Node* min = pointer_->right;
-      while (min && min->left) min = min->left;
-      return min;
-    }
-
-    Node* max_node() {
-      Node* max = pointer_->left;
-      while (max && max->right) max = max->right;
-      return max;
-    }
   };
 
   class const_iterator : public iterator {
@@ -103,260 +154,1760 @@ class BinaryTree {
     }
   };
 
-  BinaryTree() : root(new Node()) {}
-  BinaryTree(const BinaryTree& t) : BinaryTree() {
-    iterator i = t.begin();
-    while (i != t.end()) {
-      insert(*i);
-      ++i;
+  // Owns an element extracted from a tree, still in its node. Its key can be
+  // changed before the node is inserted again. The handle keeps the slabs of
+  // its node alive, so it may outlive the tree it came from. Inserting it
+  // into a tree with an equal allocator relinks the node, otherwise the
+  // element is moved into a node of that tree.
+  class node_type {
+    friend class BinaryTree;
+
+   public:
+    using value_type = T;
+    using key_type = typename KeyOfValue::key_type;
+    using allocator_type = Allocator;
+
+    node_type() : node_(nullptr), group_(nullptr) {}
+    node_type(node_type&& other) : node_(other.node_), group_(other.group_) {
+      other.node_ = nullptr;
+    }
+    node_type(const node_type&) = delete;
+    node_type& operator=(const node_type&) = delete;
+    ~node_type() { reset(); }
+
+    node_type& operator=(node_type&& other) {
+      if (&other == this) return *this;
+      reset();
+      node_ = other.node_;
+      group_ = other.group_;
+      other.node_ = nullptr;
+      return *this;
+    }
+
+    bool empty() const { return node_ == nullptr; }
+    explicit operator bool() const { return node_ != nullptr; }
+
+    allocator_type get_allocator() const {
+      return allocator_type(group_->allocator);
+    }
+
+    value_type& value() const { return node_->key; }
+
+    key_type& key() const {
+      return const_cast<key_type&>(KeyOfValue()(node_->key));
+    }
+
+    // Only for elements that are pairs.
+    auto& mapped() const { return node_->key.second; }
+
+    void swap(node_type& other) {
+      std::swap(node_, other.node_);
+      std::swap(group_, other.group_);
     }
+
+   private:
+    using Group = typename NodePool<Node, Allocator>::Group;
+
+    node_type(Node* node, Group* group) : node_(node), group_(group) {}
+
+    void reset() {
+      if (node_) NodePool<Node, Allocator>::drop(node_, group_);
+      node_ = nullptr;
+    }
+
+    Node* node_;
+    Group* group_;
+  };
+
+  struct insert_return_type {
+    iterator position;
+    bool inserted;
+    node_type node;
+  };
+
+  BinaryTree() : BinaryTree(Compare(), Allocator()) {}
+  explicit BinaryTree(const Allocator& alloc) : BinaryTree(Compare(), alloc) {}
+  explicit BinaryTree(const Compare& comp,
+                      const Allocator& alloc = Allocator())
+      : header_(nullptr), compare_(comp), pool_(alloc) {
+    header_ = pool_.create_standalone();
+    reset_header();
+  }
+  // Copies the shape of t node for node, without comparing keys.
+  BinaryTree(const BinaryTree& t)
+      : BinaryTree(t.compare_, std::allocator_traits<Allocator>::
+                                   select_on_container_copy_construction(
+                                       t.get_allocator())) {
+    clone_from(t, nullptr);
+  }
+  BinaryTree(BinaryTree&& t) : header_(nullptr), compare_(t.compare_) {
+    swap(t);
   }
-  BinaryTree(BinaryTree&& t) : root(nullptr) { std::swap(root, t.root); }
   ~BinaryTree() {
-    if (root != nullptr) {
+    if (header_ != nullptr) {
       clear();
-      delete root;
-      root = nullptr;
+      pool_.destroy_standalone(header_);
+      header_ = nullptr;
     }
   }
+  // Copies the shape of t as the copy constructor does, building the
+  // elements in the nodes this tree already has before creating new ones.
+  // The allocator of this tree is kept.
+  BinaryTree& operator=(const BinaryTree& t) {
+    if (&t == this) return *this;
+    compare_ = t.compare_;
+    clone_from(t, flatten(root(), nullptr));
+    return *this;
+  }
   BinaryTree& operator=(BinaryTree&& t) {
     if (&t == this) return *this;
-    if (!empty()) {
+    if (header_ != nullptr) {
       clear();
-      delete root;
+      pool_.destroy_standalone(header_);
     }
-    root = nullptr;
-    std::swap(root, t.root);
+    header_ = nullptr;
+    swap(t);
     return *this;
   }
 
-  iterator begin() const {
-    Node* i = root;
-    while (i->left) i = i->left;
-    return iterator(i);
-  }
+  allocator_type get_allocator() const { return pool_.get_allocator(); }
 
-  iterator end() const {
-    Node* i = root;
-    while (i->right) i = i->right;
-    return iterator(i);
-  }
+  key_compare key_comp() const { return compare_; }
 
-  bool empty() const { return begin() == end(); }
+  iterator begin() const { return iterator(header_->left); }
 
-  size_type size() const {
-    iterator i = begin();
-    size_type res = 0;
-    while (i != end()) {
-      ++i;
-      ++res;
-    }
-    return res;
-  }
+  iterator end() const { return iterator(header_); }
+
+  bool empty() const { return header_->parent == nullptr; }
+
+  size_type size() const { return subtree_size(root()); }
 
   size_type max_size() const {
-    return std::numeric_limits<intmax_t>::max() /
-           (sizeof(Node) + sizeof(iterator));
+    return std::numeric_limits<intmax_t>::max() / sizeof(Node);
   }
 
+  // A tree whose pool is shared recycles its nodes instead of releasing the
+  // slabs, which the trees it shares with may still use.
   void clear() {
-    while (!empty()) {
-      erase(begin());
+    if (pool_.shared()) {
+      destroy_subtree(root());
+    } else {
+      if (!std::is_trivially_destructible<value_type>::value)
+        destroy_subtree(root());
+      pool_.release();
     }
+    reset_header();
   }
 
+  // Descends with one comparison per level, then compares the key with its
+  // would-be predecessor once to detect a duplicate.
   std::pair<iterator, bool> insert(const value_type& value) {
-    if (empty()) {
-      insert_root(value);
-      return std::pair<iterator, bool>{iterator(this->root), true};
-    }
-    Node* parent_node = root;
-    while ((parent_node->left || parent_node->right) ||
-           parent_node->key == value) {
-      if (parent_node->key > value) {
-        if (parent_node->left)
-          parent_node = parent_node->left;
-        else
-          break;
-      } else {
-        if (parent_node->right && iterator(parent_node->right) != this->end())
-          parent_node = parent_node->right;
-        else
-          break;
-      }
-    }
-    bool not_equal_keys = parent_node->key != value;
-    return std::pair<iterator, bool>{
-        iterator(
-            this->insert_node(value, not_equal_keys ? parent_node : nullptr)),
-        not_equal_keys};
+    return insert_unique(value);
+  }
+
+  std::pair<iterator, bool> insert(value_type&& value) {
+    return insert_unique(std::move(value));
+  }
+
+  // Inserts value next to hint with at most two comparisons if its key
+  // belongs right before or right after hint, so appending keys in order at
+  // end() skips the descent. Otherwise the key is looked up from the root.
+  iterator insert(iterator hint, const value_type& value) {
+    return insert_hint_unique(hint, value);
+  }
+
+  iterator insert(iterator hint, value_type&& value) {
+    return insert_hint_unique(hint, std::move(value));
   }
 
   void erase(iterator pos) {
     Node* node = pos.pointer_;
     remove_node(node);
-    delete node;
+    pool_.destroy(node);
   }
 
-  void swap(BinaryTree& other) { std::swap(root, other.root); }
+  // Unlinks the element at pos without destroying or copying it.
+  node_type extract(iterator pos) {
+    Node* node = pos.pointer_;
+    remove_node(node);
+    node->parent = node->left = node->right = nullptr;
+    node->count = 1;
+    node->color = kRed;
+    return node_type(node, pool_.hold());
+  }
 
-  iterator find(const T& key) const {
+  // Extracts the first element with the given key, if there is one.
+  node_type extract(const key_type& key) {
+    Node* node = find_node(key);
+    return node ? extract(iterator(node)) : node_type();
+  }
+
+  // Inserts the element of nh unless an element has an equal key, in which
+  // case nh is handed back in the result.
+  insert_return_type insert(node_type&& nh) {
+    if (nh.empty()) return insert_return_type{end(), false, node_type()};
+    Node* parent_node;
+    bool left;
+    Node* found = find_unique(KeyOfValue()(nh.value()), parent_node, left);
+    if (found) return insert_return_type{iterator(found), false, std::move(nh)};
+    Node* node = take_node(nh);
+    link_node(node, parent_node, left);
+    return insert_return_type{iterator(node), true, node_type()};
+  }
+
+  void swap(BinaryTree& other) {
+    std::swap(header_, other.header_);
+    std::swap(compare_, other.compare_);
+    pool_.swap(other.pool_);
+  }
+
+  iterator find(const key_type& key) const {
     Node* node = find_node(key);
     return node ? iterator(node) : end();
   }
 
-  bool contains(const T& key) const { return find(key) != end(); }
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator find(const K& key) const {
+    Node* node = find_node(key);
+    return node ? iterator(node) : end();
+  }
 
- protected:
-  Node* root;
+  bool contains(const key_type& key) const { return find_node(key); }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  bool contains(const K& key) const {
+    return find_node(key);
+  }
+
+  // Looks up every key of [first, last) and appends an iterator to the
+  // first element with an equal key, or end(), to out. Up to kBatchSize
+  // descents advance in lock-step, one level at a time, and the next node
+  // of each is prefetched, so their cache misses overlap instead of adding
+  // up.
+  template <class RandomIt, class A>
+  void find_many(RandomIt first, RandomIt last,
+                 containers::vector<iterator, A>& out) const {
+    find_batched(first, last,
+                 [&out](Node* node) { out.push_back(iterator(node)); });
+  }
+
+  // The same, appending whether every key is present.
+  template <class RandomIt, class A>
+  void contains_many(RandomIt first, RandomIt last,
+                     containers::vector<bool, A>& out) const {
+    find_batched(first, last,
+                 [this, &out](Node* node) { out.push_back(node != header_); });
+  }
+
+  // Returns the first element with a key not less than the given one.
+  iterator lower_bound(const key_type& key) const {
+    return iterator(bound_node(key, false));
+  }
 
-  void insert_root(const value_type& value) {
-    Node* new_root = new Node(value, nullptr);
-    new_root->right = root;
-    root->parent = new_root;
-    root = new_root;
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator lower_bound(const K& key) const {
+    return iterator(bound_node(key, false));
   }
 
-  Node* insert_node(value_type k, Node* p) {
-    if (p) {
-      Node* node = new Node(k, p);
-      if (k < p->key) {
-        p->left = node;
+  // Returns the first element with a key greater than the given one.
+  iterator upper_bound(const key_type& key) const {
+    return iterator(bound_node(key, true));
+  }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator upper_bound(const K& key) const {
+    return iterator(bound_node(key, true));
+  }
+
+  std::pair<iterator, iterator> equal_range(const key_type& key) const {
+    return std::pair<iterator, iterator>{lower_bound(key), upper_bound(key)};
+  }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  std::pair<iterator, iterator> equal_range(const K& key) const {
+    return std::pair<iterator, iterator>{lower_bound(key), upper_bound(key)};
+  }
+
+  // Returns the element at zero-based position k in sorted order, or end()
+  // if k is not less than size().
+  iterator nth(size_type k) const {
+    Node* node = root();
+    while (node) {
+      size_type left = subtree_size(node->left);
+      if (k < left) {
+        node = node->left;
+      } else if (k == left) {
+        return iterator(node);
       } else {
-        if (p->right) {
-          node->right = p->right;
-          p->right->parent = node;
-        }
-        p->right = node;
+        k -= left + 1;
+        node = node->right;
+      }
+    }
+    return end();
+  }
+
+  // Returns the number of elements with a key less than the given one.
+  size_type rank(const key_type& key) const { return rank_of(key, false); }
+
+  // Returns the number of elements with a key in [lo, hi).
+  size_type count_range(const key_type& lo, const key_type& hi) const {
+    return compare_(lo, hi) ? rank(hi) - rank(lo) : 0;
+  }
+
+  // Calls f on every element, on the threads of the pool. Subtrees of at
+  // least kParallelGrain elements are split between threads, smaller ones
+  // are visited in order by one thread.
+  template <class F>
+  void for_each(F f, ThreadPool& threads) {
+    for_each_node(root(), f, &threads);
+  }
+
+ protected:
+  // The root, for containers that descend guided by the summaries.
+  Node* root_node() const { return root(); }
+
+  // Recomputes the summaries of the subtrees holding the element at pos,
+  // which has to be called after changing the element in place.
+  void update_summaries(iterator pos) { summarize_path(pos.pointer_); }
+
+  // Inserts value after any elements with an equal key.
+  iterator insert_equal(const value_type& value) {
+    return emplace_equal(value);
+  }
+
+  iterator insert_equal(value_type&& value) {
+    return emplace_equal(std::move(value));
+  }
+
+  // Inserts the element of nh after any elements with an equal key.
+  iterator insert_equal(node_type&& nh) {
+    if (nh.empty()) return end();
+    Node* node = take_node(nh);
+    Node* parent_node = find_parent(key_of(node));
+    link_node(node, parent_node, key_less(key_of(node), parent_node));
+    return iterator(node);
+  }
+
+  // Constructs an element from args in its node and links it after any
+  // elements with an equal key.
+  template <class... Args>
+  iterator emplace_equal(Args&&... args) {
+    Node* node = pool_.create(std::in_place, std::forward<Args>(args)...);
+    Node* parent_node = find_parent(key_of(node));
+    link_node(node, parent_node, key_less(key_of(node), parent_node));
+    return iterator(node);
+  }
+
+  // Inserts value unless an element has an equal key. The value is copied
+  // or moved into the node once, and not at all for a duplicate.
+  template <class V>
+  std::pair<iterator, bool> insert_unique(V&& value) {
+    Node* parent_node;
+    bool left;
+    Node* found = find_unique(KeyOfValue()(value), parent_node, left);
+    if (found) return std::pair<iterator, bool>{iterator(found), false};
+    return std::pair<iterator, bool>{
+        iterator(insert_node(parent_node, left, std::forward<V>(value))),
+        true};
+  }
+
+  // Constructs an element from args in its node, whose key is only known
+  // then, and destroys the node again if an element has an equal key.
+  template <class... Args>
+  std::pair<iterator, bool> emplace_unique(Args&&... args) {
+    Node* node = pool_.create(std::in_place, std::forward<Args>(args)...);
+    Node* parent_node;
+    bool left;
+    Node* found = find_unique(key_of(node), parent_node, left);
+    if (found) {
+      pool_.destroy(node);
+      return std::pair<iterator, bool>{iterator(found), false};
+    }
+    link_node(node, parent_node, left);
+    return std::pair<iterator, bool>{iterator(node), true};
+  }
+
+  template <class V>
+  iterator insert_hint_unique(iterator hint, V&& value) {
+    Node* parent_node;
+    bool left;
+    Node* found =
+        find_unique_hint(hint, KeyOfValue()(value), parent_node, left);
+    if (found) return iterator(found);
+    return iterator(insert_node(parent_node, left, std::forward<V>(value)));
+  }
+
+  template <class... Args>
+  iterator emplace_hint_unique(iterator hint, Args&&... args) {
+    Node* node = pool_.create(std::in_place, std::forward<Args>(args)...);
+    Node* parent_node;
+    bool left;
+    Node* found = find_unique_hint(hint, key_of(node), parent_node, left);
+    if (found) {
+      pool_.destroy(node);
+      return iterator(found);
+    }
+    link_node(node, parent_node, left);
+    return iterator(node);
+  }
+
+  template <class... Args>
+  iterator emplace_hint_equal(iterator hint, Args&&... args) {
+    Node* node = pool_.create(std::in_place, std::forward<Args>(args)...);
+    bool left;
+    Node* parent_node = find_equal_hint(hint, key_of(node), left);
+    link_node(node, parent_node, left);
+    return iterator(node);
+  }
+
+  // Descends with one comparison per level, then compares the key with its
+  // would-be predecessor once to detect a duplicate. Returns the element
+  // with an equal key if there is one, otherwise nullptr, with parent_node
+  // and left telling where a node with the key is to be linked.
+  Node* find_unique(const key_type& key, Node*& parent_node,
+                    bool& left) const {
+    parent_node = find_parent(key);
+    left = key_less(key, parent_node);
+    Node* prev = parent_node;
+    if (left) {
+      if (parent_node == leftmost()) return nullptr;
+      prev = (--iterator(parent_node)).pointer_;
+    }
+    return compare_(key_of(prev), key) ? nullptr : prev;
+  }
+
+  // Replaces the contents with [first, last), dropping elements equivalent to
+  // an earlier one if unique is set. While the input is sorted its nodes are
+  // allocated in order and chained through their right pointers, and the
+  // chain is then linked into a balanced tree in linear time. Elements after
+  // the first one out of order are inserted one by one.
+  template <class InputIt>
+  void assign_range(InputIt first, InputIt last, bool unique) {
+    clear();
+    Node* head = nullptr;
+    Node* tail = nullptr;
+    size_type n = 0;
+    try {
+      for (; first != last; ++first) {
+        const value_type& value = *first;
+        const key_type& key = KeyOfValue()(value);
+        if (tail && compare_(key, key_of(tail))) break;
+        if (unique && tail && !compare_(key_of(tail), key)) continue;
+        Node* node = pool_.create(std::in_place, value);
+        (tail ? tail->right : head) = node;
+        tail = node;
+        ++n;
+      }
+    } catch (...) {
+      while (head) {
+        Node* next = head->right;
+        pool_.destroy(head);
+        head = next;
+      }
+      throw;
+    }
+    assign_chain(head, tail, n);
+    for (; first != last; ++first) {
+      if (unique)
+        insert(*first);
+      else
+        insert_equal(*first);
+    }
+  }
+
+  // The same as assign_range, using the threads of the pool. The nodes are
+  // created in input order by the calling thread, since the pool is not
+  // thread-safe, then sorted by a parallel merge sort unless they are sorted
+  // already, and linked into a balanced tree in parallel. Compare has to be
+  // safe to call concurrently.
+  template <class InputIt>
+  void assign_range(InputIt first, InputIt last, bool unique,
+                    ThreadPool& threads) {
+    clear();
+    node_pointer_allocator alloc(get_allocator());
+    containers::vector<Node*, node_pointer_allocator> nodes(alloc);
+    try {
+      for (; first != last; ++first) {
+        nodes.push_back(nullptr);
+        nodes.data()[nodes.size() - 1] =
+            pool_.create(std::in_place, *first);
+      }
+    } catch (...) {
+      for (size_type i = 0; i < nodes.size(); ++i)
+        if (nodes.data()[i]) pool_.destroy(nodes.data()[i]);
+      throw;
+    }
+    Node** begin = nodes.data();
+    Node** end = begin + nodes.size();
+    NodeLess less{&compare_};
+    if (!std::is_sorted(begin, end, less))
+      sort_nodes(begin, end, less, threads);
+    if (unique && begin != end) {
+      Node** kept = begin;
+      for (Node** i = begin + 1; i != end; ++i) {
+        if (less(*kept, *i))
+          *++kept = *i;
+        else
+          pool_.destroy(*i);
+      }
+      end = kept + 1;
+    }
+    size_type n = end - begin;
+    if (n == 0) return;
+    size_type red_depth = 0;
+    while ((size_type(2) << red_depth) <= n) ++red_depth;
+    leftmost() = *begin;
+    rightmost() = *(end - 1);
+    root() = build_balanced(begin, n, 0, red_depth, &threads);
+    root()->parent = header_;
+    root()->color = kBlack;
+  }
+
+  // Works as find_unique when the key belongs right before or right after
+  // hint, comparing it with hint and one neighbor only, and calls
+  // find_unique otherwise.
+  Node* find_unique_hint(iterator hint, const key_type& key,
+                         Node*& parent_node, bool& left) const {
+    Node* node = hint.pointer_;
+    if (node == header_) {
+      if (!empty() && compare_(key_of(rightmost()), key)) {
+        parent_node = rightmost();
+        left = false;
+        return nullptr;
+      }
+    } else if (compare_(key, key_of(node))) {
+      if (node == leftmost()) {
+        parent_node = node;
+        left = true;
+        return nullptr;
+      }
+      Node* before = (--iterator(node)).pointer_;
+      if (compare_(key_of(before), key)) {
+        place_between(before, node, parent_node, left);
+        return nullptr;
+      }
+    } else if (compare_(key_of(node), key)) {
+      if (node == rightmost()) {
+        parent_node = node;
+        left = false;
+        return nullptr;
       }
+      Node* after = (++iterator(node)).pointer_;
+      if (compare_(key, key_of(after))) {
+        place_between(node, after, parent_node, left);
+        return nullptr;
+      }
+    } else {
+      return node;
+    }
+    return find_unique(key, parent_node, left);
+  }
+
+  // Returns the parent below which a node with the given key is linked next
+  // to hint, among the elements with an equal key, if it can go there, and
+  // the parent found by a descent otherwise.
+  Node* find_equal_hint(iterator hint, const key_type& key, bool& left) const {
+    Node* node = hint.pointer_;
+    Node* parent_node;
+    if (node == header_) {
+      if (!empty() && !compare_(key, key_of(rightmost()))) {
+        left = false;
+        return rightmost();
+      }
+    } else if (!compare_(key_of(node), key)) {
+      if (node == leftmost()) {
+        left = true;
+        return node;
+      }
+      Node* before = (--iterator(node)).pointer_;
+      if (!compare_(key, key_of(before))) {
+        place_between(before, node, parent_node, left);
+        return parent_node;
+      }
+    } else {
+      if (node == rightmost()) {
+        left = false;
+        return node;
+      }
+      Node* after = (++iterator(node)).pointer_;
+      if (!compare_(key_of(after), key)) {
+        place_between(node, after, parent_node, left);
+        return parent_node;
+      }
+    }
+    parent_node = find_parent(key);
+    left = key_less(key, parent_node);
+    return parent_node;
+  }
+
+  // A node between the adjacent nodes before and after becomes the right
+  // child of before if it has none, and the left child of after otherwise.
+  static void place_between(Node* before, Node* after, Node*& parent_node,
+                            bool& left) {
+    left = before->right != nullptr;
+    parent_node = left ? after : before;
+  }
+
+  // Takes the node out of nh, sharing the slabs it keeps alive, unless the
+  // allocators differ. Then its element is moved into a new node of this
+  // pool and the old node is destroyed.
+  Node* take_node(node_type& nh) {
+    Node* node = nh.node_;
+    if (pool_.adopt(nh.group_)) {
+      nh.node_ = nullptr;
       return node;
     }
-    return nullptr;
+    Node* moved = pool_.create(std::in_place, std::move(node->key));
+    nh.reset();
+    return moved;
+  }
+
+  // Constructs an element from args in a new node linked below p.
+  template <class... Args>
+  Node* insert_node(Node* p, bool left, Args&&... args) {
+    Node* node = pool_.create(std::in_place, std::forward<Args>(args)...);
+    link_node(node, p, left);
+    return node;
   }
 
-  void merge_node(iterator i, BinaryTree& other) {
-    Node* node = i.pointer_;
-    Node* p = find_parent(node->key);
+  // Unlinks node from other and returns it ready to be linked into this
+  // tree. If the pools share, that is the node itself, otherwise its element
+  // is moved into a new node of this pool and the old node is destroyed.
+  Node* take_from(BinaryTree& other, Node* node, bool shared) {
+    if (!shared) {
+      Node* moved = pool_.create(std::in_place, std::move(node->key));
+      other.remove_node(node);
+      other.pool_.destroy(node);
+      return moved;
+    }
     other.remove_node(node);
-    node->parent = p;
     node->left = nullptr;
     node->right = nullptr;
-    if (node->key < p->key) {
-      p->left = node;
-    } else {
-      if (p->right) {
-        p->right->parent = node;
-        node->right = p->right;
-      }
-      p->right = node;
+    node->count = 1;
+    node->color = kRed;
+    return node;
+  }
+
+  // Moves every element of other whose key is not in this tree into it, and
+  // leaves the others in other. The pools share, so the nodes are relinked
+  // without being reallocated, unless the allocators differ.
+  void merge_unique(BinaryTree& other) {
+    if (&other == this) return;
+    bool shared = pool_.share(other.pool_);
+    Node* node = other.leftmost();
+    while (node != other.header_) {
+      Node* next = (++iterator(node)).pointer_;
+      Node* parent_node;
+      bool left;
+      if (!find_unique(key_of(node), parent_node, left))
+        link_node(take_from(other, node, shared), parent_node, left);
+      node = next;
     }
   }
 
+  // Moves every element of other into this tree, relinking the nodes as
+  // merge_unique does.
+  void merge_equal(BinaryTree& other) {
+    if (&other == this) return;
+    bool shared = pool_.share(other.pool_);
+    while (!other.empty()) {
+      Node* node = take_from(other, other.leftmost(), shared);
+      Node* p = find_parent(key_of(node));
+      link_node(node, p, key_less(key_of(node), p));
+    }
+  }
+
+  enum SetOperation {
+    kUnion,
+    kIntersection,
+    kDifference,
+    kSymmetricDifference
+  };
+
+  // Replaces the contents with the result of op applied to this tree and
+  // other, for trees with unique keys, and leaves other empty. On equal keys
+  // the element of this tree is kept. Both trees are split and joined rather
+  // than rebuilt, so the cost is O(m log(n / m + 1)) for sizes m <= n, and
+  // the surviving nodes are relinked without being reallocated. Given
+  // threads, the two sides of every split large enough are processed in
+  // parallel, which needs Compare to be safe to call concurrently.
+  void set_operation(BinaryTree& other, SetOperation op,
+                     ThreadPool* threads = nullptr) {
+    if (&other == this) {
+      if (op == kDifference || op == kSymmetricDifference) clear();
+      return;
+    }
+    Subtree a = detach();
+    Subtree b = adopt(other);
+    NodeList dropped;
+    switch (op) {
+      case kUnion:
+        attach(unite(a, b, dropped, threads));
+        break;
+      case kIntersection:
+        attach(intersect(a, b, dropped, threads));
+        break;
+      case kDifference:
+        attach(subtract(a, b, dropped, threads));
+        break;
+      case kSymmetricDifference:
+        attach(symmetric_subtract(a, b, dropped, threads));
+        break;
+    }
+    destroy_list(dropped);
+  }
+
+  // The same as set_operation for trees with equivalent keys, where an
+  // element matches at most one equivalent element of the other tree, in
+  // order. Both trees are split around a key into the keys less than,
+  // equivalent to and greater than it, and the runs of equivalent keys are
+  // resolved by rank, so the cost stays that of set_operation plus the
+  // dropped nodes. Threads are used as by set_operation.
+  void set_operation_equal(BinaryTree& other, SetOperation op,
+                           ThreadPool* threads = nullptr) {
+    if (&other == this) {
+      if (op == kDifference || op == kSymmetricDifference) clear();
+      return;
+    }
+    Subtree a = detach();
+    Subtree b = adopt(other);
+    NodeList dropped;
+    attach(combine_equal(a, b, op, dropped, threads));
+    destroy_list(dropped);
+  }
+
   void remove_node(Node* node) {
+    if (node == leftmost())
+      leftmost() = node->right ? minimum(node->right) : node->parent;
+    if (node == rightmost())
+      rightmost() = node->left ? maximum(node->left) : node->parent;
     if (node->left && node->right) {
       remove_two_children_node(node);
-    } else if (node->left || node->right) {
-      remove_one_child_node(node);
     } else {
-      remove_childless_node(node);
+      for (Node* p = node->parent; p != header_; p = p->parent) --p->count;
+      if (node->left || node->right)
+        remove_one_child_node(node);
+      else
+        remove_childless_node(node);
     }
   }
 
- private:
-  Node* find_node(const T& key) const {
-    Node* node = root;
-    while (node && node->key != key) {
-      if (key < node->key) {
-        node = node->left;
+  // Returns the first element with a key equivalent to the given one, or
+  // nullptr. The descent finds the first key not less than the given one,
+  // so only one extra comparison is needed to tell whether it is equal.
+  template <class K>
+  Node* find_node(const K& key) const {
+    Node* found = bound_node(key, false);
+    return found != header_ && !compare_(key, key_of(found)) ? found : nullptr;
+  }
+
+  // Returns the first node with a key not less than key, or greater than key
+  // if upper is set, or the header if there is none.
+  template <class K>
+  Node* bound_node(const K& key, bool upper) const {
+    Node* found = header_;
+    Node* node = root();
+    while (node) {
+      if (upper ? !compare_(key, key_of(node)) : compare_(key_of(node), key)) {
+        node = node->right;
       } else {
+        found = node;
+        node = node->left;
+      }
+    }
+    return found;
+  }
+
+  // Returns the number of elements with a key less than key, or not greater
+  // than key if upper is set, from the subtree sizes along one descent.
+  template <class K>
+  size_type rank_of(const K& key, bool upper) const {
+    size_type res = 0;
+    Node* node = root();
+    while (node) {
+      if (upper ? !compare_(key, key_of(node)) : compare_(key_of(node), key)) {
+        res += subtree_size(node->left) + 1;
         node = node->right;
+      } else {
+        node = node->left;
       }
     }
+    return res;
+  }
+
+ private:
+  // The header is the end node: its parent is the root, and its left and
+  // right children are the leftmost and rightmost nodes of the tree. It is
+  // the only red node whose grandparent is itself, which is how decrement
+  // tells it apart from the root.
+  Node* header_;
+  Compare compare_;
+  NodePool<Node, Allocator> pool_;
+
+  // Below this many elements work is not worth handing to another thread.
+  static constexpr size_type kParallelGrain = 4096;
+
+  // Lookups interleaved by find_many, enough to keep a few misses to memory
+  // in flight on every level.
+  static constexpr size_type kBatchSize = 16;
+
+  using node_pointer_allocator = typename std::allocator_traits<
+      Allocator>::template rebind_alloc<Node*>;
+
+  struct NodeLess {
+    const Compare* compare;
+
+    bool operator()(const Node* a, const Node* b) const {
+      return (*compare)(key_of(a), key_of(b));
+    }
+  };
+
+  Node*& root() const { return header_->parent; }
+  Node*& leftmost() const { return header_->left; }
+  Node*& rightmost() const { return header_->right; }
+
+  void reset_header() {
+    header_->count = 0;
+    header_->color = kRed;
+    header_->parent = nullptr;
+    header_->left = header_;
+    header_->right = header_;
+  }
+
+  void destroy_subtree(Node* node) {
+    while (node) {
+      destroy_subtree(node->right);
+      Node* left = node->left;
+      pool_.destroy(node);
+      node = left;
+    }
+  }
+
+  static size_type subtree_size(const Node* node) {
+    return node ? node->count : 0;
+  }
+
+  static Node* minimum(Node* node) {
+    while (node->left) node = node->left;
     return node;
   }
 
-  Node* find_parent(value_type key) const {
-    Node* p = root;
-    while (p->left || (p->right && iterator(p->right) != end())) {
-      if (key < p->key && p->left)
-        p = p->left;
-      else if (key > p->key && p->right)
-        p = p->right;
-      else
-        break;
+  static Node* maximum(Node* node) {
+    while (node->right) node = node->right;
+    return node;
+  }
+
+  static const key_type& key_of(const Node* node) {
+    return KeyOfValue()(node->key);
+  }
+
+  bool key_less(const key_type& key, const Node* node) const {
+    return node == header_ || compare_(key, key_of(node));
+  }
+
+  static bool is_black(const Node* node) {
+    return node == nullptr || node->color == kBlack;
+  }
+
+  static constexpr bool kSummarized = !std::is_void<summary_type>::value;
+
+  // Recomputes the summary of node from its element and its children.
+  static void summarize(Node* node) {
+    if constexpr (kSummarized) {
+      Summarize()(node->summary, node->key,
+                  node->left ? &node->left->summary : nullptr,
+                  node->right ? &node->right->summary : nullptr);
+    }
+  }
+
+  // Recomputes the summaries from node up to the root.
+  void summarize_path(Node* node) {
+    if constexpr (kSummarized)
+      for (; node != header_; node = node->parent) summarize(node);
+  }
+
+  // Returns the leaf below which a node with the given key is linked, placing
+  // it after the elements with an equal key.
+  Node* find_parent(const key_type& key) const {
+    Node* p = header_;
+    Node* node = root();
+    while (node) {
+      p = node;
+      node = compare_(key, key_of(node)) ? node->left : node->right;
     }
     return p;
   }
 
-  void remove_two_children_node(Node* node) {
-    Node* replacement = iterator(node->right) == end()
-                            ? iterator(node).max_node()
-                            : iterator(node).min_node();
-    if (replacement == node->right) {
-      replacement->left = node->left;
-    } else if (replacement == node->left) {
-      replacement->right = node->right;
-    } else if (replacement->right) {
-      replacement->right->parent = replacement->parent;
-      replacement->parent->left = replacement->right;
-    } else if (replacement->left) {
-      replacement->left->parent = replacement->parent;
-      replacement->parent->right = replacement->left;
+  // Calls emit with the node found for every key of [first, last), or the
+  // header for a missing one, in order.
+  template <class RandomIt, class F>
+  void find_batched(RandomIt first, RandomIt last, F emit) const {
+    Node* cursor[kBatchSize];
+    Node* found[kBatchSize];
+    while (first != last) {
+      size_type n = std::min<size_type>(kBatchSize, last - first);
+      for (size_type i = 0; i < n; ++i) {
+        cursor[i] = root();
+        found[i] = header_;
+      }
+      for (bool active = root() != nullptr; active;) {
+        active = false;
+        for (size_type i = 0; i < n; ++i) {
+          Node* node = cursor[i];
+          if (node == nullptr) continue;
+          if (compare_(key_of(node), first[i])) {
+            node = node->right;
+          } else {
+            found[i] = node;
+            node = node->left;
+          }
+          cursor[i] = node;
+          if (node) {
+            __builtin_prefetch(node);
+            active = true;
+          }
+        }
+      }
+      for (size_type i = 0; i < n; ++i) {
+        Node* node = found[i];
+        emit(node != header_ && !compare_(first[i], key_of(node)) ? node
+                                                                 : header_);
+      }
+      first += n;
+    }
+  }
+
+  // Links the next n nodes of the chain into a subtree whose root is the
+  // median, and advances list past them. Every leaf ends up at depth
+  // red_depth or one above it, so coloring the nodes at red_depth red and
+  // all others black gives every path the same black height.
+  static Node* build_balanced(Node*& list, size_type n, size_type depth,
+                              size_type red_depth) {
+    if (n == 0) return nullptr;
+    size_type left_count = (n - 1) / 2;
+    Node* left = build_balanced(list, left_count, depth + 1, red_depth);
+    Node* node = list;
+    list = list->right;
+    node->left = left;
+    if (left) left->parent = node;
+    node->right =
+        build_balanced(list, n - left_count - 1, depth + 1, red_depth);
+    if (node->right) node->right->parent = node;
+    node->count = n;
+    node->color = depth == red_depth ? kRed : kBlack;
+    summarize(node);
+    return node;
+  }
+
+  // The same as above for n nodes stored in order in an array, which lets
+  // the two halves be linked in parallel.
+  static Node* build_balanced(Node** nodes, size_type n, size_type depth,
+                              size_type red_depth, ThreadPool* threads) {
+    if (n == 0) return nullptr;
+    size_type left_count = (n - 1) / 2;
+    Node* node = nodes[left_count];
+    fork(
+        threads, n,
+        [&] {
+          node->left =
+              build_balanced(nodes, left_count, depth + 1, red_depth, threads);
+        },
+        [&] {
+          node->right = build_balanced(nodes + left_count + 1,
+                                       n - left_count - 1, depth + 1,
+                                       red_depth, threads);
+        });
+    if (node->left) node->left->parent = node;
+    if (node->right) node->right->parent = node;
+    node->count = n;
+    node->color = depth == red_depth ? kRed : kBlack;
+    summarize(node);
+    return node;
+  }
+
+  // Stable merge sort of nodes by key, sorting the halves in parallel.
+  static void sort_nodes(Node** first, Node** last, const NodeLess& less,
+                         ThreadPool& threads) {
+    size_type n = last - first;
+    if (n < kParallelGrain) {
+      std::stable_sort(first, last, less);
+      return;
+    }
+    Node** middle = first + n / 2;
+    threads.invoke([&] { sort_nodes(first, middle, less, threads); },
+                   [&] { sort_nodes(middle, last, less, threads); });
+    std::inplace_merge(first, middle, last, less);
+  }
+
+  template <class F>
+  static void for_each_node(Node* node, F& f, ThreadPool* threads) {
+    if (node == nullptr) return;
+    fork(
+        threads, node->count, [&] { for_each_node(node->left, f, threads); },
+        [&] {
+          f(node->key);
+          for_each_node(node->right, f, threads);
+        });
+  }
+
+  // Makes a sorted chain of n nodes linked through right pointers the
+  // contents of this tree, which must be empty.
+  void assign_chain(Node* head, Node* tail, size_type n) {
+    if (n == 0) return;
+    size_type red_depth = 0;
+    while ((size_type(2) << red_depth) <= n) ++red_depth;
+    leftmost() = head;
+    rightmost() = tail;
+    root() = build_balanced(head, n, 0, red_depth);
+    root()->parent = header_;
+    root()->color = kBlack;
+  }
+
+  // Prepends the nodes of a detached subtree to list in order, linked
+  // through their right pointers.
+  static Node* flatten(Node* node, Node* list) {
+    while (node) {
+      list = flatten(node->right, list);
+      node->right = list;
+      list = node;
+      node = node->left;
+    }
+    return list;
+  }
+
+  // Replaces the contents with a copy of t that has the same shape and
+  // colors. Nodes are taken from reuse, a chain linked through the right
+  // pointers, before new ones are created, and the rest of it is destroyed.
+  // If an element throws, the tree is left empty.
+  void clone_from(const BinaryTree& t, Node* reuse) {
+    reset_header();
+    try {
+      if (t.root()) {
+        root() = clone_subtree(t.root(), header_, reuse);
+        leftmost() = minimum(root());
+        rightmost() = maximum(root());
+      }
+    } catch (...) {
+      destroy_chain(reuse);
+      throw;
+    }
+    destroy_chain(reuse);
+  }
+
+  Node* clone_subtree(const Node* node, Node* parent, Node*& reuse) {
+    Node* copy;
+    if (reuse) {
+      copy = reuse;
+      reuse = reuse->right;
+      copy = pool_.recreate(copy, std::in_place, node->key);
     } else {
-      replacement->left = node->left;
-      replacement->right = node->right;
-      if (replacement == replacement->parent->left)
-        replacement->parent->left = nullptr;
-      else
-        replacement->parent->right = nullptr;
+      copy = pool_.create(std::in_place, node->key);
     }
-    if (replacement != node->right) {
-      node->right->parent = replacement;
+    copy->parent = parent;
+    copy->count = node->count;
+    copy->color = node->color;
+    try {
+      if (node->left) copy->left = clone_subtree(node->left, copy, reuse);
+      if (node->right) copy->right = clone_subtree(node->right, copy, reuse);
+    } catch (...) {
+      destroy_subtree(copy);
+      throw;
     }
-    if (replacement != node->left) {
-      node->left->parent = replacement;
+    summarize(copy);
+    return copy;
+  }
+
+  void destroy_chain(Node* list) {
+    while (list) {
+      Node* next = list->right;
+      pool_.destroy(list);
+      list = next;
     }
-    if (node == root) {
-      root = replacement;
-      replacement->parent = nullptr;
+  }
+
+  // A subtree detached from any tree. Its root is black unless it is empty,
+  // and height is its black height: the number of black nodes on every path
+  // from the root down to a missing child.
+  struct Subtree {
+    Node* root;
+    size_type height;
+  };
+
+  // Detaches every node, leaving this tree empty.
+  Subtree detach() {
+    Subtree res{root(), 0};
+    for (Node* node = root(); node; node = node->left)
+      if (node->color == kBlack) ++res.height;
+    reset_header();
+    return res;
+  }
+
+  // Detaches every node of other and hands it to this tree's pool: the pools
+  // share if the allocators are equal, otherwise the elements are moved into
+  // nodes allocated here.
+  Subtree adopt(BinaryTree& other) {
+    if (pool_.share(other.pool_)) return other.detach();
+    BinaryTree moved(compare_, get_allocator());
+    moved.merge_equal(other);
+    pool_.splice(moved.pool_);
+    return moved.detach();
+  }
+
+  // Makes a subtree the contents of this tree, which must be empty.
+  void attach(Subtree t) {
+    if (t.root == nullptr) return;
+    root() = t.root;
+    t.root->parent = header_;
+    leftmost() = minimum(t.root);
+    rightmost() = maximum(t.root);
+  }
+
+  // Detaches a child of a subtree root of the given black height. A red
+  // child is recolored black, which raises its own black height by one.
+  static Subtree child(Node* node, size_type parent_height) {
+    if (node && node->color == kRed) {
+      node->color = kBlack;
+      return Subtree{node, parent_height};
+    }
+    return Subtree{node, parent_height - 1};
+  }
+
+  // Nodes dropped by a set operation, linked through their right pointers.
+  // Workers collect them in lists of their own, since the pool is not
+  // thread-safe, and the lists are destroyed once the operation is done.
+  struct NodeList {
+    Node* head = nullptr;
+    Node* tail = nullptr;
+
+    void push(Node* node) {
+      node->right = head;
+      head = node;
+      if (tail == nullptr) tail = node;
+    }
+
+    void append(NodeList& other) {
+      if (other.head == nullptr) return;
+      (tail ? tail->right : head) = other.head;
+      tail = other.tail;
+    }
+  };
+
+  void destroy_list(NodeList& list) {
+    while (list.head) {
+      Node* next = list.head->right;
+      pool_.destroy(list.head);
+      list.head = next;
+    }
+    list.tail = nullptr;
+  }
+
+  // Runs f and g, in parallel if threads are given and the two cover at
+  // least kParallelGrain elements between them.
+  template <class F, class G>
+  static void fork(ThreadPool* threads, size_type n, F&& f, G&& g) {
+    if (threads && n >= kParallelGrain) {
+      threads->invoke(f, g);
     } else {
-      if (node == node->parent->left)
-        node->parent->left = replacement;
-      else
-        node->parent->right = replacement;
-      replacement->parent = node->parent;
+      f();
+      g();
     }
   }
 
-  void remove_one_child_node(Node* node) {
-    if (node == root) {
-      root = node->left ? node->left : node->right;
+  static Node* rotate_subtree_left(Node* node) {
+    Node* pivot = node->right;
+    node->right = pivot->left;
+    if (pivot->left) pivot->left->parent = node;
+    pivot->left = node;
+    node->parent = pivot;
+    pivot->count = node->count;
+    node->count = subtree_size(node->left) + subtree_size(node->right) + 1;
+    summarize(node);
+    summarize(pivot);
+    return pivot;
+  }
+
+  static Node* rotate_subtree_right(Node* node) {
+    Node* pivot = node->left;
+    node->left = pivot->right;
+    if (pivot->right) pivot->right->parent = node;
+    pivot->right = node;
+    node->parent = pivot;
+    pivot->count = node->count;
+    node->count = subtree_size(node->left) + subtree_size(node->right) + 1;
+    summarize(node);
+    summarize(pivot);
+    return pivot;
+  }
+
+  // Links node as a red node in place of the first black node of black
+  // height low_height on the right spine of t, whose black height is
+  // height, and fixes a red node under a red node on the way back up. The
+  // returned root may be red with a red right child.
+  static Node* join_right(Node* t, size_type height, Node* node, Node* right,
+                          size_type low_height) {
+    if (is_black(t) && height == low_height) {
+      node->left = t;
+      node->right = right;
+      if (t) t->parent = node;
+      if (right) right->parent = node;
+      node->color = kRed;
+      node->count = subtree_size(t) + subtree_size(right) + 1;
+      summarize(node);
+      return node;
+    }
+    Node* c = join_right(t->right, height - is_black(t), node, right,
+                         low_height);
+    t->right = c;
+    c->parent = t;
+    t->count = subtree_size(t->left) + c->count + 1;
+    summarize(t);
+    if (t->color == kBlack && c->color == kRed && !is_black(c->right)) {
+      c->right->color = kBlack;
+      return rotate_subtree_left(t);
+    }
+    return t;
+  }
+
+  // The mirror image of join_right, along the left spine of t.
+  static Node* join_left(Node* t, size_type height, Node* node, Node* left,
+                         size_type low_height) {
+    if (is_black(t) && height == low_height) {
+      node->left = left;
+      node->right = t;
+      if (left) left->parent = node;
+      if (t) t->parent = node;
+      node->color = kRed;
+      node->count = subtree_size(left) + subtree_size(t) + 1;
+      summarize(node);
+      return node;
+    }
+    Node* c = join_left(t->left, height - is_black(t), node, left,
+                        low_height);
+    t->left = c;
+    c->parent = t;
+    t->count = c->count + subtree_size(t->right) + 1;
+    summarize(t);
+    if (t->color == kBlack && c->color == kRed && !is_black(c->left)) {
+      c->left->color = kBlack;
+      return rotate_subtree_right(t);
+    }
+    return t;
+  }
+
+  // Returns the subtree of left, node and right, in that order. Only the
+  // spine of the higher subtree down to the black height of the lower one
+  // is visited, so the cost is O(|left.height - right.height| + 1).
+  static Subtree join(Subtree left, Node* node, Subtree right) {
+    Subtree res{nullptr, std::max(left.height, right.height)};
+    if (left.height >= right.height)
+      res.root = join_right(left.root, left.height, node, right.root,
+                            right.height);
+    else
+      res.root = join_left(right.root, right.height, node, left.root,
+                           left.height);
+    if (res.root->color == kRed) {
+      res.root->color = kBlack;
+      ++res.height;
+    }
+    return res;
+  }
+
+  // Returns the subtree of left, then right.
+  static Subtree concat(Subtree left, Subtree right) {
+    if (left.root == nullptr) return right;
+    if (right.root == nullptr) return left;
+    Node* last = nullptr;
+    left = split_last(left, last);
+    return join(left, last, right);
+  }
+
+  // Detaches the last node of a non-empty subtree into last and returns the
+  // remaining nodes.
+  static Subtree split_last(Subtree t, Node*& last) {
+    Node* node = t.root;
+    Subtree left = child(node->left, t.height);
+    if (node->right == nullptr) {
+      last = node;
+      return left;
+    }
+    Subtree rest = split_last(child(node->right, t.height), last);
+    return join(left, node, rest);
+  }
+
+  // Splits a subtree into the nodes with keys less than key, stored in left,
+  // and greater than key, stored in right. Returns the detached node with
+  // an equivalent key, or nullptr.
+  Node* split(Subtree t, const key_type& key, Subtree& left,
+              Subtree& right) const {
+    if (t.root == nullptr) {
+      left = right = t;
+      return nullptr;
+    }
+    Node* node = t.root;
+    Subtree l = child(node->left, t.height);
+    Subtree r = child(node->right, t.height);
+    if (compare_(key, key_of(node))) {
+      Node* found = split(l, key, left, l);
+      right = join(l, node, r);
+      return found;
+    }
+    if (compare_(key_of(node), key)) {
+      Node* found = split(r, key, r, right);
+      left = join(l, node, r);
+      return found;
+    }
+    left = l;
+    right = r;
+    return node;
+  }
+
+  // Splits a subtree into the nodes with keys less than key, stored in left,
+  // and the others, stored in right. With equal_left, the nodes with keys
+  // equivalent to key are stored in left instead.
+  void split_at(Subtree t, const key_type& key, bool equal_left,
+                Subtree& left, Subtree& right) const {
+    if (t.root == nullptr) {
+      left = right = t;
+      return;
+    }
+    Node* node = t.root;
+    Subtree l = child(node->left, t.height);
+    Subtree r = child(node->right, t.height);
+    if (equal_left ? !compare_(key, key_of(node))
+                   : compare_(key_of(node), key)) {
+      split_at(r, key, equal_left, r, right);
+      left = join(l, node, r);
     } else {
-      if (node == node->parent->left) {
-        if (node->left)
-          node->parent->left = node->left;
-        else
-          node->parent->left = node->right;
+      split_at(l, key, equal_left, left, l);
+      right = join(l, node, r);
+    }
+  }
+
+  // Splits a subtree into the nodes with keys less than, equivalent to and
+  // greater than key.
+  void split_equal(Subtree t, const key_type& key, Subtree& less,
+                   Subtree& equal, Subtree& greater) const {
+    if (t.root == nullptr) {
+      less = equal = greater = t;
+      return;
+    }
+    Node* node = t.root;
+    Subtree l = child(node->left, t.height);
+    Subtree r = child(node->right, t.height);
+    if (compare_(key, key_of(node))) {
+      split_equal(l, key, less, equal, l);
+      greater = join(l, node, r);
+    } else if (compare_(key_of(node), key)) {
+      split_equal(r, key, r, equal, greater);
+      less = join(l, node, r);
+    } else {
+      split_at(l, key, false, less, l);
+      split_at(r, key, true, r, greater);
+      equal = join(l, node, r);
+    }
+  }
+
+  // Splits a subtree into its first n nodes, stored in left, and the rest.
+  static void split_rank(Subtree t, size_type n, Subtree& left,
+                         Subtree& right) {
+    if (t.root == nullptr) {
+      left = right = t;
+      return;
+    }
+    Node* node = t.root;
+    Subtree l = child(node->left, t.height);
+    Subtree r = child(node->right, t.height);
+    if (n <= subtree_size(l.root)) {
+      split_rank(l, n, left, l);
+      right = join(l, node, r);
+    } else {
+      split_rank(r, n - subtree_size(l.root) - 1, r, right);
+      left = join(l, node, r);
+    }
+  }
+
+  // The set operations below split b around the root of a, recurse on both
+  // sides and join the results, keeping the node of a on equal keys. The
+  // right side collects its dropped nodes separately so the two sides can
+  // run in parallel.
+  Subtree unite(Subtree a, Subtree b, NodeList& dropped,
+                ThreadPool* threads) const {
+    if (a.root == nullptr) return b;
+    if (b.root == nullptr) return a;
+    Node* node = a.root;
+    size_type n = node->count + b.root->count;
+    Subtree a_left = child(node->left, a.height);
+    Subtree a_right = child(node->right, a.height);
+    Subtree b_left, b_right;
+    Node* found = split(b, key_of(node), b_left, b_right);
+    if (found) dropped.push(found);
+    NodeList right_dropped;
+    fork(
+        threads, n,
+        [&] { a_left = unite(a_left, b_left, dropped, threads); },
+        [&] { a_right = unite(a_right, b_right, right_dropped, threads); });
+    dropped.append(right_dropped);
+    return join(a_left, node, a_right);
+  }
+
+  Subtree intersect(Subtree a, Subtree b, NodeList& dropped,
+                    ThreadPool* threads) const {
+    if (a.root == nullptr || b.root == nullptr) {
+      drop_subtree(a.root, dropped);
+      drop_subtree(b.root, dropped);
+      return Subtree{nullptr, 0};
+    }
+    Node* node = a.root;
+    size_type n = node->count + b.root->count;
+    Subtree a_left = child(node->left, a.height);
+    Subtree a_right = child(node->right, a.height);
+    Subtree b_left, b_right;
+    Node* found = split(b, key_of(node), b_left, b_right);
+    NodeList right_dropped;
+    fork(
+        threads, n,
+        [&] { a_left = intersect(a_left, b_left, dropped, threads); },
+        [&] {
+          a_right = intersect(a_right, b_right, right_dropped, threads);
+        });
+    dropped.append(right_dropped);
+    if (found == nullptr) {
+      dropped.push(node);
+      return concat(a_left, a_right);
+    }
+    dropped.push(found);
+    return join(a_left, node, a_right);
+  }
+
+  // Splits a around the root of b instead, since the nodes of b are dropped.
+  Subtree subtract(Subtree a, Subtree b, NodeList& dropped,
+                   ThreadPool* threads) const {
+    if (a.root == nullptr || b.root == nullptr) {
+      drop_subtree(b.root, dropped);
+      return a;
+    }
+    Node* node = b.root;
+    size_type n = a.root->count + node->count;
+    Subtree b_left = child(node->left, b.height);
+    Subtree b_right = child(node->right, b.height);
+    Subtree a_left, a_right;
+    Node* found = split(a, key_of(node), a_left, a_right);
+    if (found) dropped.push(found);
+    NodeList right_dropped;
+    fork(
+        threads, n,
+        [&] { a_left = subtract(a_left, b_left, dropped, threads); },
+        [&] {
+          a_right = subtract(a_right, b_right, right_dropped, threads);
+        });
+    dropped.append(right_dropped);
+    dropped.push(node);
+    return concat(a_left, a_right);
+  }
+
+  Subtree symmetric_subtract(Subtree a, Subtree b, NodeList& dropped,
+                             ThreadPool* threads) const {
+    if (a.root == nullptr) return b;
+    if (b.root == nullptr) return a;
+    Node* node = a.root;
+    size_type n = node->count + b.root->count;
+    Subtree a_left = child(node->left, a.height);
+    Subtree a_right = child(node->right, a.height);
+    Subtree b_left, b_right;
+    Node* found = split(b, key_of(node), b_left, b_right);
+    NodeList right_dropped;
+    fork(
+        threads, n,
+        [&] { a_left = symmetric_subtract(a_left, b_left, dropped, threads); },
+        [&] {
+          a_right =
+              symmetric_subtract(a_right, b_right, right_dropped, threads);
+        });
+    dropped.append(right_dropped);
+    if (found == nullptr) return join(a_left, node, a_right);
+    dropped.push(found);
+    dropped.push(node);
+    return concat(a_left, a_right);
+  }
+
+  // Applies op to subtrees with equivalent keys. Both are split around the
+  // key of the root of a, the two sides are combined recursively and the
+  // runs of keys equivalent to it are resolved by resolve_run. The two
+  // sides may run in parallel, as in unite.
+  Subtree combine_equal(Subtree a, Subtree b, SetOperation op,
+                        NodeList& dropped, ThreadPool* threads) const {
+    if (a.root == nullptr || b.root == nullptr) {
+      bool keep_a = op != kIntersection;
+      bool keep_b = op == kUnion || op == kSymmetricDifference;
+      if (!keep_a) drop_subtree(a.root, dropped);
+      if (!keep_b) drop_subtree(b.root, dropped);
+      if (keep_a && a.root) return a;
+      return keep_b ? b : Subtree{nullptr, 0};
+    }
+    size_type n = a.root->count + b.root->count;
+    const key_type& key = key_of(a.root);
+    Subtree a_less, a_equal, a_greater, b_less, b_equal, b_greater;
+    split_equal(a, key, a_less, a_equal, a_greater);
+    split_equal(b, key, b_less, b_equal, b_greater);
+    NodeList greater_dropped;
+    fork(
+        threads, n,
+        [&] { a_less = combine_equal(a_less, b_less, op, dropped, threads); },
+        [&] {
+          a_greater = combine_equal(a_greater, b_greater, op, greater_dropped,
+                                    threads);
+        });
+    dropped.append(greater_dropped);
+    Subtree run = resolve_run(a_equal, b_equal, op, dropped);
+    return concat(concat(a_less, run), a_greater);
+  }
+
+  // Applies op to runs of equivalent keys. The first min(n, m) elements of
+  // each run match, the matched elements of a are kept by union and
+  // intersection, and the unmatched ones of either run are kept as by
+  // set_operation. The elements of a come first.
+  static Subtree resolve_run(Subtree a, Subtree b, SetOperation op,
+                             NodeList& dropped) {
+    size_type matched =
+        std::min(subtree_size(a.root), subtree_size(b.root));
+    Subtree a_matched, a_rest, b_matched, b_rest;
+    split_rank(a, matched, a_matched, a_rest);
+    split_rank(b, matched, b_matched, b_rest);
+    drop_subtree(b_matched.root, dropped);
+    if (op == kDifference || op == kSymmetricDifference) {
+      drop_subtree(a_matched.root, dropped);
+      a_matched = Subtree{nullptr, 0};
+    }
+    if (op == kIntersection) {
+      drop_subtree(a_rest.root, dropped);
+      a_rest = Subtree{nullptr, 0};
+    }
+    if (op == kIntersection || op == kDifference) {
+      drop_subtree(b_rest.root, dropped);
+      b_rest = Subtree{nullptr, 0};
+    }
+    return concat(concat(a_matched, a_rest), b_rest);
+  }
+
+  static void drop_subtree(Node* node, NodeList& dropped) {
+    while (node) {
+      drop_subtree(node->right, dropped);
+      Node* left = node->left;
+      dropped.push(node);
+      node = left;
+    }
+  }
+
+  void link_node(Node* node, Node* p, bool left) {
+    node->parent = p;
+    if (p == header_) {
+      root() = node;
+      leftmost() = node;
+      rightmost() = node;
+    } else if (left) {
+      p->left = node;
+      if (p == leftmost()) leftmost() = node;
+    } else {
+      p->right = node;
+      if (p == rightmost()) rightmost() = node;
+    }
+    summarize(node);
+    for (; p != header_; p = p->parent) {
+      ++p->count;
+      summarize(p);
+    }
+    rebalance_after_insert(node);
+  }
+
+  void replace_child(Node* p, Node* old_child, Node* new_child) {
+    if (p == header_)
+      root() = new_child;
+    else if (p->left == old_child)
+      p->left = new_child;
+    else
+      p->right = new_child;
+  }
+
+  void rotate_left(Node* node) {
+    Node* pivot = node->right;
+    node->right = pivot->left;
+    if (pivot->left) pivot->left->parent = node;
+    pivot->parent = node->parent;
+    replace_child(node->parent, node, pivot);
+    pivot->left = node;
+    node->parent = pivot;
+    pivot->count = node->count;
+    node->count = subtree_size(node->left) + subtree_size(node->right) + 1;
+    summarize(node);
+    summarize(pivot);
+  }
+
+  void rotate_right(Node* node) {
+    Node* pivot = node->left;
+    node->left = pivot->right;
+    if (pivot->right) pivot->right->parent = node;
+    pivot->parent = node->parent;
+    replace_child(node->parent, node, pivot);
+    pivot->right = node;
+    node->parent = pivot;
+    pivot->count = node->count;
+    node->count = subtree_size(node->left) + subtree_size(node->right) + 1;
+    summarize(node);
+    summarize(pivot);
+  }
+
+  void rebalance_after_insert(Node* node) {
+    while (node != root() && node->parent->color == kRed) {
+      Node* p = node->parent;
+      Node* grandparent = p->parent;
+      if (p == grandparent->left) {
+        Node* uncle = grandparent->right;
+        if (!is_black(uncle)) {
+          p->color = kBlack;
+          uncle->color = kBlack;
+          grandparent->color = kRed;
+          node = grandparent;
+        } else {
+          if (node == p->right) {
+            node = p;
+            rotate_left(node);
+            p = node->parent;
+          }
+          p->color = kBlack;
+          grandparent->color = kRed;
+          rotate_right(grandparent);
+        }
       } else {
-        if (node->left) {
-          node->parent->right = node->left;
+        Node* uncle = grandparent->left;
+        if (!is_black(uncle)) {
+          p->color = kBlack;
+          uncle->color = kBlack;
+          grandparent->color = kRed;
+          node = grandparent;
         } else {
-          node->parent->right = node->right;
+          if (node == p->left) {
+            node = p;
+            rotate_right(node);
+            p = node->parent;
+          }
+          p->color = kBlack;
+          grandparent->color = kRed;
+          rotate_left(grandparent);
         }
       }
     }
-    if (node->left) {
-      node->left->parent = node->left == root ? nullptr : node->parent;
+    root()->color = kBlack;
+  }
+
+  // Restores the black height after a black node was unlinked from below p.
+  // node is the subtree that took its place and may be nullptr.
+  void rebalance_after_remove(Node* node, Node* p) {
+    while (node != root() && is_black(node)) {
+      if (node == p->left) {
+        Node* sibling = p->right;
+        if (!is_black(sibling)) {
+          sibling->color = kBlack;
+          p->color = kRed;
+          rotate_left(p);
+          sibling = p->right;
+        }
+        if (is_black(sibling->left) && is_black(sibling->right)) {
+          sibling->color = kRed;
+          node = p;
+          p = node->parent;
+        } else {
+          if (is_black(sibling->right)) {
+            sibling->left->color = kBlack;
+            sibling->color = kRed;
+            rotate_right(sibling);
+            sibling = p->right;
+          }
+          sibling->color = p->color;
+          p->color = kBlack;
+          sibling->right->color = kBlack;
+          rotate_left(p);
+          node = root();
+        }
+      } else {
+        Node* sibling = p->left;
+        if (!is_black(sibling)) {
+          sibling->color = kBlack;
+          p->color = kRed;
+          rotate_right(p);
+          sibling = p->left;
+        }
+        if (is_black(sibling->left) && is_black(sibling->right)) {
+          sibling->color = kRed;
+          node = p;
+          p = node->parent;
+        } else {
+          if (is_black(sibling->left)) {
+            sibling->right->color = kBlack;
+            sibling->color = kRed;
+            rotate_left(sibling);
+            sibling = p->left;
+          }
+          sibling->color = p->color;
+          p->color = kBlack;
+          sibling->left->color = kBlack;
+          rotate_right(p);
+          node = root();
+        }
+      }
+    }
+    if (node) node->color = kBlack;
+  }
+
+  // Swaps the node with its in-order successor, so it can be unlinked from
+  // a position with at most one child. Nodes are relinked rather than keys
+  // swapped, so iterators to other elements stay valid.
+  void remove_two_children_node(Node* node) {
+    Node* successor = minimum(node->right);
+    Node* p = node->parent;
+    Node* left = node->left;
+    Node* right = node->right;
+    Node* successor_parent = successor->parent;
+    Node* successor_right = successor->right;
+    replace_child(p, node, successor);
+    successor->parent = p;
+    successor->left = left;
+    left->parent = successor;
+    if (successor == right) {
+      successor->right = node;
+      node->parent = successor;
     } else {
-      node->right->parent = node->right == root ? nullptr : node->parent;
+      successor->right = right;
+      right->parent = successor;
+      successor_parent->left = node;
+      node->parent = successor_parent;
     }
+    node->left = nullptr;
+    node->right = successor_right;
+    if (successor_right) successor_right->parent = node;
+    Color color = node->color;
+    node->color = successor->color;
+    successor->color = color;
+    size_type subtree_count = node->count;
+    node->count = successor->count;
+    successor->count = subtree_count;
+    remove_node(node);
+  }
+
+  // A node with a single child is black and its child is a red leaf.
+  void remove_one_child_node(Node* node) {
+    Node* child = node->left ? node->left : node->right;
+    replace_child(node->parent, node, child);
+    child->parent = node->parent;
+    child->color = kBlack;
+    summarize_path(child->parent);
   }
 
   void remove_childless_node(Node* node) {
-    if (node == node->parent->left)
-      node->parent->left = nullptr;
-    else
-      node->parent->right = nullptr;
+    Node* p = node->parent;
+    replace_child(p, node, nullptr);
+    summarize_path(p);
+    if (p != header_ && node->color == kBlack)
+      rebalance_after_remove(nullptr, p);
   }
 };
 }  // namespace containers
@@ -0,0 +1,705 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "node_pool.h"
+
+namespace containers {
+// B+tree for btree_set and btree_map. Elements live only in the leaves, which
+// are linked in key order, and inner nodes hold copies of separator keys. A
+// node holds as many elements as fit in kNodeBytes, so a lookup touches one
+// node per level and a scan walks contiguous arrays. Keys and mapped values
+// are kept in separate arrays of a leaf, so a search reads keys only.
+//
+// Mapped is void for sets. For maps an iterator yields a pair of references
+// to the key and the mapped value instead of a reference to a stored pair.
+// Inserting or erasing an element invalidates all iterators.
+template <class Key, class Mapped, class Compare = std::less<Key>,
+          class Allocator = std::allocator<Key>>
+class BTree {
+  static constexpr bool kIsSet = std::is_void<Mapped>::value;
+  using stored_mapped =
+      typename std::conditional<kIsSet, char, Mapped>::type;
+
+ public:
+  using key_type = Key;
+  using size_type = size_t;
+  using key_compare = Compare;
+  using allocator_type = Allocator;
+  using reference = typename std::conditional<
+      kIsSet, const key_type&,
+      std::pair<const key_type&, stored_mapped&>>::type;
+
+  static constexpr size_type kNodeBytes = 256;
+
+ private:
+  static constexpr size_type kMinSlots = 4;
+  static constexpr size_type kLeafSlots = std::max(
+      kMinSlots,
+      (kNodeBytes - 3 * sizeof(void*)) /
+          (sizeof(key_type) + (kIsSet ? 0 : sizeof(stored_mapped))));
+  static constexpr size_type kInnerSlots =
+      std::max(kMinSlots, (kNodeBytes - 2 * sizeof(void*)) /
+                              (sizeof(key_type) + sizeof(void*)));
+  static constexpr size_type kMinLeafCount = kLeafSlots / 2;
+  static constexpr size_type kMinInnerCount = (kInnerSlots - 1) / 2;
+  // Every inner node but the root has at least two children.
+  static constexpr size_type kMaxHeight =
+      std::numeric_limits<size_type>::digits;
+
+  // Uninitialized storage for N objects, constructed and destroyed by the
+  // tree as elements come and go.
+  template <class T, size_type N>
+  struct Slots {
+    alignas(T) unsigned char data[N * sizeof(T)];
+
+    T* get() { return reinterpret_cast<T*>(data); }
+    T& operator[](size_type i) { return get()[i]; }
+  };
+
+  struct Node {
+    explicit Node(bool is_leaf) : count(0), leaf(is_leaf) {}
+
+    unsigned short count;
+    bool leaf;
+  };
+
+  struct Leaf : Node {
+    Leaf() : Node(true), prev(this), next(this) {}
+
+    Leaf* prev;
+    Leaf* next;
+    Slots<key_type, kLeafSlots> keys;
+    Slots<stored_mapped, kIsSet ? 1 : kLeafSlots> values;
+  };
+
+  // Keys in children[i] are less than keys[i], and keys in children[i + 1]
+  // are not less than keys[i].
+  struct Inner : Node {
+    Inner() : Node(false) {}
+
+    Slots<key_type, kInnerSlots> keys;
+    Node* children[kInnerSlots + 1];
+  };
+
+ public:
+  class iterator {
+    friend class BTree;
+
+   public:
+    iterator() : leaf_(nullptr), pos_(0) {}
+
+    // Keeps the element reference alive for operator->.
+    struct arrow {
+      reference ref;
+      const typename std::remove_reference<reference>::type* operator->()
+          const {
+        return &ref;
+      }
+    };
+
+    reference operator*() const { return element(leaf_, pos_); }
+
+    arrow operator->() const { return arrow{**this}; }
+
+    iterator& operator++() {
+      if (++pos_ == leaf_->count) {
+        leaf_ = leaf_->next;
+        pos_ = 0;
+      }
+      return *this;
+    }
+
+    iterator operator++(int) {
+      iterator ret(*this);
+      ++(*this);
+      return ret;
+    }
+
+    iterator& operator--() {
+      if (pos_ == 0) {
+        leaf_ = leaf_->prev;
+        pos_ = leaf_->count;
+      }
+      --pos_;
+      return *this;
+    }
+
+    iterator operator--(int) {
+      iterator ret(*this);
+      --(*this);
+      return ret;
+    }
+
+    bool operator==(const iterator& i) const {
+      return leaf_ == i.leaf_ && pos_ == i.pos_;
+    }
+    bool operator!=(const iterator& i) const { return !(*this == i); }
+
+   private:
+    iterator(Leaf* leaf, size_type pos) : leaf_(leaf), pos_(pos) {}
+
+    Leaf* leaf_;
+    size_type pos_;
+  };
+
+  using const_iterator = iterator;
+
+  BTree() : BTree(Compare(), Allocator()) {}
+  explicit BTree(const Allocator& alloc) : BTree(Compare(), alloc) {}
+  explicit BTree(const Compare& comp, const Allocator& alloc = Allocator())
+      : header_(nullptr),
+        root_(nullptr),
+        size_(0),
+        compare_(comp),
+        leaf_pool_(alloc),
+        inner_pool_(alloc) {
+    header_ = leaf_pool_.create_standalone();
+  }
+  BTree(const BTree& t)
+      : BTree(t.compare_, std::allocator_traits<Allocator>::
+                              select_on_container_copy_construction(
+                                  t.get_allocator())) {
+    for (Leaf* leaf = t.header_->next; leaf != t.header_; leaf = leaf->next) {
+      for (size_type i = 0; i < leaf->count; ++i) {
+        if constexpr (kIsSet)
+          insert_unique(leaf->keys[i]);
+        else
+          insert_unique(leaf->keys[i], leaf->values[i]);
+      }
+    }
+  }
+  BTree(BTree&& t) : BTree(t.compare_, t.get_allocator()) { swap(t); }
+  ~BTree() {
+    clear();
+    leaf_pool_.destroy_standalone(header_);
+  }
+  BTree& operator=(BTree&& t) {
+    if (&t == this) return *this;
+    clear();
+    swap(t);
+    return *this;
+  }
+
+  allocator_type get_allocator() const { return leaf_pool_.get_allocator(); }
+
+  key_compare key_comp() const { return compare_; }
+
+  iterator begin() const { return iterator(header_->next, 0); }
+
+  iterator end() const { return iterator(header_, 0); }
+
+  bool empty() const { return size_ == 0; }
+
+  size_type size() const { return size_; }
+
+  size_type max_size() const {
+    return std::numeric_limits<intmax_t>::max() /
+           (sizeof(key_type) + (kIsSet ? 0 : sizeof(stored_mapped)));
+  }
+
+  void clear() {
+    if (root_ && !(std::is_trivially_destructible<key_type>::value &&
+                   std::is_trivially_destructible<stored_mapped>::value))
+      destroy_subtree(root_);
+    leaf_pool_.release();
+    inner_pool_.release();
+    root_ = nullptr;
+    size_ = 0;
+    header_->prev = header_->next = header_;
+  }
+
+  void erase(iterator pos) {
+    Inner* path[kMaxHeight];
+    size_type slots[kMaxHeight];
+    size_type depth = 0;
+    Leaf* leaf = find_leaf(pos.leaf_->keys[pos.pos_], path, slots, &depth);
+    destroy_element(leaf, pos.pos_);
+    relocate_elements(leaf, pos.pos_, leaf, pos.pos_ + 1,
+                      leaf->count - pos.pos_ - 1);
+    --leaf->count;
+    --size_;
+    if (depth == 0) {
+      if (leaf->count == 0) {
+        unlink_leaf(leaf);
+        leaf_pool_.destroy(leaf);
+        root_ = nullptr;
+      }
+      return;
+    }
+    Node* node = leaf;
+    for (; depth > 0; --depth) {
+      Inner* parent = path[depth - 1];
+      size_type i = slots[depth - 1];
+      if (node->leaf) {
+        if (node->count >= kMinLeafCount ||
+            !rebalance_leaf(static_cast<Leaf*>(node), parent, i))
+          return;
+      } else {
+        if (node->count >= kMinInnerCount ||
+            !rebalance_inner(static_cast<Inner*>(node), parent, i))
+          return;
+      }
+      node = parent;
+    }
+    if (root_->count == 0) {
+      Inner* old_root = static_cast<Inner*>(root_);
+      root_ = old_root->children[0];
+      inner_pool_.destroy(old_root);
+    }
+  }
+
+  void swap(BTree& other) {
+    std::swap(header_, other.header_);
+    std::swap(root_, other.root_);
+    std::swap(size_, other.size_);
+    std::swap(compare_, other.compare_);
+    leaf_pool_.swap(other.leaf_pool_);
+    inner_pool_.swap(other.inner_pool_);
+  }
+
+  iterator find(const key_type& key) const { return find_key(key); }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator find(const K& key) const {
+    return find_key(key);
+  }
+
+  bool contains(const key_type& key) const { return find_key(key) != end(); }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  bool contains(const K& key) const {
+    return find_key(key) != end();
+  }
+
+  size_type count(const key_type& key) const { return contains(key); }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  size_type count(const K& key) const {
+    return contains(key);
+  }
+
+  // Returns the first element whose key is not less than the given one.
+  iterator lower_bound(const key_type& key) const {
+    Leaf* leaf = find_leaf(key);
+    if (leaf == nullptr) return end();
+    return leaf_iterator(leaf, leaf_lower_bound(leaf, key));
+  }
+
+  // Returns the first element whose key is greater than the given one.
+  iterator upper_bound(const key_type& key) const {
+    Leaf* leaf = find_leaf(key);
+    if (leaf == nullptr) return end();
+    return leaf_iterator(leaf, leaf_upper_bound(leaf, key));
+  }
+
+ protected:
+  // Inserts an element with the given key, constructing its mapped value
+  // from args, unless an element with an equivalent key exists. Nothing is
+  // constructed from key or args in that case.
+  template <class K, class... Args>
+  std::pair<iterator, bool> insert_unique(K&& key, Args&&... args) {
+    if (root_ == nullptr) {
+      Leaf* leaf = leaf_pool_.create();
+      link_leaf(header_, leaf);
+      root_ = leaf;
+    }
+    Inner* path[kMaxHeight];
+    size_type slots[kMaxHeight];
+    size_type depth = 0;
+    Leaf* leaf = find_leaf(key, path, slots, &depth);
+    size_type pos = leaf_lower_bound(leaf, key);
+    if (pos < leaf->count && !compare_(key, leaf->keys[pos]))
+      return std::pair<iterator, bool>{iterator(leaf, pos), false};
+    if (leaf->count == kLeafSlots) {
+      Leaf* right = split_leaf(leaf, path, slots, depth);
+      if (pos > kMinLeafCount) {
+        leaf = right;
+        pos -= kMinLeafCount;
+      }
+    }
+    relocate_elements(leaf, pos + 1, leaf, pos, leaf->count - pos);
+    try {
+      construct_element(leaf, pos, std::forward<K>(key),
+                        std::forward<Args>(args)...);
+    } catch (...) {
+      relocate_elements(leaf, pos, leaf, pos + 1, leaf->count - pos);
+      if (leaf->count == 0) {
+        unlink_leaf(leaf);
+        leaf_pool_.destroy(leaf);
+        root_ = nullptr;
+      }
+      throw;
+    }
+    ++leaf->count;
+    ++size_;
+    return std::pair<iterator, bool>{iterator(leaf, pos), true};
+  }
+
+  // Moves every element of other whose key is not in this tree into it.
+  void merge_unique(BTree& other) {
+    if (&other == this) return;
+    BTree rest(other.compare_, other.get_allocator());
+    for (Leaf* leaf = other.header_->next; leaf != other.header_;
+         leaf = leaf->next) {
+      for (size_type i = 0; i < leaf->count; ++i) {
+        if constexpr (kIsSet) {
+          if (!insert_unique(std::move(leaf->keys[i])).second)
+            rest.insert_unique(std::move(leaf->keys[i]));
+        } else {
+          if (!insert_unique(std::move(leaf->keys[i]),
+                             std::move(leaf->values[i]))
+                   .second)
+            rest.insert_unique(std::move(leaf->keys[i]),
+                               std::move(leaf->values[i]));
+        }
+      }
+    }
+    other.swap(rest);
+  }
+
+  static reference element(Leaf* leaf, size_type pos) {
+    if constexpr (kIsSet)
+      return leaf->keys[pos];
+    else
+      return reference(leaf->keys[pos], leaf->values[pos]);
+  }
+
+ private:
+  // The header is a leaf without elements that closes the circular list of
+  // leaves, so it serves as the end iterator.
+  Leaf* header_;
+  Node* root_;
+  size_type size_;
+  Compare compare_;
+  NodePool<Leaf, Allocator> leaf_pool_;
+  NodePool<Inner, Allocator> inner_pool_;
+
+  // Moves n objects from src to dst, which may overlap.
+  template <class T>
+  static void relocate(T* dst, T* src, size_type n) {
+    if (n == 0 || dst == src) return;
+    if constexpr (std::is_trivially_copyable<T>::value) {
+      std::memmove(static_cast<void*>(dst), static_cast<void*>(src),
+                   n * sizeof(T));
+    } else if (dst < src) {
+      for (size_type i = 0; i < n; ++i) {
+        new (dst + i) T(std::move(src[i]));
+        src[i].~T();
+      }
+    } else {
+      for (size_type i = n; i-- > 0;) {
+        new (dst + i) T(std::move(src[i]));
+        src[i].~T();
+      }
+    }
+  }
+
+  static void relocate_elements(Leaf* dst, size_type dst_pos, Leaf* src,
+                                size_type src_pos, size_type n) {
+    relocate(dst->keys.get() + dst_pos, src->keys.get() + src_pos, n);
+    if constexpr (!kIsSet)
+      relocate(dst->values.get() + dst_pos, src->values.get() + src_pos, n);
+  }
+
+  static void relocate_children(Inner* dst, size_type dst_pos, Inner* src,
+                                size_type src_pos, size_type n) {
+    relocate(dst->keys.get() + dst_pos, src->keys.get() + src_pos, n);
+    relocate(dst->children + dst_pos + 1, src->children + src_pos + 1, n);
+  }
+
+  template <class K, class... Args>
+  static void construct_element(Leaf* leaf, size_type pos, K&& key,
+                                Args&&... args) {
+    new (&leaf->keys[pos]) key_type(std::forward<K>(key));
+    if constexpr (!kIsSet) {
+      try {
+        new (&leaf->values[pos]) stored_mapped(std::forward<Args>(args)...);
+      } catch (...) {
+        leaf->keys[pos].~key_type();
+        throw;
+      }
+    }
+  }
+
+  static void destroy_element(Leaf* leaf, size_type pos) {
+    leaf->keys[pos].~key_type();
+    if constexpr (!kIsSet) leaf->values[pos].~stored_mapped();
+  }
+
+  void destroy_subtree(Node* node) {
+    if (node->leaf) {
+      Leaf* leaf = static_cast<Leaf*>(node);
+      for (size_type i = 0; i < leaf->count; ++i) destroy_element(leaf, i);
+    } else {
+      Inner* inner = static_cast<Inner*>(node);
+      for (size_type i = 0; i <= inner->count; ++i)
+        destroy_subtree(inner->children[i]);
+      for (size_type i = 0; i < inner->count; ++i) inner->keys[i].~key_type();
+    }
+  }
+
+  static void link_leaf(Leaf* prev, Leaf* leaf) {
+    leaf->prev = prev;
+    leaf->next = prev->next;
+    prev->next->prev = leaf;
+    prev->next = leaf;
+  }
+
+  static void unlink_leaf(Leaf* leaf) {
+    leaf->prev->next = leaf->next;
+    leaf->next->prev = leaf->prev;
+  }
+
+  // Returns an iterator to pos in leaf, or to the start of the next leaf if
+  // pos is past the last element.
+  static iterator leaf_iterator(Leaf* leaf, size_type pos) {
+    if (pos == leaf->count) return iterator(leaf->next, 0);
+    return iterator(leaf, pos);
+  }
+
+  template <class K>
+  size_type leaf_lower_bound(Leaf* leaf, const K& key) const {
+    size_type lo = 0;
+    size_type hi = leaf->count;
+    while (lo < hi) {
+      size_type mid = (lo + hi) / 2;
+      if (compare_(leaf->keys[mid], key))
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    return lo;
+  }
+
+  template <class K>
+  size_type leaf_upper_bound(Leaf* leaf, const K& key) const {
+    size_type lo = 0;
+    size_type hi = leaf->count;
+    while (lo < hi) {
+      size_type mid = (lo + hi) / 2;
+      if (compare_(key, leaf->keys[mid]))
+        hi = mid;
+      else
+        lo = mid + 1;
+    }
+    return lo;
+  }
+
+  // Returns the index of the child of inner that may hold the given key.
+  template <class K>
+  size_type child_index(Inner* inner, const K& key) const {
+    size_type lo = 0;
+    size_type hi = inner->count;
+    while (lo < hi) {
+      size_type mid = (lo + hi) / 2;
+      if (compare_(key, inner->keys[mid]))
+        hi = mid;
+      else
+        lo = mid + 1;
+    }
+    return lo;
+  }
+
+  // Returns the leaf that holds the given key if it is present, or nullptr
+  // if the tree is empty. If path is given, the inner nodes on the way and
+  // the index of the child taken in each are stored in path and slots.
+  template <class K>
+  Leaf* find_leaf(const K& key, Inner** path = nullptr,
+                  size_type* slots = nullptr,
+                  size_type* depth = nullptr) const {
+    Node* node = root_;
+    if (node == nullptr) return nullptr;
+    while (!node->leaf) {
+      Inner* inner = static_cast<Inner*>(node);
+      size_type i = child_index(inner, key);
+      if (path) {
+        path[*depth] = inner;
+        slots[(*depth)++] = i;
+      }
+      node = inner->children[i];
+    }
+    return static_cast<Leaf*>(node);
+  }
+
+  template <class K>
+  iterator find_key(const K& key) const {
+    Leaf* leaf = find_leaf(key);
+    if (leaf == nullptr) return end();
+    size_type pos = leaf_lower_bound(leaf, key);
+    if (pos < leaf->count && !compare_(key, leaf->keys[pos]))
+      return iterator(leaf, pos);
+    return end();
+  }
+
+  // Moves the upper half of a full leaf to a new leaf linked after it and
+  // adds the new leaf to the parent, splitting full ancestors on the way up.
+  // Every node the split needs is created before the tree is changed, so a
+  // failed allocation leaves the tree as it was.
+  Leaf* split_leaf(Leaf* leaf, Inner** path, size_type* slots,
+                   size_type depth) {
+    Inner* spare[kMaxHeight + 1];
+    size_type spares = 0;
+    Leaf* right = leaf_pool_.create();
+    try {
+      size_type full = depth;
+      while (full > 0 && path[full - 1]->count == kInnerSlots) --full;
+      for (size_type i = full; i < depth; ++i)
+        spare[spares++] = inner_pool_.create();
+      if (full == 0) spare[spares++] = inner_pool_.create();
+      key_type separator(leaf->keys[kMinLeafCount]);
+      relocate_elements(right, 0, leaf, kMinLeafCount,
+                        leaf->count - kMinLeafCount);
+      right->count = leaf->count - kMinLeafCount;
+      leaf->count = kMinLeafCount;
+      link_leaf(leaf, right);
+      insert_child(path, slots, depth, std::move(separator), right, spare);
+    } catch (...) {
+      while (spares > 0) inner_pool_.destroy(spare[--spares]);
+      leaf_pool_.destroy(right);
+      throw;
+    }
+    return right;
+  }
+
+  // Adds key and the child right of it to the parent at path[depth - 1],
+  // taking nodes for splits from spare.
+  void insert_child(Inner** path, size_type* slots, size_type depth,
+                    key_type&& key, Node* child, Inner** spare) {
+    if (depth == 0) {
+      Inner* root = *spare;
+      new (&root->keys[0]) key_type(std::move(key));
+      root->children[0] = root_;
+      root->children[1] = child;
+      root->count = 1;
+      root_ = root;
+      return;
+    }
+    Inner* inner = path[depth - 1];
+    size_type pos = slots[depth - 1];
+    if (inner->count == kInnerSlots) {
+      size_type mid = kInnerSlots / 2;
+      Inner* right = *spare++;
+      key_type up(std::move(inner->keys[mid]));
+      inner->keys[mid].~key_type();
+      right->children[0] = inner->children[mid + 1];
+      relocate_children(right, 0, inner, mid + 1, kInnerSlots - mid - 1);
+      right->count = kInnerSlots - mid - 1;
+      inner->count = mid;
+      if (pos > mid) {
+        inner = right;
+        pos -= mid + 1;
+      }
+      insert_into_inner(inner, pos, std::move(key), child);
+      insert_child(path, slots, depth - 1, std::move(up), right, spare);
+    } else {
+      insert_into_inner(inner, pos, std::move(key), child);
+    }
+  }
+
+  static void insert_into_inner(Inner* inner, size_type pos, key_type&& key,
+                                Node* child) {
+    relocate_children(inner, pos + 1, inner, pos, inner->count - pos);
+    new (&inner->keys[pos]) key_type(std::move(key));
+    inner->children[pos + 1] = child;
+    ++inner->count;
+  }
+
+  // Removes keys[pos] and children[pos + 1] from inner.
+  static void erase_from_inner(Inner* inner, size_type pos) {
+    inner->keys[pos].~key_type();
+    relocate_children(inner, pos, inner, pos + 1, inner->count - pos - 1);
+    --inner->count;
+  }
+
+  // Refills a leaf below the minimum from a sibling, or merges it with one.
+  // Returns true if the parent lost a child.
+  bool rebalance_leaf(Leaf* leaf, Inner* parent, size_type i) {
+    if (i > 0) {
+      Leaf* left = static_cast<Leaf*>(parent->children[i - 1]);
+      if (left->count > kMinLeafCount) {
+        relocate_elements(leaf, 1, leaf, 0, leaf->count);
+        relocate_elements(leaf, 0, left, left->count - 1, 1);
+        --left->count;
+        ++leaf->count;
+        parent->keys[i - 1] = leaf->keys[0];
+        return false;
+      }
+      merge_leaves(left, leaf, parent, i - 1);
+      return true;
+    }
+    Leaf* right = static_cast<Leaf*>(parent->children[i + 1]);
+    if (right->count > kMinLeafCount) {
+      relocate_elements(leaf, leaf->count, right, 0, 1);
+      relocate_elements(right, 0, right, 1, right->count - 1);
+      --right->count;
+      ++leaf->count;
+      parent->keys[i] = right->keys[0];
+      return false;
+    }
+    merge_leaves(leaf, right, parent, i);
+    return true;
+  }
+
+  void merge_leaves(Leaf* left, Leaf* right, Inner* parent, size_type pos) {
+    relocate_elements(left, left->count, right, 0, right->count);
+    left->count += right->count;
+    unlink_leaf(right);
+    leaf_pool_.destroy(right);
+    erase_from_inner(parent, pos);
+  }
+
+  // Refills an inner node below the minimum by rotating a key through the
+  // parent, or merges it with a sibling. Returns true if the parent lost a
+  // child.
+  bool rebalance_inner(Inner* inner, Inner* parent, size_type i) {
+    if (i > 0) {
+      Inner* left = static_cast<Inner*>(parent->children[i - 1]);
+      if (left->count > kMinInnerCount) {
+        relocate_children(inner, 1, inner, 0, inner->count);
+        inner->children[1] = inner->children[0];
+        new (&inner->keys[0]) key_type(std::move(parent->keys[i - 1]));
+        inner->children[0] = left->children[left->count];
+        parent->keys[i - 1] = std::move(left->keys[left->count - 1]);
+        left->keys[left->count - 1].~key_type();
+        --left->count;
+        ++inner->count;
+        return false;
+      }
+      merge_inners(left, inner, parent, i - 1);
+      return true;
+    }
+    Inner* right = static_cast<Inner*>(parent->children[i + 1]);
+    if (right->count > kMinInnerCount) {
+      new (&inner->keys[inner->count]) key_type(std::move(parent->keys[i]));
+      inner->children[inner->count + 1] = right->children[0];
+      parent->keys[i] = std::move(right->keys[0]);
+      right->keys[0].~key_type();
+      right->children[0] = right->children[1];
+      relocate_children(right, 0, right, 1, right->count - 1);
+      --right->count;
+      ++inner->count;
+      return false;
+    }
+    merge_inners(inner, right, parent, i);
+    return true;
+  }
+
+  void merge_inners(Inner* left, Inner* right, Inner* parent, size_type pos) {
+    new (&left->keys[left->count]) key_type(std::move(parent->keys[pos]));
+    left->children[left->count + 1] = right->children[0];
+    relocate_children(left, left->count + 1, right, 0, right->count);
+    left->count += right->count + 1;
+    inner_pool_.destroy(right);
+    erase_from_inner(parent, pos);
+  }
+};
+}  // namespace containers
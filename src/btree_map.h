@@ -0,0 +1,117 @@
+#pragma once
+
+#include <stdexcept>
+
+#include "btree.h"
+#include "vector.h"
+
+namespace containers {
+// Ordered map with the interface of map, backed by a B+tree. Dereferencing
+// an iterator yields a std::pair of references to the key and the mapped
+// value, because the two are stored in separate arrays.
+template <class Key, class T, class Compare = std::less<Key>,
+          class Allocator = std::allocator<std::pair<const Key, T>>>
+class btree_map : public containers::BTree<Key, T, Compare, Allocator> {
+ public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<const key_type, mapped_type>;
+  using size_type = size_t;
+  using key_compare = Compare;
+  using allocator_type = Allocator;
+  using tree = containers::BTree<Key, T, Compare, Allocator>;
+  using reference = typename tree::reference;
+
+  using iterator = typename tree::iterator;
+  using const_iterator = typename tree::const_iterator;
+
+  btree_map() : tree::BTree() {}
+  explicit btree_map(const Allocator& alloc) : tree::BTree(alloc) {}
+  explicit btree_map(const Compare& comp, const Allocator& alloc = Allocator())
+      : tree::BTree(comp, alloc) {}
+  explicit btree_map(std::initializer_list<value_type> const& items,
+                     const Allocator& alloc = Allocator())
+      : tree::BTree(alloc) {
+    for (const value_type& item : items) insert(item);
+  }
+  btree_map(const btree_map& m) : tree::BTree(m) {}
+  btree_map(btree_map&& m) : tree::BTree(std::move(m)) {}
+  ~btree_map() {}
+
+  btree_map& operator=(btree_map&& m) {
+    tree::operator=(std::move(m));
+    return *this;
+  }
+
+  T& at(const Key& key) { return at_key(key); }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  T& at(const K& key) {
+    return at_key(key);
+  }
+
+  T& operator[](const Key& key) {
+    return std::get<1>(*std::get<0>(this->insert_unique(key)));
+  }
+
+  std::pair<iterator, bool> insert(const value_type& value) {
+    return this->insert_unique(std::get<0>(value), std::get<1>(value));
+  }
+
+  std::pair<iterator, bool> insert(const Key& key, const T& obj) {
+    return this->insert_unique(key, obj);
+  }
+
+  std::pair<iterator, bool> insert_or_assign(const Key& key, const T& obj) {
+    std::pair<iterator, bool> res = this->insert_unique(key, obj);
+    if (!std::get<1>(res)) std::get<1>(*std::get<0>(res)) = obj;
+    return res;
+  }
+
+  void merge(btree_map& other) {
+    if (this->empty())
+      this->swap(other);
+    else
+      this->merge_unique(other);
+  }
+
+  // Builds the element from args and moves its key and mapped value into
+  // their slots, as keys and values are stored apart. try_emplace constructs
+  // the mapped value in its slot when the key is at hand.
+  template <class... Args>
+  std::pair<iterator, bool> emplace(Args&&... args) {
+    std::pair<Key, T> value(std::forward<Args>(args)...);
+    return this->insert_unique(std::move(value.first),
+                               std::move(value.second));
+  }
+
+  // Constructs the mapped value from args in its slot if key is not present,
+  // and leaves args untouched otherwise.
+  template <class... Args>
+  std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+    return this->insert_unique(key, std::forward<Args>(args)...);
+  }
+
+  template <class... Args>
+  std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args) {
+    return this->insert_unique(std::move(key), std::forward<Args>(args)...);
+  }
+
+  // Inserts every argument in turn.
+  template <class... Args>
+  containers::vector<std::pair<iterator, bool>> insert_many(Args&&... args) {
+    containers::vector<std::pair<iterator, bool>> v;
+    (v.push_back(insert(std::forward<Args>(args))), ...);
+    return v;
+  }
+
+ private:
+  template <class K>
+  T& at_key(const K& key) {
+    iterator i = this->find(key);
+    if (i == this->end())
+      throw std::out_of_range("There's no obj in map with such key");
+    return std::get<1>(*i);
+  }
+};
+}  // namespace containers
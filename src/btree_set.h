@@ -0,0 +1,66 @@
+#pragma once
+
+#include "btree.h"
+#include "vector.h"
+
+namespace containers {
+template <class Key, class Compare = std::less<Key>,
+          class Allocator = std::allocator<Key>>
+class btree_set : public containers::BTree<Key, void, Compare, Allocator> {
+ public:
+  using key_type = Key;
+  using value_type = Key;
+  using size_type = size_t;
+  using key_compare = Compare;
+  using allocator_type = Allocator;
+  using tree = containers::BTree<Key, void, Compare, Allocator>;
+
+  using iterator = typename tree::iterator;
+  using const_iterator = typename tree::const_iterator;
+
+  btree_set() : tree::BTree() {}
+  explicit btree_set(const Allocator& alloc) : tree::BTree(alloc) {}
+  explicit btree_set(const Compare& comp, const Allocator& alloc = Allocator())
+      : tree::BTree(comp, alloc) {}
+  explicit btree_set(std::initializer_list<value_type> const& items,
+                     const Allocator& alloc = Allocator())
+      : tree::BTree(alloc) {
+    for (const value_type& item : items) insert(item);
+  }
+  btree_set(const btree_set& s) : tree::BTree(s) {}
+  btree_set(btree_set&& s) : tree::BTree(std::move(s)) {}
+  ~btree_set() {}
+
+  btree_set& operator=(btree_set&& s) {
+    tree::operator=(std::move(s));
+    return *this;
+  }
+
+  std::pair<iterator, bool> insert(const value_type& value) {
+    return this->insert_unique(value);
+  }
+
+  void merge(btree_set& other) {
+    if (this->empty())
+      this->swap(other);
+    else
+      this->merge_unique(other);
+  }
+
+  // Builds the key from args and moves it into its slot unless it is
+  // present.
+  template <class... Args>
+  std::pair<iterator, bool> emplace(Args&&... args) {
+    value_type value(std::forward<Args>(args)...);
+    return this->insert_unique(std::move(value));
+  }
+
+  // Inserts every argument in turn.
+  template <class... Args>
+  containers::vector<std::pair<iterator, bool>> insert_many(Args&&... args) {
+    containers::vector<std::pair<iterator, bool>> v;
+    (v.push_back(insert(std::forward<Args>(args))), ...);
+    return v;
+  }
+};
+}  // namespace containers
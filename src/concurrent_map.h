@@ -0,0 +1,182 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <utility>
+
+#include "map.h"
+
+namespace containers {
+// Map safe to use from many threads at once. Keys are spread by hash over a
+// fixed number of shards, each an ordered map behind its own reader-writer
+// lock, so operations on different shards never wait for each other and
+// lookups in the same shard run side by side. Values are handed out as
+// copies or through callbacks run under the lock of their shard, never by
+// reference. Callbacks must not call back into the map.
+template <class Key, class T, class Hash = std::hash<Key>,
+          class Compare = std::less<Key>,
+          class Allocator = std::allocator<std::pair<const Key, T>>>
+class concurrent_map {
+ public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<const key_type, mapped_type>;
+  using size_type = size_t;
+  using hasher = Hash;
+  using key_compare = Compare;
+  using allocator_type = Allocator;
+
+  // The number of shards is rounded up to a power of two.
+  explicit concurrent_map(size_type shards = default_shards(),
+                          const Hash& hash = Hash(),
+                          const Compare& comp = Compare(),
+                          const Allocator& alloc = Allocator())
+      : hash_(hash), mask_(round_up(shards) - 1) {
+    shards_.reset(new Shard[mask_ + 1]);
+    for (size_type i = 0; i <= mask_; ++i)
+      shards_[i].map = shard_map(comp, alloc);
+  }
+  concurrent_map(const concurrent_map&) = delete;
+  concurrent_map& operator=(const concurrent_map&) = delete;
+  ~concurrent_map() {}
+
+  // Four shards per hardware thread keep two threads on the same shard
+  // unlikely.
+  static size_type default_shards() {
+    return 4 * ThreadPool::default_threads();
+  }
+
+  size_type shard_count() const { return mask_ + 1; }
+
+  // Sums the sizes of the shards, which may change while it runs.
+  size_type size() const {
+    size_type n = 0;
+    for (size_type i = 0; i <= mask_; ++i) {
+      std::shared_lock<std::shared_mutex> lock(shards_[i].mutex);
+      n += shards_[i].map.size();
+    }
+    return n;
+  }
+
+  bool empty() const { return size() == 0; }
+
+  void clear() {
+    for (size_type i = 0; i <= mask_; ++i) {
+      std::unique_lock<std::shared_mutex> lock(shards_[i].mutex);
+      shards_[i].map.clear();
+    }
+  }
+
+  // Returns a copy of the value mapped to key, if there is one.
+  std::optional<T> find(const Key& key) const {
+    const Shard& shard = shard_of(key);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    typename shard_map::iterator i = shard.map.find(key);
+    if (i == shard.map.end()) return std::nullopt;
+    return std::get<1>(*i);
+  }
+
+  bool contains(const Key& key) const {
+    const Shard& shard = shard_of(key);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    return shard.map.contains(key);
+  }
+
+  // Inserts obj unless key is present. Returns whether it was inserted.
+  template <class M>
+  bool insert(const Key& key, M&& obj) {
+    Shard& shard = shard_of(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    return std::get<1>(shard.map.try_emplace(key, std::forward<M>(obj)));
+  }
+
+  // Returns whether key was inserted rather than assigned.
+  template <class M>
+  bool insert_or_assign(const Key& key, M&& obj) {
+    Shard& shard = shard_of(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    return std::get<1>(shard.map.insert_or_assign(key, std::forward<M>(obj)));
+  }
+
+  // Returns the number of elements erased, 0 or 1.
+  size_type erase(const Key& key) {
+    Shard& shard = shard_of(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    typename shard_map::iterator i = shard.map.find(key);
+    if (i == shard.map.end()) return 0;
+    shard.map.erase(i);
+    return 1;
+  }
+
+  // Calls f with the value mapped to key, if there is one, while no other
+  // thread can read or write it, and returns whether key was present.
+  template <class F>
+  bool compute(const Key& key, F f) {
+    Shard& shard = shard_of(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    typename shard_map::iterator i = shard.map.find(key);
+    if (i == shard.map.end()) return false;
+    f(std::get<1>(*i));
+    return true;
+  }
+
+  // Inserts obj if key is not present, and otherwise calls f with the
+  // value mapped to key, atomically. Returns whether obj was inserted.
+  template <class M, class F>
+  bool upsert(const Key& key, M&& obj, F f) {
+    Shard& shard = shard_of(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    std::pair<typename shard_map::iterator, bool> res =
+        shard.map.try_emplace(key, std::forward<M>(obj));
+    if (!std::get<1>(res)) f(std::get<1>(*std::get<0>(res)));
+    return std::get<1>(res);
+  }
+
+  // Calls f with every element, one shard at a time under its read lock.
+  // Each shard is seen in a consistent state and in key order, but writes to
+  // shards not visited yet can show up while it runs.
+  template <class F>
+  void for_each(F f) const {
+    for (size_type i = 0; i <= mask_; ++i) {
+      std::shared_lock<std::shared_mutex> lock(shards_[i].mutex);
+      for (typename shard_map::iterator j = shards_[i].map.begin();
+           j != shards_[i].map.end(); ++j)
+        f(static_cast<const value_type&>(*j));
+    }
+  }
+
+ private:
+  using shard_map = containers::map<Key, T, Compare, Allocator>;
+
+  // Aligned to a cache line so the locks of neighboring shards are not
+  // written from the same line.
+  struct alignas(64) Shard {
+    mutable std::shared_mutex mutex;
+    shard_map map;
+  };
+
+  Hash hash_;
+  size_type mask_;
+  std::unique_ptr<Shard[]> shards_;
+
+  static size_type round_up(size_type n) {
+    size_type shards = 1;
+    while (shards < n) shards *= 2;
+    return shards;
+  }
+
+  // Mixes the bits of the hash, as std::hash of an integer is the integer
+  // itself and consecutive keys have to land on different shards.
+  Shard& shard_of(const Key& key) const {
+    uint64_t h = hash_(key);
+    h ^= h >> 32;
+    h *= 0xd6e8feb86659fd93ULL;
+    h ^= h >> 32;
+    return shards_[static_cast<size_type>(h) & mask_];
+  }
+};
+}  // namespace containers
@@ -1,10 +1,24 @@
 #pragma once
 
+#include "aggregate_map.h"
 #include "array.h"
+#include "btree_map.h"
+#include "btree_set.h"
+#include "concurrent_map.h"
+#include "counted_multiset.h"
+#include "flat_map.h"
+#include "flat_set.h"
+#include "interval_map.h"
 #include "list.h"
 #include "map.h"
+#include "mapped_flat_map.h"
 #include "multiset.h"
+#include "persistent_map.h"
 #include "queue.h"
+#include "serialize.h"
 #include "set.h"
 #include "stack.h"
+#include "thread_pool.h"
+#include "unordered_map.h"
+#include "unordered_set.h"
 #include "vector.h"
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "binary_tree.h"
+
+namespace containers {
+// Multiset that stores every distinct key once, in a BinaryTree node with a
+// repeat count, so memory and tree depth depend on the number of distinct
+// keys d only. Iteration still visits every key as many times as it was
+// inserted. Lookups and count are O(log d), size is O(1), and increment and
+// decrement change the count of the key an iterator points to in O(1),
+// unless it drops to zero and the node is erased.
+template <class Key, class Compare = std::less<Key>,
+          class Allocator = std::allocator<Key>>
+class counted_multiset {
+ public:
+  using key_type = Key;
+  using value_type = Key;
+  using size_type = size_t;
+  using key_compare = Compare;
+  using allocator_type = Allocator;
+
+ private:
+  using entry = std::pair<const Key, size_type>;
+  using tree =
+      containers::BinaryTree<entry, containers::SelectFirst<entry>, Compare,
+                             typename std::allocator_traits<
+                                 Allocator>::template rebind_alloc<entry>>;
+
+ public:
+  // Points to one occurrence of a key: the entry of the key and the index of
+  // the occurrence among its repeats.
+  class iterator {
+    friend class counted_multiset;
+
+   public:
+    iterator() : entry_(), index_(0) {}
+
+    const Key& operator*() const {
+      typename tree::iterator i = entry_;
+      return std::get<0>(*i);
+    }
+
+    // Returns how many times the key pointed to occurs.
+    size_type repeats() const {
+      typename tree::iterator i = entry_;
+      return std::get<1>(*i);
+    }
+
+    iterator& operator++() {
+      if (++index_ == repeats()) {
+        ++entry_;
+        index_ = 0;
+      }
+      return *this;
+    }
+
+    iterator operator++(int) {
+      iterator ret(*this);
+      ++(*this);
+      return ret;
+    }
+
+    iterator& operator--() {
+      if (index_ > 0) {
+        --index_;
+      } else {
+        --entry_;
+        index_ = repeats() - 1;
+      }
+      return *this;
+    }
+
+    iterator operator--(int) {
+      iterator ret(*this);
+      --(*this);
+      return ret;
+    }
+
+    bool operator==(const iterator& i) const {
+      return entry_ == i.entry_ && index_ == i.index_;
+    }
+    bool operator!=(const iterator& i) const { return !(*this == i); }
+
+   private:
+    iterator(typename tree::iterator entry, size_type index)
+        : entry_(entry), index_(index) {}
+
+    typename tree::iterator entry_;
+    size_type index_;
+  };
+
+  using const_iterator = iterator;
+
+  counted_multiset() : counted_multiset(Compare(), Allocator()) {}
+  explicit counted_multiset(const Allocator& alloc)
+      : counted_multiset(Compare(), alloc) {}
+  explicit counted_multiset(const Compare& comp,
+                            const Allocator& alloc = Allocator())
+      : tree_(comp, typename tree::allocator_type(alloc)), size_(0) {}
+  template <class InputIt>
+  counted_multiset(InputIt first, InputIt last,
+                   const Compare& comp = Compare(),
+                   const Allocator& alloc = Allocator())
+      : counted_multiset(comp, alloc) {
+    for (; first != last; ++first) insert(*first);
+  }
+  explicit counted_multiset(std::initializer_list<value_type> const& items,
+                            const Allocator& alloc = Allocator())
+      : counted_multiset(items.begin(), items.end(), Compare(), alloc) {}
+  counted_multiset(const counted_multiset& s)
+      : tree_(s.tree_), size_(s.size_) {}
+  counted_multiset(counted_multiset&& s)
+      : tree_(std::move(s.tree_)), size_(s.size_) {
+    s.size_ = 0;
+  }
+  ~counted_multiset() {}
+
+  counted_multiset& operator=(const counted_multiset& s) {
+    tree_ = s.tree_;
+    size_ = s.size_;
+    return *this;
+  }
+
+  counted_multiset& operator=(counted_multiset&& s) {
+    tree_ = std::move(s.tree_);
+    size_ = s.size_;
+    s.size_ = 0;
+    return *this;
+  }
+
+  allocator_type get_allocator() const {
+    return allocator_type(tree_.get_allocator());
+  }
+
+  key_compare key_comp() const { return tree_.key_comp(); }
+
+  iterator begin() const { return iterator(tree_.begin(), 0); }
+
+  iterator end() const { return iterator(tree_.end(), 0); }
+
+  bool empty() const { return size_ == 0; }
+
+  // Returns the number of elements, counting every repeat.
+  size_type size() const { return size_; }
+
+  // Returns the number of distinct keys, which is the number of nodes.
+  size_type distinct_size() const { return tree_.size(); }
+
+  size_type max_size() const { return tree_.max_size(); }
+
+  void clear() {
+    tree_.clear();
+    size_ = 0;
+  }
+
+  // Adds n occurrences of key and returns an iterator to the first one. If n
+  // is zero nothing is added and the iterator is lower_bound(key).
+  iterator insert(const value_type& key, size_type n = 1) {
+    if (n == 0) return lower_bound(key);
+    std::pair<typename tree::iterator, bool> res = tree_.insert(entry(key, n));
+    if (!std::get<1>(res)) std::get<1>(*std::get<0>(res)) += n;
+    size_ += n;
+    return iterator(std::get<0>(res), 0);
+  }
+
+  // Adds n occurrences of the key pos points to.
+  void increment(iterator pos, size_type n = 1) {
+    std::get<1>(*pos.entry_) += n;
+    size_ += n;
+  }
+
+  // Removes n occurrences of the key pos points to and erases the key if
+  // none are left. Throws std::invalid_argument if it occurs fewer than n
+  // times.
+  void decrement(iterator pos, size_type n = 1) {
+    size_type& repeats = std::get<1>(*pos.entry_);
+    if (repeats < n)
+      throw std::invalid_argument("Key occurs fewer times than removed");
+    repeats -= n;
+    size_ -= n;
+    if (repeats == 0) tree_.erase(pos.entry_);
+  }
+
+  // Removes the occurrence pos points to.
+  void erase(iterator pos) { decrement(pos); }
+
+  // Removes every occurrence of key and returns how many there were.
+  size_type erase(const key_type& key) {
+    typename tree::iterator i = tree_.find(key);
+    if (i == tree_.end()) return 0;
+    size_type n = std::get<1>(*i);
+    size_ -= n;
+    tree_.erase(i);
+    return n;
+  }
+
+  void swap(counted_multiset& other) {
+    tree_.swap(other.tree_);
+    std::swap(size_, other.size_);
+  }
+
+  // Adds every occurrence of every key of other and leaves other empty.
+  void merge(counted_multiset& other) {
+    if (&other == this) return;
+    for (typename tree::iterator i = other.tree_.begin();
+         i != other.tree_.end(); ++i)
+      insert(std::get<0>(*i), std::get<1>(*i));
+    other.clear();
+  }
+
+  iterator find(const key_type& key) const {
+    return iterator(tree_.find(key), 0);
+  }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator find(const K& key) const {
+    return iterator(tree_.find(key), 0);
+  }
+
+  bool contains(const key_type& key) const { return tree_.contains(key); }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  bool contains(const K& key) const {
+    return tree_.contains(key);
+  }
+
+  size_type count(const key_type& key) const { return count_key(key); }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  size_type count(const K& key) const {
+    return count_key(key);
+  }
+
+  iterator lower_bound(const key_type& key) const {
+    return iterator(tree_.lower_bound(key), 0);
+  }
+
+  iterator upper_bound(const key_type& key) const {
+    return iterator(tree_.upper_bound(key), 0);
+  }
+
+  std::pair<iterator, iterator> equal_range(const key_type& key) const {
+    return std::pair<iterator, iterator>{lower_bound(key), upper_bound(key)};
+  }
+
+ private:
+  tree tree_;
+  size_type size_;
+
+  template <class K>
+  size_type count_key(const K& key) const {
+    typename tree::iterator i = tree_.find(key);
+    return i == tree_.end() ? 0 : std::get<1>(*i);
+  }
+};
+}  // namespace containers
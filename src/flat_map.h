@@ -0,0 +1,265 @@
+#pragma once
+
+#include <stdexcept>
+
+#include "flat_set.h"
+
+namespace containers {
+// Map kept as two parallel sorted vectors, one of keys and one of mapped
+// values, so a lookup searches the keys only. Dereferencing an iterator
+// yields a std::pair of references to the key and the mapped value. Building
+// from a range sorts and deduplicates it once, keeping the first value given
+// for every key.
+template <class Key, class T, class Compare = std::less<Key>,
+          class Allocator = std::allocator<std::pair<const Key, T>>>
+class flat_map {
+  using key_allocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<Key>;
+  using mapped_allocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+
+ public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<const key_type, mapped_type>;
+  using reference = std::pair<const key_type&, mapped_type&>;
+  using size_type = size_t;
+  using key_compare = Compare;
+  using allocator_type = Allocator;
+
+  class iterator {
+    friend class flat_map;
+
+   public:
+    iterator() : key_(nullptr), value_(nullptr) {}
+
+    // Keeps the element reference alive for operator->.
+    struct arrow {
+      reference ref;
+      const reference* operator->() const { return &ref; }
+    };
+
+    reference operator*() const { return reference(*key_, *value_); }
+
+    arrow operator->() const { return arrow{**this}; }
+
+    iterator& operator++() {
+      ++key_;
+      ++value_;
+      return *this;
+    }
+
+    iterator operator++(int) {
+      iterator ret(*this);
+      ++(*this);
+      return ret;
+    }
+
+    iterator& operator--() {
+      --key_;
+      --value_;
+      return *this;
+    }
+
+    iterator operator--(int) {
+      iterator ret(*this);
+      --(*this);
+      return ret;
+    }
+
+    bool operator==(const iterator& i) const { return key_ == i.key_; }
+    bool operator!=(const iterator& i) const { return !(*this == i); }
+
+   private:
+    iterator(const key_type* key, mapped_type* value)
+        : key_(key), value_(value) {}
+
+    const key_type* key_;
+    mapped_type* value_;
+  };
+
+  using const_iterator = iterator;
+
+  flat_map() : flat_map(Compare(), Allocator()) {}
+  explicit flat_map(const Allocator& alloc) : flat_map(Compare(), alloc) {}
+  explicit flat_map(const Compare& comp, const Allocator& alloc = Allocator())
+      : keys_(key_allocator(alloc)),
+        values_(mapped_allocator(alloc)),
+        compare_(comp) {}
+  template <class InputIt>
+  flat_map(InputIt first, InputIt last, const Compare& comp = Compare(),
+           const Allocator& alloc = Allocator())
+      : flat_map(comp, alloc) {
+    containers::vector<std::pair<key_type, mapped_type>> items;
+    while (first != last) items.push_back(*first++);
+    sort_unique(items);
+  }
+  explicit flat_map(std::initializer_list<value_type> const& items,
+                    const Allocator& alloc = Allocator())
+      : flat_map(items.begin(), items.end(), Compare(), alloc) {}
+  flat_map(const flat_map& m)
+      : keys_(m.keys_), values_(m.values_), compare_(m.compare_) {}
+  flat_map(flat_map&& m)
+      : keys_(std::move(m.keys_)),
+        values_(std::move(m.values_)),
+        compare_(std::move(m.compare_)) {}
+  ~flat_map() {}
+
+  flat_map& operator=(flat_map&& m) {
+    keys_ = std::move(m.keys_);
+    values_ = std::move(m.values_);
+    compare_ = std::move(m.compare_);
+    return *this;
+  }
+
+  allocator_type get_allocator() const {
+    return allocator_type(keys_.get_allocator());
+  }
+
+  key_compare key_comp() const { return compare_; }
+
+  iterator begin() const { return at_index(0); }
+
+  iterator end() const { return at_index(size()); }
+
+  bool empty() const { return keys_.size() == 0; }
+
+  size_type size() const { return keys_.size(); }
+
+  size_type max_size() { return values_.max_size(); }
+
+  void reserve(size_type n) {
+    keys_.reserve(n);
+    values_.reserve(n);
+  }
+
+  void clear() {
+    keys_.clear();
+    values_.clear();
+  }
+
+  T& at(const Key& key) { return at_key(key); }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  T& at(const K& key) {
+    return at_key(key);
+  }
+
+  T& operator[](const Key& key) {
+    return std::get<1>(*std::get<0>(insert(key, mapped_type())));
+  }
+
+  std::pair<iterator, bool> insert(const value_type& value) {
+    return insert(std::get<0>(value), std::get<1>(value));
+  }
+
+  std::pair<iterator, bool> insert(const Key& key, const T& obj) {
+    size_type i = lower_bound_index(key);
+    if (i < size() && !compare_(key, keys_.data()[i]))
+      return std::pair<iterator, bool>{at_index(i), false};
+    keys_.insert(typename key_vector::iterator(keys_.data() + i), key);
+    values_.insert(typename mapped_vector::iterator(values_.data() + i), obj);
+    return std::pair<iterator, bool>{at_index(i), true};
+  }
+
+  std::pair<iterator, bool> insert_or_assign(const Key& key, const T& obj) {
+    std::pair<iterator, bool> res = insert(key, obj);
+    if (!std::get<1>(res)) std::get<1>(*std::get<0>(res)) = obj;
+    return res;
+  }
+
+  void erase(iterator pos) {
+    size_type i = pos.key_ - keys_.data();
+    keys_.erase(typename key_vector::iterator(keys_.data() + i));
+    values_.erase(typename mapped_vector::iterator(values_.data() + i));
+  }
+
+  void swap(flat_map& other) {
+    keys_.swap(other.keys_);
+    values_.swap(other.values_);
+    std::swap(compare_, other.compare_);
+  }
+
+  iterator find(const key_type& key) const { return find_key(key); }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator find(const K& key) const {
+    return find_key(key);
+  }
+
+  bool contains(const key_type& key) const { return find_key(key) != end(); }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  bool contains(const K& key) const {
+    return find_key(key) != end();
+  }
+
+  size_type count(const key_type& key) const { return contains(key); }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  size_type count(const K& key) const {
+    return contains(key);
+  }
+
+  iterator lower_bound(const key_type& key) const {
+    return at_index(lower_bound_index(key));
+  }
+
+  iterator upper_bound(const key_type& key) const {
+    return at_index(
+        flat_upper_bound(keys_.data(), keys_.size(), key, compare_));
+  }
+
+ private:
+  using key_vector = containers::vector<Key, key_allocator>;
+  using mapped_vector = containers::vector<T, mapped_allocator>;
+
+  key_vector keys_;
+  mapped_vector values_;
+  Compare compare_;
+
+  iterator at_index(size_type i) const {
+    return iterator(keys_.data() + i,
+                    const_cast<mapped_type*>(values_.data()) + i);
+  }
+
+  template <class K>
+  size_type lower_bound_index(const K& key) const {
+    return flat_lower_bound(keys_.data(), keys_.size(), key, compare_);
+  }
+
+  template <class K>
+  iterator find_key(const K& key) const {
+    size_type i = lower_bound_index(key);
+    if (i < size() && !compare_(key, keys_.data()[i])) return at_index(i);
+    return end();
+  }
+
+  template <class K>
+  T& at_key(const K& key) {
+    iterator i = find_key(key);
+    if (i == end())
+      throw std::out_of_range("There's no obj in map with such key");
+    return *i.value_;
+  }
+
+  // Sorts items by key, keeps the first of every run of equivalent keys and
+  // splits them into the key and value vectors.
+  void sort_unique(
+      containers::vector<std::pair<key_type, mapped_type>>& items) {
+    std::pair<key_type, mapped_type>* first = items.data();
+    std::pair<key_type, mapped_type>* last = first + items.size();
+    std::stable_sort(first, last,
+                     [this](const std::pair<key_type, mapped_type>& a,
+                            const std::pair<key_type, mapped_type>& b) {
+                       return compare_(a.first, b.first);
+                     });
+    reserve(last - first);
+    for (std::pair<key_type, mapped_type>* i = first; i != last; ++i) {
+      if (i != first && !compare_((i - 1)->first, i->first)) continue;
+      keys_.push_back(i->first);
+      values_.push_back(i->second);
+    }
+  }
+};
+}  // namespace containers
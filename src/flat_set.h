@@ -0,0 +1,176 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <utility>
+
+#include "vector.h"
+
+namespace containers {
+// Returns the index of the first of n sorted keys that is not less than key.
+// The loop halves the range with a conditional move instead of a branch, so
+// its trip count depends on n only and mispredictions are avoided.
+template <class Key, class K, class Compare>
+size_t flat_lower_bound(const Key* keys, size_t n, const K& key, Compare comp) {
+  if (n == 0) return 0;
+  const Key* base = keys;
+  while (n > 1) {
+    size_t half = n / 2;
+    base = comp(base[half], key) ? base + half : base;
+    n -= half;
+  }
+  return base - keys + comp(*base, key);
+}
+
+// Returns the index of the first of n sorted keys that is greater than key.
+template <class Key, class K, class Compare>
+size_t flat_upper_bound(const Key* keys, size_t n, const K& key, Compare comp) {
+  if (n == 0) return 0;
+  const Key* base = keys;
+  while (n > 1) {
+    size_t half = n / 2;
+    base = comp(key, base[half]) ? base : base + half;
+    n -= half;
+  }
+  return base - keys + !comp(key, *base);
+}
+
+// Set kept as a sorted vector of keys. Lookups are binary searches over
+// contiguous memory, inserting and erasing shift the elements after the
+// position, and any change invalidates iterators. Building from a range sorts
+// and deduplicates it once, which is much faster than inserting one by one.
+template <class Key, class Compare = std::less<Key>,
+          class Allocator = std::allocator<Key>>
+class flat_set {
+ public:
+  using key_type = Key;
+  using value_type = Key;
+  using size_type = size_t;
+  using key_compare = Compare;
+  using allocator_type = Allocator;
+  using container = containers::vector<Key, Allocator>;
+
+  using iterator = typename container::const_iterator;
+  using const_iterator = typename container::const_iterator;
+
+  flat_set() : flat_set(Compare(), Allocator()) {}
+  explicit flat_set(const Allocator& alloc) : flat_set(Compare(), alloc) {}
+  explicit flat_set(const Compare& comp, const Allocator& alloc = Allocator())
+      : keys_(alloc), compare_(comp) {}
+  template <class InputIt>
+  flat_set(InputIt first, InputIt last, const Compare& comp = Compare(),
+           const Allocator& alloc = Allocator())
+      : flat_set(comp, alloc) {
+    while (first != last) keys_.push_back(*first++);
+    sort_unique();
+  }
+  explicit flat_set(std::initializer_list<value_type> const& items,
+                    const Allocator& alloc = Allocator())
+      : flat_set(items.begin(), items.end(), Compare(), alloc) {}
+  flat_set(const flat_set& s) : keys_(s.keys_), compare_(s.compare_) {}
+  flat_set(flat_set&& s)
+      : keys_(std::move(s.keys_)), compare_(std::move(s.compare_)) {}
+  ~flat_set() {}
+
+  flat_set& operator=(flat_set&& s) {
+    keys_ = std::move(s.keys_);
+    compare_ = std::move(s.compare_);
+    return *this;
+  }
+
+  allocator_type get_allocator() const { return keys_.get_allocator(); }
+
+  key_compare key_comp() const { return compare_; }
+
+  iterator begin() const { return keys_.cbegin(); }
+
+  iterator end() const { return keys_.cend(); }
+
+  bool empty() const { return keys_.size() == 0; }
+
+  size_type size() const { return keys_.size(); }
+
+  size_type max_size() { return keys_.max_size(); }
+
+  void reserve(size_type n) { keys_.reserve(n); }
+
+  void clear() { keys_.clear(); }
+
+  std::pair<iterator, bool> insert(const value_type& value) {
+    size_type i = lower_bound_index(value);
+    if (i < size() && !compare_(value, keys_.data()[i]))
+      return std::pair<iterator, bool>{at_index(i), false};
+    keys_.insert(typename container::iterator(keys_.data() + i), value);
+    return std::pair<iterator, bool>{at_index(i), true};
+  }
+
+  void erase(iterator pos) { keys_.erase(pos); }
+
+  void swap(flat_set& other) {
+    keys_.swap(other.keys_);
+    std::swap(compare_, other.compare_);
+  }
+
+  iterator find(const key_type& key) const { return find_key(key); }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator find(const K& key) const {
+    return find_key(key);
+  }
+
+  bool contains(const key_type& key) const { return find_key(key) != end(); }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  bool contains(const K& key) const {
+    return find_key(key) != end();
+  }
+
+  size_type count(const key_type& key) const { return contains(key); }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  size_type count(const K& key) const {
+    return contains(key);
+  }
+
+  iterator lower_bound(const key_type& key) const {
+    return at_index(lower_bound_index(key));
+  }
+
+  iterator upper_bound(const key_type& key) const {
+    return at_index(
+        flat_upper_bound(keys_.data(), keys_.size(), key, compare_));
+  }
+
+ private:
+  container keys_;
+  Compare compare_;
+
+  iterator at_index(size_type i) const {
+    return iterator(const_cast<Key*>(keys_.data()) + i);
+  }
+
+  template <class K>
+  size_type lower_bound_index(const K& key) const {
+    return flat_lower_bound(keys_.data(), keys_.size(), key, compare_);
+  }
+
+  template <class K>
+  iterator find_key(const K& key) const {
+    size_type i = lower_bound_index(key);
+    if (i < size() && !compare_(key, keys_.data()[i])) return at_index(i);
+    return end();
+  }
+
+  // Sorts the keys and keeps the first of every run of equivalent ones.
+  void sort_unique() {
+    Key* first = keys_.data();
+    Key* last = first + keys_.size();
+    std::stable_sort(first, last, compare_);
+    Key* end = std::unique(first, last, [this](const Key& a, const Key& b) {
+      return !compare_(a, b);
+    });
+    for (size_type n = last - end; n > 0; --n) keys_.pop_back();
+  }
+};
+}  // namespace containers
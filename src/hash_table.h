@@ -0,0 +1,544 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "key_of_value.h"
+
+namespace containers {
+// Open addressing hash table for unordered_set and unordered_map, laid out
+// as a Swiss table. Every slot has a control byte that is either empty,
+// deleted, or holds 7 bits of the hash of the element in the slot. A probe
+// loads a group of control bytes at once and matches all of them against
+// the hash bits in a few instructions, so keys are compared only for slots
+// that are very likely to hold them. Groups are 16 bytes wide with SSE2 and
+// 8 bytes wide otherwise.
+//
+// Capacity is a power of two minus one. The control bytes end with a
+// sentinel and a copy of the first group, so a group can be loaded at any
+// slot without wrapping around. Inserting may rehash, which invalidates all
+// iterators; erasing invalidates only iterators to the erased element.
+template <class T, class KeyOfValue, class Hash, class KeyEqual,
+          class Allocator>
+class HashTable {
+  using ctrl_t = signed char;
+
+  static constexpr ctrl_t kEmpty = -128;
+  static constexpr ctrl_t kDeleted = -2;
+  static constexpr ctrl_t kSentinel = -1;
+
+  // Bits set by matching a group, kShift + 1 bits per slot.
+  template <size_t kWidth, int kShift>
+  class BitMask {
+   public:
+    explicit BitMask(uint64_t mask) : mask_(mask) {}
+
+    explicit operator bool() const { return mask_ != 0; }
+
+    size_t lowest() const { return __builtin_ctzll(mask_) >> kShift; }
+
+    // Number of unset slots before the highest set one.
+    size_t leading_zeros() const {
+      return (__builtin_clzll(mask_) - (64 - (kWidth << kShift))) >> kShift;
+    }
+
+    void remove_lowest() { mask_ &= mask_ - 1; }
+
+   private:
+    uint64_t mask_;
+  };
+
+#ifdef __SSE2__
+  struct Group {
+    static constexpr size_t kWidth = 16;
+    using Mask = BitMask<kWidth, 0>;
+
+    explicit Group(const ctrl_t* pos)
+        : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos))) {}
+
+    Mask match(ctrl_t h2) const {
+      return Mask(static_cast<uint16_t>(
+          _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl))));
+    }
+
+    Mask match_empty() const { return match(kEmpty); }
+
+    Mask match_empty_or_deleted() const {
+      return Mask(static_cast<uint16_t>(
+          _mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(kSentinel), ctrl))));
+    }
+
+    Mask match_full_or_sentinel() const {
+      return Mask(static_cast<uint16_t>(
+          _mm_movemask_epi8(_mm_cmpgt_epi8(ctrl, _mm_set1_epi8(kDeleted)))));
+    }
+
+    __m128i ctrl;
+  };
+#else
+  // Matches eight control bytes held in a word. match() may report a full
+  // slot next to a real match, which the key comparison then rejects.
+  struct Group {
+    static constexpr size_t kWidth = 8;
+    using Mask = BitMask<kWidth, 3>;
+
+    static constexpr uint64_t kLsbs = 0x0101010101010101ULL;
+    static constexpr uint64_t kMsbs = 0x8080808080808080ULL;
+
+    explicit Group(const ctrl_t* pos) { std::memcpy(&ctrl, pos, kWidth); }
+
+    Mask match(ctrl_t h2) const {
+      uint64_t x = ctrl ^ (kLsbs * static_cast<unsigned char>(h2));
+      return Mask((x - kLsbs) & ~x & kMsbs);
+    }
+
+    Mask match_empty() const { return Mask(ctrl & (~ctrl << 6) & kMsbs); }
+
+    Mask match_empty_or_deleted() const {
+      return Mask(ctrl & (~ctrl << 7) & kMsbs);
+    }
+
+    Mask match_full_or_sentinel() const {
+      return Mask(~(ctrl & (~ctrl << 7)) & kMsbs);
+    }
+
+    uint64_t ctrl;
+  };
+#endif
+
+  static constexpr size_t kWidth = Group::kWidth;
+  static constexpr size_t kMinCapacity = 15;
+
+ public:
+  using key_type = typename KeyOfValue::key_type;
+  using value_type = T;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using size_type = size_t;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using allocator_type = Allocator;
+
+  class iterator {
+    friend class HashTable;
+
+   public:
+    iterator() : ctrl_(nullptr), slot_(nullptr) {}
+
+    reference operator*() const { return *slot_; }
+
+    value_type* operator->() const { return slot_; }
+
+    iterator& operator++() {
+      ++ctrl_;
+      ++slot_;
+      skip_empty_or_deleted();
+      return *this;
+    }
+
+    iterator operator++(int) {
+      iterator ret(*this);
+      ++(*this);
+      return ret;
+    }
+
+    bool operator==(const iterator& i) const { return ctrl_ == i.ctrl_; }
+    bool operator!=(const iterator& i) const { return !(*this == i); }
+
+   private:
+    iterator(ctrl_t* ctrl, value_type* slot) : ctrl_(ctrl), slot_(slot) {}
+
+    void skip_empty_or_deleted() {
+      while (*ctrl_ < kSentinel) {
+        typename Group::Mask m = Group(ctrl_).match_full_or_sentinel();
+        size_t shift = m ? m.lowest() : kWidth;
+        ctrl_ += shift;
+        slot_ += shift;
+      }
+    }
+
+    ctrl_t* ctrl_;
+    value_type* slot_;
+  };
+
+  using const_iterator = iterator;
+
+  HashTable() : HashTable(0) {}
+  explicit HashTable(size_type bucket_count, const Hash& hash = Hash(),
+                     const KeyEqual& equal = KeyEqual(),
+                     const Allocator& alloc = Allocator())
+      : ctrl_(empty_group()),
+        slots_(nullptr),
+        capacity_(0),
+        size_(0),
+        growth_left_(0),
+        max_load_factor_(kDefaultMaxLoadFactor),
+        hash_(hash),
+        equal_(equal),
+        allocator_(alloc) {
+    if (bucket_count) rehash(bucket_count);
+  }
+  explicit HashTable(const Allocator& alloc)
+      : HashTable(0, Hash(), KeyEqual(), alloc) {}
+  HashTable(const HashTable& t)
+      : HashTable(0, t.hash_, t.equal_,
+                  std::allocator_traits<Allocator>::
+                      select_on_container_copy_construction(t.allocator_)) {
+    max_load_factor_ = t.max_load_factor_;
+    reserve(t.size_);
+    for (iterator i = t.begin(); i != t.end(); ++i)
+      insert_unique(KeyOfValue()(*i), *i);
+  }
+  HashTable(HashTable&& t) : HashTable(0, t.hash_, t.equal_, t.allocator_) {
+    swap(t);
+  }
+  ~HashTable() { destroy(); }
+  HashTable& operator=(HashTable&& t) {
+    if (&t == this) return *this;
+    destroy();
+    ctrl_ = empty_group();
+    slots_ = nullptr;
+    capacity_ = size_ = growth_left_ = 0;
+    swap(t);
+    return *this;
+  }
+
+  allocator_type get_allocator() const { return allocator_; }
+
+  hasher hash_function() const { return hash_; }
+
+  key_equal key_eq() const { return equal_; }
+
+  iterator begin() const {
+    iterator i(ctrl_, slots_);
+    i.skip_empty_or_deleted();
+    return i;
+  }
+
+  iterator end() const { return iterator(ctrl_ + capacity_, nullptr); }
+
+  bool empty() const { return size_ == 0; }
+
+  size_type size() const { return size_; }
+
+  size_type max_size() const {
+    return std::numeric_limits<intmax_t>::max() /
+           (sizeof(value_type) + sizeof(ctrl_t));
+  }
+
+  size_type bucket_count() const { return capacity_; }
+
+  float load_factor() const {
+    return capacity_ ? static_cast<float>(size_) / capacity_ : 0.0f;
+  }
+
+  float max_load_factor() const { return max_load_factor_; }
+
+  // Sets the highest ratio of elements to slots before the table grows. One
+  // slot is always kept empty, so values of 1 and above mean a full table.
+  void max_load_factor(float ml) {
+    max_load_factor_ = ml > 0.0f ? ml : kDefaultMaxLoadFactor;
+    if (capacity_) resize(std::max(capacity_, capacity_for(size_)));
+  }
+
+  // Makes room for n elements without rehashing.
+  void reserve(size_type n) {
+    if (n > size_ + growth_left_) resize(std::max(capacity_, capacity_for(n)));
+  }
+
+  // Rehashes to at least count slots, and to no fewer than the elements
+  // need under the max load factor.
+  void rehash(size_type count) {
+    resize(std::max(capacity_for(size_), normalize(count)));
+  }
+
+  void clear() {
+    if (capacity_ == 0) return;
+    destroy_elements();
+    reset_ctrl();
+    size_ = 0;
+    growth_left_ = growth_limit(capacity_);
+  }
+
+  void erase(iterator pos) {
+    size_type i = pos.ctrl_ - ctrl_;
+    pos.slot_->~value_type();
+    --size_;
+    // A slot can become empty again if no probe ever passed it, which is
+    // the case if no run of kWidth non-empty slots goes through it.
+    size_type before = (i - kWidth) & capacity_;
+    typename Group::Mask empty_after = Group(ctrl_ + i).match_empty();
+    typename Group::Mask empty_before = Group(ctrl_ + before).match_empty();
+    bool was_never_full =
+        empty_before && empty_after &&
+        empty_after.lowest() + empty_before.leading_zeros() < kWidth;
+    set_ctrl(i, was_never_full ? kEmpty : kDeleted);
+    growth_left_ += was_never_full;
+  }
+
+  size_type erase(const key_type& key) {
+    iterator i = find(key);
+    if (i == end()) return 0;
+    erase(i);
+    return 1;
+  }
+
+  void swap(HashTable& other) {
+    std::swap(ctrl_, other.ctrl_);
+    std::swap(slots_, other.slots_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(size_, other.size_);
+    std::swap(growth_left_, other.growth_left_);
+    std::swap(max_load_factor_, other.max_load_factor_);
+    std::swap(hash_, other.hash_);
+    std::swap(equal_, other.equal_);
+    std::swap(allocator_, other.allocator_);
+  }
+
+  iterator find(const key_type& key) const { return find_key(key); }
+
+  template <class K, class H = Hash, class E = KeyEqual,
+            class = typename H::is_transparent,
+            class = typename E::is_transparent>
+  iterator find(const K& key) const {
+    return find_key(key);
+  }
+
+  bool contains(const key_type& key) const { return find_key(key) != end(); }
+
+  template <class K, class H = Hash, class E = KeyEqual,
+            class = typename H::is_transparent,
+            class = typename E::is_transparent>
+  bool contains(const K& key) const {
+    return find_key(key) != end();
+  }
+
+  size_type count(const key_type& key) const { return contains(key); }
+
+  template <class K, class H = Hash, class E = KeyEqual,
+            class = typename H::is_transparent,
+            class = typename E::is_transparent>
+  size_type count(const K& key) const {
+    return contains(key);
+  }
+
+ protected:
+  // Constructs an element from args unless an element with a key equal to
+  // the given one exists. Nothing is constructed from args in that case.
+  template <class K, class... Args>
+  std::pair<iterator, bool> insert_unique(const K& key, Args&&... args) {
+    size_t hash = hash_key(key);
+    size_type i = find_index(key, hash);
+    if (i != capacity_) return std::pair<iterator, bool>{iterator_at(i), false};
+    i = find_first_non_full(hash);
+    if (growth_left_ == 0 && ctrl_[i] != kDeleted) {
+      resize(next_capacity());
+      i = find_first_non_full(hash);
+    }
+    new (slots_ + i) value_type(std::forward<Args>(args)...);
+    growth_left_ -= ctrl_[i] == kEmpty;
+    set_ctrl(i, h2(hash));
+    ++size_;
+    return std::pair<iterator, bool>{iterator_at(i), true};
+  }
+
+ private:
+  using ctrl_allocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<ctrl_t>;
+  using slot_allocator = typename std::allocator_traits<
+      Allocator>::template rebind_alloc<value_type>;
+
+  static constexpr float kDefaultMaxLoadFactor = 0.875f;
+
+  // Visits groups at triangular offsets, which covers every group of a
+  // table whose capacity is a power of two minus one.
+  class ProbeSeq {
+   public:
+    ProbeSeq(size_t hash, size_t mask)
+        : offset_(hash & mask), index_(0), mask_(mask) {}
+
+    size_t offset() const { return offset_; }
+    size_t offset(size_t i) const { return (offset_ + i) & mask_; }
+
+    void next() {
+      index_ += kWidth;
+      offset_ = (offset_ + index_) & mask_;
+    }
+
+   private:
+    size_t offset_;
+    size_t index_;
+    size_t mask_;
+  };
+
+  ctrl_t* ctrl_;
+  value_type* slots_;
+  size_type capacity_;
+  size_type size_;
+  size_type growth_left_;
+  float max_load_factor_;
+  Hash hash_;
+  KeyEqual equal_;
+  Allocator allocator_;
+
+  // Control bytes of a table without slots. Probes stop at the first group,
+  // and iteration stops at the sentinel.
+  static ctrl_t* empty_group() {
+    alignas(16) static ctrl_t group[16] = {
+        kSentinel, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty,
+        kEmpty,    kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty};
+    return group;
+  }
+
+  // Mixes the bits of the hash, as std::hash of an integer is the integer
+  // itself and both halves of the hash have to vary.
+  template <class K>
+  size_t hash_key(const K& key) const {
+    uint64_t h = hash_(key);
+    h ^= h >> 32;
+    h *= 0xd6e8feb86659fd93ULL;
+    h ^= h >> 32;
+    return static_cast<size_t>(h);
+  }
+
+  static size_t h1(size_t hash) { return hash >> 7; }
+  static ctrl_t h2(size_t hash) { return static_cast<ctrl_t>(hash & 0x7f); }
+
+  iterator iterator_at(size_type i) const {
+    return iterator(ctrl_ + i, slots_ + i);
+  }
+
+  // Sets the control byte of slot i and its copy after the sentinel.
+  void set_ctrl(size_type i, ctrl_t h) {
+    ctrl_[i] = h;
+    ctrl_[((i - (kWidth - 1)) & capacity_) + (kWidth - 1)] = h;
+  }
+
+  template <class K>
+  size_type find_index(const K& key, size_t hash) const {
+    ProbeSeq seq(h1(hash), capacity_);
+    while (true) {
+      Group group(ctrl_ + seq.offset());
+      for (typename Group::Mask m = group.match(h2(hash)); m;
+           m.remove_lowest()) {
+        size_type i = seq.offset(m.lowest());
+        if (equal_(KeyOfValue()(slots_[i]), key)) return i;
+      }
+      if (group.match_empty()) return capacity_;
+      seq.next();
+    }
+  }
+
+  template <class K>
+  iterator find_key(const K& key) const {
+    size_type i = find_index(key, hash_key(key));
+    return i == capacity_ ? end() : iterator_at(i);
+  }
+
+  size_type find_first_non_full(size_t hash) const {
+    ProbeSeq seq(h1(hash), capacity_);
+    while (true) {
+      typename Group::Mask m =
+          Group(ctrl_ + seq.offset()).match_empty_or_deleted();
+      if (m) return seq.offset(m.lowest());
+      seq.next();
+    }
+  }
+
+  size_type growth_limit(size_type capacity) const {
+    size_type limit = static_cast<size_type>(capacity * max_load_factor_);
+    return std::min(limit, capacity - 1);
+  }
+
+  // Rounds up to a power of two minus one, and to no less than the minimum.
+  static size_type normalize(size_type n) {
+    size_type capacity = kMinCapacity;
+    while (capacity < n) capacity = capacity * 2 + 1;
+    return capacity;
+  }
+
+  // Returns the smallest capacity that holds n elements without growing.
+  size_type capacity_for(size_type n) const {
+    size_type capacity = kMinCapacity;
+    while (growth_limit(capacity) < n) capacity = capacity * 2 + 1;
+    return capacity;
+  }
+
+  // Doubles the table, unless deleted slots take up enough of it that
+  // dropping them makes room.
+  size_type next_capacity() const {
+    if (capacity_ == 0) return capacity_for(1);
+    if (size_ * 2 <= growth_limit(capacity_)) return capacity_;
+    return capacity_ * 2 + 1;
+  }
+
+  void reset_ctrl() {
+    std::memset(ctrl_, kEmpty, capacity_ + kWidth);
+    ctrl_[capacity_] = kSentinel;
+  }
+
+  void resize(size_type capacity) {
+    ctrl_allocator ctrl_alloc(allocator_);
+    slot_allocator slot_alloc(allocator_);
+    ctrl_t* old_ctrl = ctrl_;
+    value_type* old_slots = slots_;
+    size_type old_capacity = capacity_;
+    ctrl_t* ctrl = std::allocator_traits<ctrl_allocator>::allocate(
+        ctrl_alloc, capacity + kWidth);
+    try {
+      slots_ = std::allocator_traits<slot_allocator>::allocate(slot_alloc,
+                                                               capacity);
+    } catch (...) {
+      std::allocator_traits<ctrl_allocator>::deallocate(ctrl_alloc, ctrl,
+                                                        capacity + kWidth);
+      throw;
+    }
+    ctrl_ = ctrl;
+    capacity_ = capacity;
+    reset_ctrl();
+    for (size_type i = 0; i < old_capacity; ++i) {
+      if (old_ctrl[i] < 0) continue;
+      size_t hash = hash_key(KeyOfValue()(old_slots[i]));
+      size_type j = find_first_non_full(hash);
+      new (slots_ + j) value_type(std::move(old_slots[i]));
+      old_slots[i].~value_type();
+      set_ctrl(j, h2(hash));
+    }
+    growth_left_ = growth_limit(capacity_) - size_;
+    if (old_capacity) {
+      std::allocator_traits<ctrl_allocator>::deallocate(
+          ctrl_alloc, old_ctrl, old_capacity + kWidth);
+      std::allocator_traits<slot_allocator>::deallocate(slot_alloc, old_slots,
+                                                        old_capacity);
+    }
+  }
+
+  void destroy_elements() {
+    if (std::is_trivially_destructible<value_type>::value) return;
+    for (size_type i = 0; i < capacity_; ++i)
+      if (ctrl_[i] >= 0) slots_[i].~value_type();
+  }
+
+  void destroy() {
+    if (capacity_ == 0) return;
+    destroy_elements();
+    ctrl_allocator ctrl_alloc(allocator_);
+    slot_allocator slot_alloc(allocator_);
+    std::allocator_traits<ctrl_allocator>::deallocate(ctrl_alloc, ctrl_,
+                                                      capacity_ + kWidth);
+    std::allocator_traits<slot_allocator>::deallocate(slot_alloc, slots_,
+                                                      capacity_);
+  }
+};
+}  // namespace containers
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "binary_tree.h"
+#include "vector.h"
+
+namespace containers {
+// Orders intervals by their low end, then by their high end.
+template <class Point, class Compare>
+struct IntervalLess {
+  Compare compare;
+
+  bool operator()(const std::pair<Point, Point>& a,
+                  const std::pair<Point, Point>& b) const {
+    if (compare(a.first, b.first)) return true;
+    if (compare(b.first, a.first)) return false;
+    return compare(a.second, b.second);
+  }
+};
+
+// Keeps the largest high end of the intervals in a subtree.
+template <class Value, class Point, class Compare>
+struct MaxHighEnd {
+  using summary_type = Point;
+
+  void operator()(Point& summary, const Value& value, const Point* left,
+                  const Point* right) const {
+    summary = value.first.second;
+    if (left && Compare()(summary, *left)) summary = *left;
+    if (right && Compare()(summary, *right)) summary = *right;
+  }
+};
+
+// Map from half-open intervals [lo, hi) to values, ordered by lo and then
+// hi, whose tree keeps the largest hi of every subtree in its root. Queries
+// for the intervals overlapping a range or containing a point skip every
+// subtree whose largest hi is not past the query, so they visit O(log n)
+// nodes per interval found instead of scanning. Compare orders the points
+// and is default constructed to compute the summaries.
+template <class Point, class T, class Compare = std::less<Point>,
+          class Allocator =
+              std::allocator<std::pair<const std::pair<Point, Point>, T>>>
+class interval_map
+    : public containers::BinaryTree<
+          std::pair<const std::pair<Point, Point>, T>,
+          containers::SelectFirst<std::pair<const std::pair<Point, Point>, T>>,
+          IntervalLess<Point, Compare>, Allocator,
+          MaxHighEnd<std::pair<const std::pair<Point, Point>, T>, Point,
+                     Compare>> {
+ public:
+  using point_type = Point;
+  using key_type = std::pair<Point, Point>;
+  using mapped_type = T;
+  using value_type = std::pair<const key_type, mapped_type>;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using key_compare = IntervalLess<Point, Compare>;
+  using allocator_type = Allocator;
+  using tree = containers::BinaryTree<
+      value_type, containers::SelectFirst<value_type>, key_compare,
+      Allocator, MaxHighEnd<value_type, Point, Compare>>;
+  using iterator = typename tree::iterator;
+  using const_iterator = typename tree::const_iterator;
+  using size_type = size_t;
+
+  using node = typename tree::Node;
+
+  interval_map() : tree::BinaryTree() {}
+  explicit interval_map(const Allocator& alloc) : tree::BinaryTree(alloc) {}
+  explicit interval_map(std::initializer_list<value_type> const& items,
+                        const Allocator& alloc = Allocator())
+      : tree::BinaryTree(alloc) {
+    for (const value_type& item : items) insert(item);
+  }
+  interval_map(const interval_map& m) : tree::BinaryTree(m) {}
+  interval_map(interval_map&& m) : tree::BinaryTree(std::move(m)) {}
+  ~interval_map() {}
+
+  interval_map& operator=(const interval_map& m) {
+    tree::operator=(m);
+    return *this;
+  }
+
+  interval_map& operator=(interval_map&& m) {
+    tree::operator=(std::move(m));
+    return *this;
+  }
+
+  // Inserts obj for [lo, hi) unless the interval is present. Throws
+  // std::invalid_argument unless lo < hi.
+  std::pair<iterator, bool> insert(const Point& lo, const Point& hi,
+                                   const T& obj) {
+    return insert(value_type(key_type(lo, hi), obj));
+  }
+
+  std::pair<iterator, bool> insert(const value_type& value) {
+    check_interval(std::get<0>(value));
+    return tree::insert(value);
+  }
+
+  // Returns whether [lo, hi) was inserted rather than assigned.
+  std::pair<iterator, bool> insert_or_assign(const Point& lo, const Point& hi,
+                                             const T& obj) {
+    iterator i = find(lo, hi);
+    if (i == this->end()) return insert(lo, hi, obj);
+    std::get<1>(*i) = obj;
+    return std::pair<iterator, bool>{i, false};
+  }
+
+  using tree::erase;
+
+  // Returns the number of intervals erased, 0 or 1.
+  size_type erase(const Point& lo, const Point& hi) {
+    iterator i = find(lo, hi);
+    if (i == this->end()) return 0;
+    tree::erase(i);
+    return 1;
+  }
+
+  iterator find(const Point& lo, const Point& hi) const {
+    return tree::find(key_type(lo, hi));
+  }
+
+  bool contains(const Point& lo, const Point& hi) const {
+    return tree::contains(key_type(lo, hi));
+  }
+
+  T& at(const Point& lo, const Point& hi) {
+    iterator i = find(lo, hi);
+    if (i == this->end())
+      throw std::out_of_range("There's no obj in map with such interval");
+    return std::get<1>(*i);
+  }
+
+  // Appends an iterator to every interval that overlaps [lo, hi) to out, in
+  // key order. An empty range overlaps nothing.
+  template <class A>
+  void overlapping(const Point& lo, const Point& hi,
+                   containers::vector<iterator, A>& out) const {
+    if (!compare_(lo, hi)) return;
+    collect(this->root_node(), lo,
+            [this, &hi](const Point& start) { return compare_(start, hi); },
+            out);
+  }
+
+  // Appends an iterator to every interval that contains point to out, in
+  // key order.
+  template <class A>
+  void stabbing(const Point& point,
+                containers::vector<iterator, A>& out) const {
+    collect(this->root_node(), point,
+            [this, &point](const Point& start) {
+              return !compare_(point, start);
+            },
+            out);
+  }
+
+  // Returns whether any interval overlaps [lo, hi), in one descent. If the
+  // left subtree reaches past lo but overlaps nothing, its interval with the
+  // largest hi starts at or after hi, and so does every interval right of it.
+  bool any_overlap(const Point& lo, const Point& hi) const {
+    if (!compare_(lo, hi)) return false;
+    node* n = this->root_node();
+    while (n && compare_(lo, n->summary)) {
+      const key_type& interval = std::get<0>(n->key);
+      if (compare_(std::get<0>(interval), hi) &&
+          compare_(lo, std::get<1>(interval)))
+        return true;
+      n = n->left && compare_(lo, n->left->summary) ? n->left : n->right;
+    }
+    return false;
+  }
+
+ private:
+  Compare compare_;
+
+  static void check_interval(const key_type& interval) {
+    if (!Compare()(std::get<0>(interval), std::get<1>(interval)))
+      throw std::invalid_argument("Interval has to start before it ends");
+  }
+
+  // Appends the intervals of the subtree that end after lo and start before
+  // the end of the query, in order. Subtrees that end at or before lo are
+  // skipped, and the walk stops at the first interval that starts too late,
+  // as every later one starts no earlier.
+  template <class F, class A>
+  void collect(node* n, const Point& lo, const F& starts_before,
+               containers::vector<iterator, A>& out) const {
+    while (n && compare_(lo, n->summary)) {
+      collect(n->left, lo, starts_before, out);
+      const key_type& interval = std::get<0>(n->key);
+      if (!starts_before(std::get<0>(interval))) return;
+      if (compare_(lo, std::get<1>(interval))) out.push_back(iterator(n));
+      n = n->right;
+    }
+  }
+};
+}  // namespace containers
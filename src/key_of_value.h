@@ -0,0 +1,18 @@
+#pragma once
+
+#include <type_traits>
+
+namespace containers {
+// Key extractors for containers that store keys inside their values.
+template <class T>
+struct Identity {
+  using key_type = T;
+  const key_type& operator()(const T& value) const { return value; }
+};
+
+template <class Pair>
+struct SelectFirst {
+  using key_type = typename std::remove_const<typename Pair::first_type>::type;
+  const key_type& operator()(const Pair& value) const { return value.first; }
+};
+}  // namespace containers
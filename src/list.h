@@ -3,6 +3,10 @@
 #include <cstddef>
 #include <cstdint>
 #include <limits>
+#include <memory>
+#include <type_traits>
+
+#include "node_pool.h"
 
 namespace containers {
 template <class T>
@@ -22,13 +26,14 @@ class node {
   node* next_;
 };
 
-template <class T>
+template <class T, class Allocator = std::allocator<T>>
 class list {
  public:
   using value_type = T;
   using reference = T&;
   using const_reference = const T&;
   using size_type = size_t;
+  using allocator_type = Allocator;
 
   class ListIterator {
     friend class list;
@@ -118,16 +123,23 @@ class list {
 
   using const_iterator = ListConstIterator;
 
-  list() : front_(new node<value_type>()), back_(front_) {}
+  list() : list(Allocator()) {}
+
+  explicit list(const Allocator& alloc)
+      : front_(nullptr), back_(nullptr), pool_(alloc) {
+    front_ = back_ = pool_.create_standalone();
+  }
 
-  explicit list(size_type n) : list() {
+  explicit list(size_type n, const Allocator& alloc = Allocator())
+      : list(alloc) {
     while (n--) {
-      node<value_type>* new_node = new node<value_type>();
-      push_back_node(new_node);
+      push_back_node(pool_.create());
     }
   }
 
-  explicit list(std::initializer_list<value_type> const& items) : list() {
+  explicit list(std::initializer_list<value_type> const& items,
+                const Allocator& alloc = Allocator())
+      : list(alloc) {
     typename std::initializer_list<value_type>::const_iterator i =
         items.begin();
     while (i != items.end()) {
@@ -136,7 +148,9 @@ class list {
     }
   }
 
-  list(const list& l) : list() {
+  list(const list& l)
+      : list(std::allocator_traits<Allocator>::
+                 select_on_container_copy_construction(l.get_allocator())) {
     iterator i = l.begin();
     while (i != l.end()) {
       push_back(*i);
@@ -144,15 +158,12 @@ class list {
     }
   }
 
-  list(list&& l) : front_(nullptr), back_(nullptr) {
-    std::swap(front_, l.front_);
-    std::swap(back_, l.back_);
-  }
+  list(list&& l) : front_(nullptr), back_(nullptr) { swap(l); }
 
   ~list() {
     if (front_ != nullptr) {
       clear();
-      delete front_;
+      pool_.destroy_standalone(front_);
     }
   }
 
@@ -160,14 +171,15 @@ class list {
     if (&l == this) return *this;
     if (front_ != nullptr) {
       clear();
-      delete front_;
+      pool_.destroy_standalone(front_);
     }
     front_ = nullptr, back_ = nullptr;
-    std::swap(front_, l.front_);
-    std::swap(back_, l.back_);
+    swap(l);
     return *this;
   }
 
+  allocator_type get_allocator() const { return pool_.get_allocator(); }
+
   const_reference front() const { return front_->get_value(); }
   const_reference back() const { return back_->get_value(); }
 
@@ -196,8 +208,19 @@ class list {
   }
 
   void clear() {
-    while (!empty()) {
-      pop_front();
+    if (!empty()) {
+      node<value_type>* end_node = back_->get_next();
+      if (!std::is_trivially_destructible<value_type>::value) {
+        node<value_type>* i = front_;
+        while (i != end_node) {
+          node<value_type>* next = i->get_next();
+          pool_.destroy(i);
+          i = next;
+        }
+      }
+      pool_.release();
+      end_node->set_prev(nullptr);
+      front_ = back_ = end_node;
     }
   }
 
@@ -209,7 +232,7 @@ class list {
       push_back(value);
       return iterator(back_);
     } else {
-      node<value_type>* new_node = new node<value_type>(value);
+      node<value_type>* new_node = pool_.create(value);
       node<value_type>* cur = pos.pointer_;
       node<value_type>* prev = cur->get_prev();
       new_node->set_prev(prev);
@@ -231,19 +254,18 @@ class list {
       node<value_type>* next = pointer->get_next();
       prev->set_next(next);
       next->set_prev(prev);
-      delete pointer;
+      pool_.destroy(pointer);
     }
   }
 
   void push_back(const_reference value) {
-    node<value_type>* new_node = new node<value_type>(value);
-    push_back_node(new_node);
+    push_back_node(pool_.create(value));
   }
 
   void pop_back() {
     if (front_ == back_) {
       front_ = front_->get_next();
-      delete back_;
+      pool_.destroy(back_);
       front_->set_prev(nullptr);
       back_ = front_;
     } else {
@@ -251,13 +273,13 @@ class list {
       node<value_type>* next = back_->get_next();
       prev->set_next(next);
       next->set_prev(prev);
-      delete back_;
+      pool_.destroy(back_);
       back_ = prev;
     }
   }
 
   void push_front(const_reference value) {
-    node<value_type>* new_node = new node<value_type>(value);
+    node<value_type>* new_node = pool_.create(value);
     front_->set_prev(new_node);
     new_node->set_next(front_);
     if (empty()) back_ = new_node;
@@ -268,19 +290,26 @@ class list {
     node<value_type>* next = front_->get_next();
     next->set_prev(nullptr);
     if (back_ == front_) back_ = back_->get_next();
-    delete front_;
+    pool_.destroy(front_);
     front_ = next;
   }
 
   void swap(list& other) {
     std::swap(front_, other.front_);
     std::swap(back_, other.back_);
+    pool_.swap(other.pool_);
   }
 
   void merge(list& other) {
     if (empty()) {
       swap(other);
     } else if (this != &other && !(other.empty())) {
+      if (!pool_.splice(other.pool_)) {
+        list moved(get_allocator());
+        moved.move_from(other);
+        merge(moved);
+        return;
+      }
       node<value_type>* current = front_;
       node<value_type>* other_next;
       if (other.front() < front()) {
@@ -323,6 +352,12 @@ class list {
 
   void splice(const_iterator pos, list& other) {
     if (!(other.empty())) {
+      if (!pool_.splice(other.pool_)) {
+        list moved(get_allocator());
+        moved.move_from(other);
+        splice(pos, moved);
+        return;
+      }
       node<value_type>* pos_pointer = pos.pointer_;
       if (pos != begin())
         pos_pointer->get_prev()->set_next(other.front_);
@@ -362,7 +397,7 @@ class list {
         if (cur->get_value() == prev->get_value()) {
           prev->set_next(cur->get_next());
           cur->get_next()->set_prev(prev);
-          delete cur;
+          pool_.destroy(cur);
           cur = prev->get_next();
         } else {
           prev = cur;
@@ -427,6 +462,15 @@ class list {
 
  private:
   node<value_type>*front_, *back_;
+  NodePool<node<value_type>, Allocator> pool_;
+
+  // Moves the elements of a list with an unequal allocator into this one,
+  // whose pool cannot take over the nodes of other.
+  void move_from(list& other) {
+    for (iterator i = other.begin(); i != other.end(); ++i)
+      push_back(*i);
+    other.clear();
+  }
 
   void push_back_node(node<value_type>* node) {
     if (empty()) {
@@ -1,190 +1,246 @@
 #pragma once
 
 #include <stdexcept>
+#include <tuple>
+#include <utility>
 
 #include "binary_tree.h"
 #include "vector.h"
 
 namespace containers {
-template <class Key, class T>
-class map : public containers::BinaryTree<std::pair<const Key, T>> {
+template <class Key, class T, class Compare = std::less<Key>,
+          class Allocator = std::allocator<std::pair<const Key, T>>>
+class map : public containers::BinaryTree<
+                std::pair<const Key, T>,
+                containers::SelectFirst<std::pair<const Key, T>>, Compare,
+                Allocator> {
  public:
   using key_type = Key;
   using mapped_type = T;
   using value_type = std::pair<const key_type, mapped_type>;
   using reference = value_type&;
   using const_reference = const value_type&;
-  using iterator = typename containers::BinaryTree<value_type>::iterator;
-  using const_iterator =
-      typename containers::BinaryTree<value_type>::const_iterator;
+  using key_compare = Compare;
+  using allocator_type = Allocator;
+  using tree =
+      containers::BinaryTree<value_type, containers::SelectFirst<value_type>,
+                             Compare, Allocator>;
+  using iterator = typename tree::iterator;
+  using const_iterator = typename tree::const_iterator;
   using size_type = size_t;
 
   using pair = std::pair<const key_type, mapped_type>;
-  using node = typename containers::BinaryTree<value_type>::Node;
-
-  map() : containers::BinaryTree<value_type>::BinaryTree() {}
-  explicit map(std::initializer_list<value_type> const& items)
-      : containers::BinaryTree<value_type>::BinaryTree() {
-    typename std::initializer_list<value_type>::const_iterator i =
-        items.begin();
-    while (i != items.end()) {
-      if (!(contains(std::get<0>(*i)))) insert(*i);
-      ++i;
-    }
+  using node = typename tree::Node;
+  using node_type = typename tree::node_type;
+  using insert_return_type = typename tree::insert_return_type;
+
+  map() : tree::BinaryTree() {}
+  explicit map(const Allocator& alloc) : tree::BinaryTree(alloc) {}
+  explicit map(const Compare& comp, const Allocator& alloc = Allocator())
+      : tree::BinaryTree(comp, alloc) {}
+  // Input sorted by key is built into a balanced tree in linear time,
+  // unsorted input is inserted one by one. The first value given for a key
+  // is kept.
+  template <class InputIt>
+  map(InputIt first, InputIt last, const Compare& comp = Compare(),
+      const Allocator& alloc = Allocator())
+      : tree::BinaryTree(comp, alloc) {
+    this->assign_range(first, last, true);
   }
-  map(const map& m) : containers::BinaryTree<value_type>::BinaryTree() {
-    iterator i = m.begin();
-    while (i != m.end()) {
-      insert(*i);
-      ++i;
-    }
+  explicit map(std::initializer_list<value_type> const& items,
+               const Allocator& alloc = Allocator())
+      : tree::BinaryTree(alloc) {
+    this->assign_range(items.begin(), items.end(), true);
   }
-  map(map&& m) : containers::BinaryTree<value_type>::BinaryTree(std::move(m)) {}
+  map(const map& m) : tree::BinaryTree(m) {}
+  map(map&& m) : tree::BinaryTree(std::move(m)) {}
   ~map() {}
 
+  map& operator=(const map& m) {
+    tree::operator=(m);
+    return *this;
+  }
+
+  map& operator=(map&& m) {
+    tree::operator=(std::move(m));
+    return *this;
+  }
+
+  // Replaces the contents with [first, last), in linear time if it is sorted.
+  template <class InputIt>
+  void assign_sorted(InputIt first, InputIt last) {
+    this->assign_range(first, last, true);
+  }
+
+  // Replaces the contents with [first, last) in any order, sorting it on the
+  // threads of the pool. The first value given for a key is kept.
+  template <class InputIt>
+  void assign(InputIt first, InputIt last, ThreadPool& threads) {
+    this->assign_range(first, last, true, threads);
+  }
+
   T& at(const Key& key) {
-    node* n = find_node(key);
+    node* n = this->find_node(key);
     if (n == nullptr)
       throw std::out_of_range("There's no obj in map with such key");
     return std::get<1>(n->key);
   }
 
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  T& at(const K& key) {
+    node* n = this->find_node(key);
+    if (n == nullptr)
+      throw std::out_of_range("There's no obj in map with such key");
+    return std::get<1>(n->key);
+  }
+
+  size_type count(const Key& key) const { return this->contains(key); }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  size_type count(const K& key) const {
+    return this->contains(key);
+  }
+
+  // Inserts a value-initialized mapped value if key is not present, with a
+  // single descent.
   T& operator[](const Key& key) {
-    node* n = find_node(key);
-    if (n)
-      return std::get<1>(n->key);
-    else
-      return std::get<1>(*(std::get<0>(insert(key, mapped_type()))));
+    return std::get<1>(*std::get<0>(try_emplace(key)));
+  }
+
+  T& operator[](Key&& key) {
+    return std::get<1>(*std::get<0>(try_emplace(std::move(key))));
   }
 
   std::pair<iterator, bool> insert(const value_type& value) {
-    if (this->empty()) {
-      this->insert_root(value);
-      return std::pair<iterator, bool>{
-          iterator(containers::BinaryTree<value_type>::root), true};
-    }
-    node* parent_node = containers::BinaryTree<value_type>::root;
-    while ((parent_node->left || parent_node->right) ||
-           std::get<0>(parent_node->key) == std::get<0>(value)) {
-      if (std::get<0>(parent_node->key) > std::get<0>(value)) {
-        if (parent_node->left)
-          parent_node = parent_node->left;
-        else
-          break;
-      } else {
-        if (parent_node->right && iterator(parent_node->right) != this->end())
-          parent_node = parent_node->right;
-        else
-          break;
-      }
-    }
-    bool not_equal_keys = std::get<0>(parent_node->key) != std::get<0>(value);
-    return std::pair<iterator, bool>{
-        iterator(insert_node(value, not_equal_keys ? parent_node : nullptr)),
-        not_equal_keys};
+    return tree::insert(value);
+  }
+
+  std::pair<iterator, bool> insert(value_type&& value) {
+    return tree::insert(std::move(value));
+  }
+
+  iterator insert(iterator hint, const value_type& value) {
+    return tree::insert(hint, value);
+  }
+
+  iterator insert(iterator hint, value_type&& value) {
+    return tree::insert(hint, std::move(value));
+  }
+
+  insert_return_type insert(node_type&& nh) {
+    return tree::insert(std::move(nh));
   }
 
   std::pair<iterator, bool> insert(const Key& key, const T& obj) {
-    return insert(pair{key, obj});
+    return try_emplace(key, obj);
   }
 
-  std::pair<iterator, bool> insert_or_assign(const Key& key, const T& obj) {
-    node* n = find_node(key);
-    if (n) {
-      iterator i(n);
-      std::get<1>(*i) = obj;
-      return std::pair<iterator, bool>{i, false};
-    } else {
-      return insert(key, obj);
+  // Constructs the element from args in its node. A node is allocated before
+  // the key is known, so try_emplace is cheaper when the key is at hand.
+  template <class... Args>
+  std::pair<iterator, bool> emplace(Args&&... args) {
+    return this->emplace_unique(std::forward<Args>(args)...);
+  }
+
+  // The same, with the key looked up next to hint first, as by insert.
+  template <class... Args>
+  iterator emplace_hint(iterator hint, Args&&... args) {
+    return this->emplace_hint_unique(hint, std::forward<Args>(args)...);
+  }
+
+  // Constructs the mapped value from args in place if key is not present,
+  // and leaves args untouched otherwise.
+  template <class... Args>
+  std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+    return try_emplace_key(key, std::forward<Args>(args)...);
+  }
+
+  template <class... Args>
+  std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args) {
+    return try_emplace_key(std::move(key), std::forward<Args>(args)...);
+  }
+
+  template <class M>
+  std::pair<iterator, bool> insert_or_assign(const Key& key, M&& obj) {
+    node* parent_node;
+    bool left;
+    node* found = this->find_unique(key, parent_node, left);
+    if (found) {
+      std::get<1>(found->key) = std::forward<M>(obj);
+      return std::pair<iterator, bool>{iterator(found), false};
     }
+    return std::pair<iterator, bool>{
+        iterator(this->insert_node(parent_node, left, key,
+                                   std::forward<M>(obj))),
+        true};
   }
 
   void merge(map& other) {
     if (this->empty()) {
       this->swap(other);
     } else {
-      iterator i = other.begin();
-      while (i != other.end()) {
-        if (!(contains(std::get<0>(*i)))) {
-          merge_node(i++, other);
-        } else {
-          ++i;
-        }
-      }
+      this->merge_unique(other);
     }
   }
 
-  bool contains(const Key& key) const { return find_node(key) != nullptr; }
+  // Replace the contents with the union, intersection or difference of the
+  // keys of this map and other, and leave other empty. Values of this map
+  // win on equal keys. The trees are split and joined, so the cost is
+  // O(m log(n / m + 1)) for sizes m <= n, and the nodes that stay are
+  // relinked rather than copied.
+  void set_union(map& other) { this->set_operation(other, tree::kUnion); }
+
+  void set_intersection(map& other) {
+    this->set_operation(other, tree::kIntersection);
+  }
+
+  void set_difference(map& other) {
+    this->set_operation(other, tree::kDifference);
+  }
+
+  void symmetric_difference(map& other) {
+    this->set_operation(other, tree::kSymmetricDifference);
+  }
+
+  // The same, with the two sides of large splits processed on the threads of
+  // the pool.
+  void set_union(map& other, ThreadPool& threads) {
+    this->set_operation(other, tree::kUnion, &threads);
+  }
 
+  void set_intersection(map& other, ThreadPool& threads) {
+    this->set_operation(other, tree::kIntersection, &threads);
+  }
+
+  void set_difference(map& other, ThreadPool& threads) {
+    this->set_operation(other, tree::kDifference, &threads);
+  }
+
+  void symmetric_difference(map& other, ThreadPool& threads) {
+    this->set_operation(other, tree::kSymmetricDifference, &threads);
+  }
+
+  // Inserts every argument in turn.
   template <class... Args>
-  containers::vector<std::pair<iterator, bool>> emplace(Args&&... args) {
+  containers::vector<std::pair<iterator, bool>> insert_many(Args&&... args) {
     containers::vector<std::pair<iterator, bool>> v;
-    const value_type data[] = {args...};
-    for (const value_type item : data) {
-      v.push_back(insert(item));
-    }
+    (v.push_back(insert(std::forward<Args>(args))), ...);
     return v;
   }
 
  private:
-  node* insert_node(value_type k, node* p) {
-    if (p) {
-      node* n = new node(k, p);
-      if (std::get<0>(k) < std::get<0>(p->key)) {
-        p->left = n;
-      } else {
-        if (p->right) {
-          n->right = p->right;
-          p->right->parent = n;
-        }
-        p->right = n;
-      }
-      return n;
-    }
-    return nullptr;
-  }
-
-  void merge_node(iterator i, map& other) {
-    node* n = other.find_node(std::get<0>(*i));
-    node* p = find_parent(n->key);
-    other.remove_node(n);
-    n->parent = p;
-    n->left = nullptr;
-    n->right = nullptr;
-    if (std::get<0>(n->key) < std::get<0>(p->key)) {
-      p->left = n;
-    } else {
-      if (p->right) {
-        p->right->parent = n;
-        n->right = p->right;
-      }
-      p->right = n;
-    }
-  }
-
-  node* find_node(const Key& key) const {
-    node* n = this->root;
-    while (n && std::get<0>(n->key) != key) {
-      if (key < std::get<0>(n->key)) {
-        n = n->left;
-      } else {
-        n = n->right;
-      }
-    }
-    return n;
-  }
-
-  node* find_parent(value_type key) const {
-    node* p = this->root;
-    while (p->left || (p->right && iterator(p->right) != this->end())) {
-      if (std::get<0>(key) < std::get<0>(p->key) && p->left)
-        p = p->left;
-      else if (std::get<0>(key) > std::get<0>(p->key) && p->right)
-        p = p->right;
-      else
-        break;
-    }
-    return p;
+  template <class K, class... Args>
+  std::pair<iterator, bool> try_emplace_key(K&& key, Args&&... args) {
+    node* parent_node;
+    bool left;
+    node* found = this->find_unique(key, parent_node, left);
+    if (found) return std::pair<iterator, bool>{iterator(found), false};
+    return std::pair<iterator, bool>{
+        iterator(this->insert_node(
+            parent_node, left, std::piecewise_construct,
+            std::forward_as_tuple(std::forward<K>(key)),
+            std::forward_as_tuple(std::forward<Args>(args)...))),
+        true};
   }
 };
 }  // namespace containers
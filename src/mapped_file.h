@@ -0,0 +1,74 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <string>
+#include <system_error>
+#include <utility>
+
+namespace containers {
+// Read-only view of a whole file mapped into memory. The pages are loaded
+// on first touch and shared with every other process that maps the file.
+class MappedFile {
+ public:
+  MappedFile() : data_(nullptr), size_(0) {}
+  explicit MappedFile(const std::string& path) : MappedFile() {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+      throw std::system_error(errno, std::generic_category(), "open " + path);
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      int error = errno;
+      ::close(fd);
+      throw std::system_error(error, std::generic_category(), "stat " + path);
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ > 0) {
+      void* data = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+      if (data == MAP_FAILED) {
+        int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(),
+                                "mmap " + path);
+      }
+      data_ = static_cast<const char*>(data);
+    }
+    ::close(fd);
+  }
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  MappedFile(MappedFile&& f) : MappedFile() { swap(f); }
+  ~MappedFile() {
+    if (data_) ::munmap(const_cast<char*>(data_), size_);
+  }
+
+  MappedFile& operator=(MappedFile&& f) {
+    MappedFile(std::move(f)).swap(*this);
+    return *this;
+  }
+
+  void swap(MappedFile& other) {
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+  }
+
+  const char* data() const { return data_; }
+
+  size_t size() const { return size_; }
+
+  // Tells the kernel the pages will be read from start to end, so it reads
+  // ahead aggressively.
+  void advise_sequential() const {
+    if (data_) ::madvise(const_cast<char*>(data_), size_, MADV_SEQUENTIAL);
+  }
+
+ private:
+  const char* data_;
+  size_t size_;
+};
+}  // namespace containers
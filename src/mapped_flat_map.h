@@ -0,0 +1,303 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "flat_set.h"
+#include "map.h"
+#include "mapped_file.h"
+#include "serialize.h"
+#include "vector.h"
+
+namespace containers {
+// Header of a mapped_flat_map file. The sorted keys start right after it
+// and the mapped values at values_offset, both padded to 64 bytes.
+struct MappedTableHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint32_t key_size;
+  uint32_t key_align;
+  uint32_t mapped_size;
+  uint32_t mapped_align;
+  uint64_t count;
+  uint64_t values_offset;
+  char reserved[16];
+};
+
+static_assert(sizeof(MappedTableHeader) == 64,
+              "mapped table header is 64 bytes");
+
+constexpr char kMappedTableMagic[8] = {'C', 'N', 'T', 'T', 'A', 'B', 'L',
+                                       '\0'};
+constexpr uint32_t kMappedTableVersion = 1;
+
+// Read-only map over a file of sorted keys and mapped values, written by
+// build(). Opening it maps the file and reads the header only: lookups
+// binary search the keys in place, as flat_map does, and iteration walks
+// the mapped pages, so nothing is deserialized and the pages are loaded on
+// first touch and shared by every process that opens the file. Keys and
+// mapped values have to be trivially copyable, and the file is only
+// readable on a machine with the same byte order and layout. The file has
+// to stay unmodified while it is open.
+template <class Key, class T, class Compare = std::less<Key>>
+class mapped_flat_map {
+  static_assert(std::is_trivially_copyable<Key>::value &&
+                    std::is_trivially_copyable<T>::value,
+                "mapped_flat_map holds trivially copyable types only");
+  static_assert(alignof(Key) <= 64 && alignof(T) <= 64,
+                "keys and values are aligned to at most 64 bytes");
+
+ public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<const key_type, mapped_type>;
+  using reference = std::pair<const key_type&, const mapped_type&>;
+  using size_type = size_t;
+  using key_compare = Compare;
+
+  class iterator {
+    friend class mapped_flat_map;
+
+   public:
+    iterator() : key_(nullptr), value_(nullptr) {}
+
+    // Keeps the element reference alive for operator->.
+    struct arrow {
+      reference ref;
+      const reference* operator->() const { return &ref; }
+    };
+
+    reference operator*() const { return reference(*key_, *value_); }
+
+    arrow operator->() const { return arrow{**this}; }
+
+    iterator& operator++() {
+      ++key_;
+      ++value_;
+      return *this;
+    }
+
+    iterator operator++(int) {
+      iterator ret(*this);
+      ++(*this);
+      return ret;
+    }
+
+    iterator& operator--() {
+      --key_;
+      --value_;
+      return *this;
+    }
+
+    iterator operator--(int) {
+      iterator ret(*this);
+      --(*this);
+      return ret;
+    }
+
+    bool operator==(const iterator& i) const { return key_ == i.key_; }
+    bool operator!=(const iterator& i) const { return !(*this == i); }
+
+   private:
+    iterator(const key_type* key, const mapped_type* value)
+        : key_(key), value_(value) {}
+
+    const key_type* key_;
+    const mapped_type* value_;
+  };
+
+  using const_iterator = iterator;
+
+  mapped_flat_map()
+      : keys_(nullptr), values_(nullptr), size_(0), compare_() {}
+  // Maps the file at path and checks its header. Throws std::system_error
+  // if it cannot be mapped and std::runtime_error if it was not built for
+  // these types.
+  explicit mapped_flat_map(const std::string& path,
+                           const Compare& comp = Compare())
+      : file_(path), compare_(comp) {
+    MappedTableHeader header;
+    if (file_.size() < sizeof(header))
+      throw std::runtime_error("Table " + path + " is truncated");
+    std::memcpy(&header, file_.data(), sizeof(header));
+    if (std::memcmp(header.magic, kMappedTableMagic, sizeof(header.magic)) !=
+        0)
+      throw std::runtime_error(path + " is not a mapped table");
+    if (header.version != kMappedTableVersion)
+      throw std::runtime_error("Table " + path +
+                               " has an unsupported version");
+    if (header.byte_order != kSnapshotByteOrder ||
+        header.key_size != sizeof(Key) || header.key_align != alignof(Key) ||
+        header.mapped_size != sizeof(T) || header.mapped_align != alignof(T))
+      throw std::runtime_error("Table " + path +
+                               " holds elements of another layout");
+    uint64_t keys_end = sizeof(header) + header.count * sizeof(Key);
+    if (header.count > file_.size() / sizeof(Key) ||
+        header.values_offset < keys_end || header.values_offset % 64 != 0 ||
+        header.values_offset > file_.size() ||
+        (file_.size() - header.values_offset) / sizeof(T) < header.count)
+      throw std::runtime_error("Table " + path + " is truncated");
+    size_ = static_cast<size_type>(header.count);
+    keys_ = reinterpret_cast<const Key*>(file_.data() + sizeof(header));
+    values_ = reinterpret_cast<const T*>(file_.data() + header.values_offset);
+  }
+  mapped_flat_map(const mapped_flat_map&) = delete;
+  mapped_flat_map& operator=(const mapped_flat_map&) = delete;
+  mapped_flat_map(mapped_flat_map&& m)
+      : file_(std::move(m.file_)),
+        keys_(m.keys_),
+        values_(m.values_),
+        size_(m.size_),
+        compare_(std::move(m.compare_)) {
+    m.keys_ = nullptr;
+    m.values_ = nullptr;
+    m.size_ = 0;
+  }
+  ~mapped_flat_map() {}
+
+  mapped_flat_map& operator=(mapped_flat_map&& m) {
+    mapped_flat_map(std::move(m)).swap(*this);
+    return *this;
+  }
+
+  // Writes a table of the elements of m to path.
+  template <class A>
+  static void build(const map<Key, T, Compare, A>& m,
+                    const std::string& path) {
+    write_table(path, m.size(), m.begin(), m.end());
+  }
+
+  // Writes a table of the elements of items, which have to be sorted by
+  // strictly increasing keys, to path. Throws std::invalid_argument if they
+  // are not.
+  template <class A>
+  static void build(const vector<std::pair<Key, T>, A>& items,
+                    const std::string& path,
+                    const Compare& comp = Compare()) {
+    const std::pair<Key, T>* first = items.data();
+    for (size_type i = 1; i < items.size(); ++i)
+      if (!comp(first[i - 1].first, first[i].first))
+        throw std::invalid_argument("Items are not sorted by unique keys");
+    write_table(path, items.size(), first, first + items.size());
+  }
+
+  void swap(mapped_flat_map& other) {
+    file_.swap(other.file_);
+    std::swap(keys_, other.keys_);
+    std::swap(values_, other.values_);
+    std::swap(size_, other.size_);
+    std::swap(compare_, other.compare_);
+  }
+
+  key_compare key_comp() const { return compare_; }
+
+  iterator begin() const { return at_index(0); }
+
+  iterator end() const { return at_index(size_); }
+
+  bool empty() const { return size_ == 0; }
+
+  size_type size() const { return size_; }
+
+  const T& at(const Key& key) const { return at_key(key); }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  const T& at(const K& key) const {
+    return at_key(key);
+  }
+
+  iterator find(const key_type& key) const { return find_key(key); }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator find(const K& key) const {
+    return find_key(key);
+  }
+
+  bool contains(const key_type& key) const { return find_key(key) != end(); }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  bool contains(const K& key) const {
+    return find_key(key) != end();
+  }
+
+  size_type count(const key_type& key) const { return contains(key); }
+
+  iterator lower_bound(const key_type& key) const {
+    return at_index(flat_lower_bound(keys_, size_, key, compare_));
+  }
+
+  iterator upper_bound(const key_type& key) const {
+    return at_index(flat_upper_bound(keys_, size_, key, compare_));
+  }
+
+  std::pair<iterator, iterator> equal_range(const key_type& key) const {
+    return std::pair<iterator, iterator>{lower_bound(key), upper_bound(key)};
+  }
+
+ private:
+  MappedFile file_;
+  const Key* keys_;
+  const T* values_;
+  size_type size_;
+  Compare compare_;
+
+  static uint64_t padded(uint64_t offset) { return (offset + 63) / 64 * 64; }
+
+  // Writes the header, the keys and the mapped values of count elements of
+  // [first, last), in two passes over the elements.
+  template <class InputIt>
+  static void write_table(const std::string& path, size_type count,
+                          InputIt first, InputIt last) {
+    MappedTableHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMappedTableMagic, sizeof(header.magic));
+    header.version = kMappedTableVersion;
+    header.byte_order = kSnapshotByteOrder;
+    header.key_size = sizeof(Key);
+    header.key_align = alignof(Key);
+    header.mapped_size = sizeof(T);
+    header.mapped_align = alignof(T);
+    header.count = count;
+    header.values_offset = padded(sizeof(header) + count * sizeof(Key));
+    SnapshotWriter writer(path);
+    writer.write(&header, sizeof(header));
+    for (InputIt i = first; i != last; ++i) {
+      const Key& key = std::get<0>(*i);
+      writer.write(&key, sizeof(Key));
+    }
+    const char padding[64] = {};
+    writer.write(padding, header.values_offset - sizeof(header) -
+                              count * sizeof(Key));
+    for (InputIt i = first; i != last; ++i) {
+      const T& value = std::get<1>(*i);
+      writer.write(&value, sizeof(T));
+    }
+    writer.commit();
+  }
+
+  iterator at_index(size_type i) const {
+    return iterator(keys_ + i, values_ + i);
+  }
+
+  template <class K>
+  iterator find_key(const K& key) const {
+    size_type i = flat_lower_bound(keys_, size_, key, compare_);
+    if (i < size_ && !compare_(key, keys_[i])) return at_index(i);
+    return end();
+  }
+
+  template <class K>
+  const T& at_key(const K& key) const {
+    iterator i = find_key(key);
+    if (i == end())
+      throw std::out_of_range("There's no obj in map with such key");
+    return *i.value_;
+  }
+};
+}  // namespace containers
@@ -3,96 +3,169 @@
 #include "binary_tree.h"
 
 namespace containers {
-template <class Key>
-class multiset : public containers::BinaryTree<Key> {
+template <class Key, class Compare = std::less<Key>,
+          class Allocator = std::allocator<Key>>
+class multiset : public containers::BinaryTree<Key, containers::Identity<Key>,
+                                               Compare, Allocator> {
  public:
   using key_type = Key;
   using value_type = Key;
   using size_type = size_t;
+  using key_compare = Compare;
+  using allocator_type = Allocator;
+  using tree =
+      containers::BinaryTree<value_type, containers::Identity<value_type>,
+                             Compare, Allocator>;
 
-  using iterator = typename containers::BinaryTree<key_type>::iterator;
-  using const_iterator =
-      typename containers::BinaryTree<key_type>::const_iterator;
-  using node = typename containers::BinaryTree<value_type>::Node;
-
-  multiset() : containers::BinaryTree<key_type>::BinaryTree() {}
-  explicit multiset(std::initializer_list<value_type> const& items)
-      : containers::BinaryTree<key_type>::BinaryTree() {
-    typename std::initializer_list<value_type>::const_iterator i =
-        items.begin();
-    while (i != items.end()) {
-      insert(*i);
-      ++i;
-    }
+  using iterator = typename tree::iterator;
+  using const_iterator = typename tree::const_iterator;
+  using node = typename tree::Node;
+  using node_type = typename tree::node_type;
+
+  multiset() : tree::BinaryTree() {}
+  explicit multiset(const Allocator& alloc) : tree::BinaryTree(alloc) {}
+  explicit multiset(const Compare& comp, const Allocator& alloc = Allocator())
+      : tree::BinaryTree(comp, alloc) {}
+  // Sorted input is built into a balanced tree in linear time, unsorted input
+  // is inserted one by one. Equivalent keys keep their input order.
+  template <class InputIt>
+  multiset(InputIt first, InputIt last, const Compare& comp = Compare(),
+           const Allocator& alloc = Allocator())
+      : tree::BinaryTree(comp, alloc) {
+    this->assign_range(first, last, false);
   }
-  multiset(const multiset& s) : containers::BinaryTree<value_type>() {
-    iterator i = s.begin();
-    while (i != s.end()) {
-      insert(*i);
-      ++i;
-    }
+  explicit multiset(std::initializer_list<value_type> const& items,
+                    const Allocator& alloc = Allocator())
+      : tree::BinaryTree(alloc) {
+    this->assign_range(items.begin(), items.end(), false);
   }
-  multiset(multiset&& s)
-      : containers::BinaryTree<key_type>::BinaryTree(std::move(s)) {}
+  multiset(const multiset& s) : tree::BinaryTree(s) {}
+  multiset(multiset&& s) : tree::BinaryTree(std::move(s)) {}
   ~multiset() {}
 
+  multiset& operator=(const multiset& s) {
+    tree::operator=(s);
+    return *this;
+  }
+
+  multiset& operator=(multiset&& s) {
+    tree::operator=(std::move(s));
+    return *this;
+  }
+
+  // Replaces the contents with [first, last), in linear time if it is sorted.
+  template <class InputIt>
+  void assign_sorted(InputIt first, InputIt last) {
+    this->assign_range(first, last, false);
+  }
+
+  // Replaces the contents with [first, last) in any order, sorting it on the
+  // threads of the pool. Equivalent keys keep their input order.
+  template <class InputIt>
+  void assign(InputIt first, InputIt last, ThreadPool& threads) {
+    this->assign_range(first, last, false, threads);
+  }
+
   iterator insert(const value_type& value) {
-    if (this->empty()) {
-      this->insert_root(value);
-      return iterator(this->root);
-    }
-    node* parent_node = this->root;
-    while (parent_node->left || parent_node->right) {
-      if (parent_node->key > value) {
-        if (parent_node->left)
-          parent_node = parent_node->left;
-        else
-          break;
-      } else {
-        if (parent_node->right && iterator(parent_node->right) != this->end())
-          parent_node = parent_node->right;
-        else
-          break;
-      }
-    }
-    return iterator(this->insert_node(value, parent_node));
+    return this->insert_equal(value);
+  }
+
+  iterator insert(value_type&& value) {
+    return this->insert_equal(std::move(value));
+  }
+
+  // Inserts value as close to hint as the order allows. A key that belongs
+  // right before or right after hint is placed with at most two comparisons,
+  // so appending keys in order at end() skips the descent.
+  iterator insert(iterator hint, const value_type& value) {
+    return this->emplace_hint_equal(hint, value);
+  }
+
+  iterator insert(iterator hint, value_type&& value) {
+    return this->emplace_hint_equal(hint, std::move(value));
+  }
+
+  iterator insert(node_type&& nh) {
+    return this->insert_equal(std::move(nh));
   }
 
-  void merge(BinaryTree<key_type>& other) {
+  void merge(tree& other) {
     if (this->empty()) {
       this->swap(other);
     } else {
-      iterator i = other.begin();
-      while (i != other.end()) this->merge_node(i++, other);
+      this->merge_equal(other);
     }
   }
 
-  size_type count(const Key& key) {
-    iterator i = this->find(key);
-    size_type n = 0;
-    while (i != this->end() && *i == key) {
-      ++i;
-      ++n;
-    }
-    return n;
+  // Replace the contents with the union, intersection or difference of this
+  // multiset and other, and leave other empty. As with the std algorithms, a
+  // key occurring a times here and b times in other occurs max(a, b),
+  // min(a, b), max(a - b, 0) or |a - b| times. The trees are split and
+  // joined around runs of equivalent keys, so the cost is O(m log(n / m + 1))
+  // for sizes m <= n as for set, plus the dropped elements, and the nodes
+  // that stay are relinked rather than copied.
+  void set_union(multiset& other) {
+    this->set_operation_equal(other, tree::kUnion);
+  }
+
+  void set_intersection(multiset& other) {
+    this->set_operation_equal(other, tree::kIntersection);
   }
 
-  std::pair<iterator, iterator> equal_range(const Key& key) {
-    iterator i = this->find(key);
-    iterator j = i;
-    while (j != this->end() && *j == key) ++j;
-    return std::pair<iterator, iterator>{i, j};
+  void set_difference(multiset& other) {
+    this->set_operation_equal(other, tree::kDifference);
   }
 
-  iterator lower_bound(const Key& key) { return this->find(key); }
+  void symmetric_difference(multiset& other) {
+    this->set_operation_equal(other, tree::kSymmetricDifference);
+  }
+
+  // The same, with the two sides of large splits processed on the threads of
+  // the pool.
+  void set_union(multiset& other, ThreadPool& threads) {
+    this->set_operation_equal(other, tree::kUnion, &threads);
+  }
 
-  iterator upper_bound(const Key& key) { return std::get<1>(equal_range(key)); }
+  void set_intersection(multiset& other, ThreadPool& threads) {
+    this->set_operation_equal(other, tree::kIntersection, &threads);
+  }
+
+  void set_difference(multiset& other, ThreadPool& threads) {
+    this->set_operation_equal(other, tree::kDifference, &threads);
+  }
+
+  void symmetric_difference(multiset& other, ThreadPool& threads) {
+    this->set_operation_equal(other, tree::kSymmetricDifference, &threads);
+  }
+
+  // Counts the equivalent keys as the difference of two ranks, so the cost
+  // is O(log n) however many there are.
+  size_type count(const Key& key) const {
+    return this->rank_of(key, true) - this->rank_of(key, false);
+  }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  size_type count(const K& key) const {
+    return this->rank_of(key, true) - this->rank_of(key, false);
+  }
+
+  // Constructs the element from args in its node.
+  template <class... Args>
+  iterator emplace(Args&&... args) {
+    return this->emplace_equal(std::forward<Args>(args)...);
+  }
+
+  // The same, with the element placed as by insert with a hint.
+  template <class... Args>
+  iterator emplace_hint(iterator hint, Args&&... args) {
+    return this->emplace_hint_equal(hint, std::forward<Args>(args)...);
+  }
 
+  // Inserts every argument in turn.
   template <class... Args>
-  containers::vector<iterator> emplace(Args&&... args) {
+  containers::vector<iterator> insert_many(Args&&... args) {
     containers::vector<iterator> v;
-    const value_type data[] = {args...};
-    for (const value_type item : data) v.push_back(insert(item));
+    (v.push_back(insert(std::forward<Args>(args))), ...);
     return v;
   }
 };
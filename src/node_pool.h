@@ -0,0 +1,406 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+
+namespace containers {
+// Slab allocator for the nodes of one container. Nodes are carved from slabs
+// that grow geometrically, and destroyed nodes are recycled through a free
+// list, so creating a node is O(1) and nodes of a container stay close
+// together in memory. release() returns every slab at once. Slabs are
+// obtained from Allocator rebound to the slot type.
+//
+// Pools with equal allocators can share their slabs, so that nodes created
+// by one pool can be linked into the container of the other and destroyed
+// through it. Shared slabs are freed when the last pool sharing them is
+// released. A pool that never shared frees its slabs on its own and pays
+// nothing for this.
+template <class T, class Allocator = std::allocator<T>>
+class NodePool {
+ public:
+  using size_type = size_t;
+  using allocator_type = Allocator;
+
+  struct Group;
+
+  explicit NodePool(const Allocator& alloc = Allocator())
+      : allocator_(alloc),
+        slabs_(nullptr),
+        free_(nullptr),
+        free_tail_(nullptr),
+        next_(nullptr),
+        end_(nullptr),
+        slab_size_(kFirstSlabSize),
+        group_(nullptr) {}
+  NodePool(const NodePool&) = delete;
+  NodePool& operator=(const NodePool&) = delete;
+  ~NodePool() { release(); }
+
+  allocator_type get_allocator() const { return allocator_type(allocator_); }
+
+  template <class... Args>
+  T* create(Args&&... args) {
+    Slot* slot = allocate();
+    try {
+      return new (slot->storage) T(std::forward<Args>(args)...);
+    } catch (...) {
+      deallocate(slot);
+      throw;
+    }
+  }
+
+  void destroy(T* node) {
+    node->~T();
+    deallocate(reinterpret_cast<Slot*>(node));
+  }
+
+  // Destroys node and creates a new one in its slot, saving the trip
+  // through the free list. If the new node throws, the slot is freed.
+  template <class... Args>
+  T* recreate(T* node, Args&&... args) {
+    node->~T();
+    Slot* slot = reinterpret_cast<Slot*>(node);
+    try {
+      return new (slot->storage) T(std::forward<Args>(args)...);
+    } catch (...) {
+      deallocate(slot);
+      throw;
+    }
+  }
+
+  // Creates a node outside of the slabs, for sentinels that have to survive
+  // release().
+  template <class... Args>
+  T* create_standalone(Args&&... args) {
+    NodeAllocator alloc(allocator_);
+    T* node = NodeTraits::allocate(alloc, 1);
+    try {
+      return new (node) T(std::forward<Args>(args)...);
+    } catch (...) {
+      NodeTraits::deallocate(alloc, node, 1);
+      throw;
+    }
+  }
+
+  void destroy_standalone(T* node) {
+    NodeAllocator alloc(allocator_);
+    node->~T();
+    NodeTraits::deallocate(alloc, node, 1);
+  }
+
+  // Frees all slabs. Nodes that were not destroyed are left dangling, so the
+  // owner must have destroyed them or must not need their destructors. The
+  // slabs of a shared pool are handed to the pools it shares with instead,
+  // and freed with the last of them.
+  void release() {
+    if (group_) {
+      std::lock_guard<std::mutex> lock(group_mutex());
+      Group* root = find_root(group_);
+      if (slabs_) {
+        header(last_slab(slabs_))->next = root->slabs;
+        root->slabs = slabs_;
+      }
+      if (free_) {
+        free_tail_->next = root->free;
+        root->free = free_;
+      }
+      slabs_ = nullptr;
+      unref(group_);
+      group_ = nullptr;
+    }
+    free_slabs(allocator_, slabs_);
+    slabs_ = nullptr;
+    free_ = free_tail_ = nullptr;
+    next_ = end_ = nullptr;
+    slab_size_ = kFirstSlabSize;
+  }
+
+  void swap(NodePool& other) {
+    std::swap(allocator_, other.allocator_);
+    std::swap(slabs_, other.slabs_);
+    std::swap(free_, other.free_);
+    std::swap(free_tail_, other.free_tail_);
+    std::swap(next_, other.next_);
+    std::swap(end_, other.end_);
+    std::swap(slab_size_, other.slab_size_);
+    std::swap(group_, other.group_);
+  }
+
+  // Whether the nodes of this pool may live in slabs of other pools.
+  bool shared() const { return group_ != nullptr; }
+
+  // Lets this pool and other destroy each other's nodes and link them into
+  // their containers, as long as both share. Both keep their slabs, and the
+  // slabs of either are freed once both are released. Sharing needs equal
+  // allocators, otherwise nothing is shared and false is returned.
+  bool share(NodePool& other) {
+    if (this == &other) return true;
+    if (!(allocator_ == other.allocator_)) return false;
+    std::lock_guard<std::mutex> lock(group_mutex());
+    Group* group = own_group();
+    Group* other_group = other.own_group();
+    if (group == nullptr) {
+      if (other_group) join(other_group);
+    } else if (other_group == nullptr) {
+      other.join(group);
+    } else if (group != other_group) {
+      unite(group, other_group);
+      other.own_group();
+    }
+    return true;
+  }
+
+  // Returns a reference on the group of this pool, which keeps a node of
+  // the pool alive outside of its container, through releases of the pool,
+  // until the reference is adopted by a pool or dropped with the node.
+  Group* hold() {
+    std::lock_guard<std::mutex> lock(group_mutex());
+    Group* group = own_group();
+    ++group->refs;
+    return group;
+  }
+
+  // Takes over a reference returned by hold(), sharing with its group, so
+  // the node it kept alive can be linked into this pool's container. Needs
+  // equal allocators, otherwise the reference is kept and false returned.
+  bool adopt(Group* group) {
+    if (!(allocator_ == group->allocator)) return false;
+    std::lock_guard<std::mutex> lock(group_mutex());
+    Group* root = find_root(group);
+    Group* own = own_group();
+    if (own == nullptr) {
+      join(root);
+    } else if (own != root) {
+      unite(own, root);
+    }
+    unref(group);
+    return true;
+  }
+
+  // Destroys a node kept alive by a reference returned by hold(), and drops
+  // the reference. The slot is recycled by the pools of the group.
+  static void drop(T* node, Group* group) {
+    node->~T();
+    std::lock_guard<std::mutex> lock(group_mutex());
+    Group* root = find_root(group);
+    Slot* slot = reinterpret_cast<Slot*>(node);
+    slot->next = root->free;
+    root->free = slot;
+    unref(group);
+  }
+
+  // Takes ownership of every slab of other, so nodes created by other can be
+  // linked into this pool's container. other is left empty. Slabs can only
+  // change hands between equal allocators, otherwise nothing is taken and
+  // false is returned. If either pool is shared, the pools share instead.
+  bool splice(NodePool& other) {
+    if (this == &other) return true;
+    if (!(allocator_ == other.allocator_)) return false;
+    if (group_ || other.group_) return share(other);
+    if (other.slabs_ == nullptr) return true;
+    header(last_slab(other.slabs_))->next = slabs_;
+    slabs_ = other.slabs_;
+    if (other.free_) {
+      other.free_tail_->next = free_;
+      if (free_ == nullptr) free_tail_ = other.free_tail_;
+      free_ = other.free_;
+    }
+    if (end_ - next_ < other.end_ - other.next_) {
+      next_ = other.next_;
+      end_ = other.end_;
+      slab_size_ = other.slab_size_;
+    }
+    other.slabs_ = nullptr;
+    other.release();
+    return true;
+  }
+
+ private:
+  union Slot {
+    Slot* next;
+    alignas(T) unsigned char storage[sizeof(T)];
+  };
+
+  using SlotAllocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<Slot>;
+
+ public:
+  // Pools that shared form a group, which holds the slabs and free slots
+  // they released while other pools or node handles still need them.
+  // Groups merge as their pools share: a merged group forwards to the one
+  // it joined and holds a reference on it. The first group of a pool is
+  // kept in the header of its newest slab, so sharing allocates nothing.
+  // All groups are guarded by one mutex, since sharing is rare next to
+  // creating nodes.
+  struct Group {
+    size_type refs;
+    Group* forward;
+    Slot* slabs;
+    Slot* free;
+    SlotAllocator allocator;
+  };
+
+ private:
+  // Every slab starts with this header, stored in its first slots.
+  struct SlabHeader {
+    Slot* next;
+    size_type size;
+    alignas(Group) unsigned char group[sizeof(Group)];
+  };
+
+  using SlotTraits = std::allocator_traits<SlotAllocator>;
+  using NodeAllocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+  using NodeTraits = std::allocator_traits<NodeAllocator>;
+
+  static constexpr size_type kHeaderSlots =
+      (sizeof(SlabHeader) + sizeof(Slot) - 1) / sizeof(Slot);
+  static constexpr size_type kFirstSlabSize = 16;
+  static constexpr size_type kMaxSlabSize =
+      (size_type(1) << 16) / sizeof(Slot) > kFirstSlabSize
+          ? (size_type(1) << 16) / sizeof(Slot)
+          : kFirstSlabSize;
+
+  SlotAllocator allocator_;
+  Slot* slabs_;
+  Slot* free_;
+  Slot* free_tail_;
+  Slot* next_;
+  Slot* end_;
+  size_type slab_size_;
+  Group* group_;
+
+  static std::mutex& group_mutex() {
+    static std::mutex mutex;
+    return mutex;
+  }
+
+  static SlabHeader* header(Slot* slab) {
+    return reinterpret_cast<SlabHeader*>(slab);
+  }
+
+  static Slot* last_slab(Slot* slab) {
+    while (header(slab)->next) slab = header(slab)->next;
+    return slab;
+  }
+
+  static void free_slabs(SlotAllocator& alloc, Slot* slab) {
+    while (slab) {
+      Slot* next = header(slab)->next;
+      SlotTraits::deallocate(alloc, slab, header(slab)->size);
+      slab = next;
+    }
+  }
+
+  static Group* find_root(Group* group) {
+    while (group->forward) group = group->forward;
+    return group;
+  }
+
+  // Drops a reference on group, and on the groups it forwards to as they
+  // lose their last one. The last reference on a root frees every slab the
+  // group holds.
+  static void unref(Group* group) {
+    while (--group->refs == 0) {
+      Group* forward = group->forward;
+      if (forward == nullptr) {
+        SlotAllocator alloc(std::move(group->allocator));
+        Slot* slabs = group->slabs;
+        group->~Group();
+        free_slabs(alloc, slabs);
+        return;
+      }
+      group->~Group();
+      group = forward;
+    }
+  }
+
+  // Makes other join group. Both have to be roots.
+  static void unite(Group* group, Group* other) {
+    other->forward = group;
+    ++group->refs;
+    if (other->slabs) {
+      header(last_slab(other->slabs))->next = group->slabs;
+      group->slabs = other->slabs;
+      other->slabs = nullptr;
+    }
+    if (other->free) {
+      Slot* last = other->free;
+      while (last->next) last = last->next;
+      last->next = group->free;
+      group->free = other->free;
+      other->free = nullptr;
+    }
+  }
+
+  // Returns the root of the group of this pool, pointing the pool at it.
+  // A pool without a group gets one unless it has no slabs, and so no
+  // nodes, in which case nullptr is returned.
+  Group* own_group() {
+    if (group_ == nullptr) {
+      if (slabs_ == nullptr) return nullptr;
+      group_ = new (header(slabs_)->group)
+          Group{1, nullptr, nullptr, nullptr, allocator_};
+      return group_;
+    }
+    Group* root = find_root(group_);
+    if (root != group_) {
+      ++root->refs;
+      unref(group_);
+      group_ = root;
+    }
+    return root;
+  }
+
+  void join(Group* group) {
+    ++group->refs;
+    group_ = group;
+  }
+
+  // Takes the free slots the group gathered, if there are any.
+  bool reclaim() {
+    std::lock_guard<std::mutex> lock(group_mutex());
+    Group* root = find_root(group_);
+    if (root->free == nullptr) return false;
+    free_ = free_tail_ = root->free;
+    while (free_tail_->next) free_tail_ = free_tail_->next;
+    root->free = nullptr;
+    return true;
+  }
+
+  Slot* allocate() {
+    if (free_) {
+      Slot* slot = free_;
+      free_ = free_->next;
+      if (free_ == nullptr) free_tail_ = nullptr;
+      return slot;
+    }
+    if (next_ == end_) {
+      if (group_ && reclaim()) return allocate();
+      add_slab();
+    }
+    return next_++;
+  }
+
+  void deallocate(Slot* slot) {
+    slot->next = free_;
+    if (free_ == nullptr) free_tail_ = slot;
+    free_ = slot;
+  }
+
+  void add_slab() {
+    size_type size = kHeaderSlots + slab_size_;
+    Slot* slab = SlotTraits::allocate(allocator_, size);
+    SlabHeader* head = new (slab) SlabHeader;
+    head->next = slabs_;
+    head->size = size;
+    slabs_ = slab;
+    next_ = slab + kHeaderSlots;
+    end_ = slab + size;
+    if (slab_size_ < kMaxSlabSize) slab_size_ *= 2;
+  }
+};
+}  // namespace containers
@@ -0,0 +1,421 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+#include "vector.h"
+
+namespace containers {
+// Ordered map whose versions share structure. Nodes are immutable once
+// built and reference counted, so an update copies the O(log n) nodes on the
+// path to the changed key and shares every other subtree with the previous
+// version. snapshot() returns the current version in O(1), and a snapshot
+// can be read and iterated from any thread without locks for as long as it
+// is kept, whatever the writer does meanwhile.
+//
+// Updates are for one writer thread at a time. The writer publishes every
+// new version by swapping the root under a mutex that is held only for the
+// swap, which is also the only time snapshot() waits. Without parent
+// pointers the red-black fixups of BinaryTree would need the whole path as
+// well, so versions are kept balanced by subtree height instead.
+template <class Key, class T, class Compare = std::less<Key>,
+          class Allocator = std::allocator<std::pair<const Key, T>>>
+class persistent_map {
+ public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<const key_type, mapped_type>;
+  using const_reference = const value_type&;
+  using size_type = size_t;
+  using key_compare = Compare;
+  using allocator_type = Allocator;
+
+ private:
+  struct Node {
+    mutable std::atomic<size_type> refs;
+    const Node* left;
+    const Node* right;
+    size_type count;
+    unsigned char height;
+    value_type value;
+
+    template <class... Args>
+    Node(const Node* l, const Node* r, Args&&... args)
+        : refs(1),
+          left(l),
+          right(r),
+          count(1 + subtree_size(l) + subtree_size(r)),
+          height(1 + std::max(subtree_height(l), subtree_height(r))),
+          value(std::forward<Args>(args)...) {}
+  };
+
+  using node_allocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+  using node_traits = std::allocator_traits<node_allocator>;
+
+ public:
+  // Walks a version in key order, keeping the path from the root as a stack
+  // of the nodes still to visit, as nodes have no parent pointers.
+  class const_iterator {
+    friend class persistent_map;
+
+   public:
+    const_iterator() {}
+
+    const_reference operator*() const {
+      return path_.data()[path_.size() - 1]->value;
+    }
+
+    const_iterator& operator++() {
+      const Node* node = path_.data()[path_.size() - 1]->right;
+      path_.pop_back();
+      push_left(node);
+      return *this;
+    }
+
+    const_iterator operator++(int) {
+      const_iterator ret(*this);
+      ++(*this);
+      return ret;
+    }
+
+    bool operator==(const const_iterator& i) const {
+      if (path_.size() != i.path_.size()) return false;
+      return path_.size() == 0 || path_.data()[path_.size() - 1] ==
+                                      i.path_.data()[i.path_.size() - 1];
+    }
+    bool operator!=(const const_iterator& i) const { return !(*this == i); }
+
+   private:
+    void push_left(const Node* node) {
+      for (; node; node = node->left) path_.push_back(node);
+    }
+
+    containers::vector<const Node*> path_;
+  };
+
+  using iterator = const_iterator;
+
+  // One version of the map. Copies share it, and its nodes are freed when
+  // the last snapshot or map that holds them lets go.
+  class snapshot_type {
+    friend class persistent_map;
+
+   public:
+    using const_iterator = typename persistent_map::const_iterator;
+    using iterator = const_iterator;
+
+    snapshot_type() : root_(nullptr) {}
+    snapshot_type(const snapshot_type& s)
+        : root_(acquire(s.root_)), alloc_(s.alloc_), compare_(s.compare_) {}
+    snapshot_type(snapshot_type&& s)
+        : root_(s.root_), alloc_(s.alloc_), compare_(s.compare_) {
+      s.root_ = nullptr;
+    }
+    ~snapshot_type() { release(alloc_, root_); }
+
+    snapshot_type& operator=(snapshot_type s) {
+      std::swap(root_, s.root_);
+      std::swap(alloc_, s.alloc_);
+      std::swap(compare_, s.compare_);
+      return *this;
+    }
+
+    const_iterator begin() const {
+      const_iterator i;
+      i.push_left(root_);
+      return i;
+    }
+
+    const_iterator end() const { return const_iterator(); }
+
+    bool empty() const { return root_ == nullptr; }
+
+    size_type size() const { return subtree_size(root_); }
+
+    const_iterator find(const Key& key) const {
+      const_iterator i = lower_bound(key);
+      if (i == end() || compare_(key, (*i).first)) return end();
+      return i;
+    }
+
+    bool contains(const Key& key) const {
+      return find_node(root_, key, compare_) != nullptr;
+    }
+
+    size_type count(const Key& key) const { return contains(key); }
+
+    const T& at(const Key& key) const {
+      const Node* node = find_node(root_, key, compare_);
+      if (node == nullptr)
+        throw std::out_of_range("There's no obj in map with such key");
+      return std::get<1>(node->value);
+    }
+
+    // Returns the first element with a key not less than the given one.
+    const_iterator lower_bound(const Key& key) const {
+      const_iterator i;
+      for (const Node* node = root_; node;) {
+        if (compare_(std::get<0>(node->value), key)) {
+          node = node->right;
+        } else {
+          i.path_.push_back(node);
+          node = node->left;
+        }
+      }
+      return i;
+    }
+
+   private:
+    snapshot_type(const Node* root, const node_allocator& alloc,
+                  const Compare& comp)
+        : root_(root), alloc_(alloc), compare_(comp) {}
+
+    const Node* root_;
+    node_allocator alloc_;
+    Compare compare_;
+  };
+
+  persistent_map() : persistent_map(Compare(), Allocator()) {}
+  explicit persistent_map(const Allocator& alloc)
+      : persistent_map(Compare(), alloc) {}
+  explicit persistent_map(const Compare& comp,
+                          const Allocator& alloc = Allocator())
+      : root_(nullptr), alloc_(alloc), compare_(comp) {}
+  persistent_map(const persistent_map&) = delete;
+  persistent_map& operator=(const persistent_map&) = delete;
+  ~persistent_map() { release(alloc_, root_); }
+
+  allocator_type get_allocator() const { return allocator_type(alloc_); }
+
+  key_compare key_comp() const { return compare_; }
+
+  // Returns the current version. Safe to call from any thread.
+  snapshot_type snapshot() const {
+    std::lock_guard<std::mutex> lock(publish_);
+    return snapshot_type(acquire(root_), alloc_, compare_);
+  }
+
+  // The members below read or write the current version, and are for the
+  // writer thread only.
+  bool empty() const { return root_ == nullptr; }
+
+  size_type size() const { return subtree_size(root_); }
+
+  bool contains(const Key& key) const {
+    return find_node(root_, key, compare_) != nullptr;
+  }
+
+  const T& at(const Key& key) const {
+    const Node* node = find_node(root_, key, compare_);
+    if (node == nullptr)
+      throw std::out_of_range("There's no obj in map with such key");
+    return std::get<1>(node->value);
+  }
+
+  // Inserts obj unless key is present. Returns whether it was inserted.
+  bool insert(const Key& key, const T& obj) {
+    if (contains(key)) return false;
+    publish(insert_node(root_, key, obj, false));
+    return true;
+  }
+
+  // Returns whether key was inserted rather than assigned.
+  bool insert_or_assign(const Key& key, const T& obj) {
+    bool inserted = !contains(key);
+    publish(insert_node(root_, key, obj, true));
+    return inserted;
+  }
+
+  // Returns the number of elements erased, 0 or 1.
+  size_type erase(const Key& key) {
+    if (!contains(key)) return 0;
+    publish(erase_node(root_, key));
+    return 1;
+  }
+
+  void clear() { publish(nullptr); }
+
+ private:
+  const Node* root_;
+  node_allocator alloc_;
+  Compare compare_;
+  mutable std::mutex publish_;
+
+  static size_type subtree_size(const Node* node) {
+    return node ? node->count : 0;
+  }
+
+  static unsigned char subtree_height(const Node* node) {
+    return node ? node->height : 0;
+  }
+
+  static const Node* acquire(const Node* node) {
+    if (node) node->refs.fetch_add(1, std::memory_order_relaxed);
+    return node;
+  }
+
+  // Drops one reference to node, freeing it and then the subtrees it held
+  // if that was the last one.
+  static void release(node_allocator& alloc, const Node* node) {
+    while (node && node->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      release(alloc, node->left);
+      const Node* right = node->right;
+      Node* dead = const_cast<Node*>(node);
+      node_traits::destroy(alloc, dead);
+      node_traits::deallocate(alloc, dead, 1);
+      node = right;
+    }
+  }
+
+  static const Node* find_node(const Node* node, const Key& key,
+                               const Compare& compare) {
+    while (node) {
+      if (compare(key, std::get<0>(node->value)))
+        node = node->left;
+      else if (compare(std::get<0>(node->value), key))
+        node = node->right;
+      else
+        return node;
+    }
+    return nullptr;
+  }
+
+  // Makes the new root current and drops the writer's reference to the old
+  // one, which frees whatever no snapshot shares.
+  void publish(const Node* root) {
+    const Node* old = root_;
+    {
+      std::lock_guard<std::mutex> lock(publish_);
+      root_ = root;
+    }
+    release(alloc_, old);
+  }
+
+  // Builds a node that takes over one reference to each of left and right.
+  // If the value throws, those references are dropped.
+  template <class... Args>
+  const Node* make_node(const Node* left, const Node* right,
+                        Args&&... args) {
+    Node* node = node_traits::allocate(alloc_, 1);
+    try {
+      node_traits::construct(alloc_, node, left, right,
+                             std::forward<Args>(args)...);
+    } catch (...) {
+      node_traits::deallocate(alloc_, node, 1);
+      release(alloc_, left);
+      release(alloc_, right);
+      throw;
+    }
+    return node;
+  }
+
+  // Builds a node for value between left and right, which differ in height
+  // by at most two, and rotates copies of the taller side's nodes so they
+  // differ by at most one. Takes over the references to left and right, and
+  // drops them if a value throws.
+  const Node* balance(const Node* left, const value_type& value,
+                      const Node* right) {
+    if (subtree_height(left) > subtree_height(right) + 1) {
+      const Node* l = left;
+      const Node* result;
+      try {
+        if (subtree_height(l->left) >= subtree_height(l->right)) {
+          const Node* inner = make_node(acquire(l->right), right, value);
+          result = make_node(acquire(l->left), inner, l->value);
+        } else {
+          const Node* lr = l->right;
+          const Node* b = make_node(acquire(lr->right), right, value);
+          const Node* a;
+          try {
+            a = make_node(acquire(l->left), acquire(lr->left), l->value);
+          } catch (...) {
+            release(alloc_, b);
+            throw;
+          }
+          result = make_node(a, b, lr->value);
+        }
+      } catch (...) {
+        release(alloc_, left);
+        throw;
+      }
+      release(alloc_, left);
+      return result;
+    }
+    if (subtree_height(right) > subtree_height(left) + 1) {
+      const Node* r = right;
+      const Node* result;
+      try {
+        if (subtree_height(r->right) >= subtree_height(r->left)) {
+          const Node* inner = make_node(left, acquire(r->left), value);
+          result = make_node(inner, acquire(r->right), r->value);
+        } else {
+          const Node* rl = r->left;
+          const Node* a = make_node(left, acquire(rl->left), value);
+          const Node* b;
+          try {
+            b = make_node(acquire(rl->right), acquire(r->right), r->value);
+          } catch (...) {
+            release(alloc_, a);
+            throw;
+          }
+          result = make_node(a, b, rl->value);
+        }
+      } catch (...) {
+        release(alloc_, right);
+        throw;
+      }
+      release(alloc_, right);
+      return result;
+    }
+    return make_node(left, right, value);
+  }
+
+  // Returns a new version of the subtree with key mapped to obj, copying
+  // the path to key. An existing value is replaced only if assign is set.
+  const Node* insert_node(const Node* node, const Key& key, const T& obj,
+                          bool assign) {
+    if (node == nullptr) return make_node(nullptr, nullptr, key, obj);
+    if (compare_(key, std::get<0>(node->value))) {
+      const Node* left = insert_node(node->left, key, obj, assign);
+      return balance(left, node->value, acquire(node->right));
+    }
+    if (compare_(std::get<0>(node->value), key)) {
+      const Node* right = insert_node(node->right, key, obj, assign);
+      return balance(acquire(node->left), node->value, right);
+    }
+    if (!assign) return acquire(node);
+    return make_node(acquire(node->left), acquire(node->right), key, obj);
+  }
+
+  // Returns a new version of the subtree without key, which it contains.
+  const Node* erase_node(const Node* node, const Key& key) {
+    if (compare_(key, std::get<0>(node->value))) {
+      const Node* left = erase_node(node->left, key);
+      return balance(left, node->value, acquire(node->right));
+    }
+    if (compare_(std::get<0>(node->value), key)) {
+      const Node* right = erase_node(node->right, key);
+      return balance(acquire(node->left), node->value, right);
+    }
+    if (node->left == nullptr) return acquire(node->right);
+    if (node->right == nullptr) return acquire(node->left);
+    const Node* successor = node->right;
+    while (successor->left) successor = successor->left;
+    const Node* right = erase_min(node->right);
+    return balance(acquire(node->left), successor->value, right);
+  }
+
+  // Returns a new version of the subtree without its first element.
+  const Node* erase_min(const Node* node) {
+    if (node->left == nullptr) return acquire(node->right);
+    const Node* left = erase_min(node->left);
+    return balance(left, node->value, acquire(node->right));
+  }
+};
+}  // namespace containers
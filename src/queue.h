@@ -1,10 +1,13 @@
 #pragma once
 
 #include <iostream>
+#include <memory>
+
+#include "node_pool.h"
 
 namespace containers {
 
-template <class T>
+template <class T, class Allocator = std::allocator<T>>
 class queue {
  private:
   class Node {
@@ -30,15 +33,19 @@ class queue {
   using reference = value_type&;
   using const_reference = const reference;
   using size_type = size_t;
+  using allocator_type = Allocator;
 
  private:
   Node* head_ = nullptr;
   Node* tail_ = nullptr;
   size_type size_ = 0;
+  NodePool<Node, Allocator> pool_;
 
  public:
-  queue() : size_(0) {
-    Node* null_tmp = new Node;
+  queue() : queue(Allocator()) {}
+
+  explicit queue(const Allocator& alloc) : size_(0), pool_(alloc) {
+    Node* null_tmp = pool_.create();
     head_ = null_tmp;
     tail_ = null_tmp;
   };
@@ -62,6 +69,7 @@ class queue {
     std::swap(tail_, q.tail_);
     size_ = q.size_;
     q.size_ = 0;
+    pool_.swap(q.pool_);
   };
 
   ~queue() {
@@ -81,12 +89,14 @@ class queue {
     return *this;
   };
 
+  allocator_type get_allocator() const { return pool_.get_allocator(); }
+
   const_reference front() { return head_->getValue(); };
 
   const_reference back() { return tail_->getNext()->getValue(); };
 
   void push(const_reference value) {
-    tail_->setPrev(new Node(value_type(), tail_));
+    tail_->setPrev(pool_.create(value_type(), tail_));
     tail_->setValue(value);
     tail_ = tail_->getPrev();
     ++size_;
@@ -94,7 +104,7 @@ class queue {
 
   void pop() {
     Node* tmp = head_->getPrev();
-    delete head_;
+    pool_.destroy(head_);
     head_ = tmp;
     --size_;
   };
@@ -103,12 +113,20 @@ class queue {
     std::swap(head_, other.head_);
     std::swap(tail_, other.tail_);
     std::swap(size_, other.size_);
+    pool_.swap(other.pool_);
   };
 
-  size_type size() { return size_; };
+  size_type size() const { return size_; };
 
   bool empty() { return !size_; };
 
+  // Calls f with every element from the front to the back.
+  template <class F>
+  void for_each(F f) const {
+    for (Node* node = head_; node != tail_; node = node->getPrev())
+      f(static_cast<const T&>(node->getValue()));
+  }
+
   template <typename... Args>
   void emplace_back(Args&&... args) {
     value_type value(args...);
@@ -0,0 +1,313 @@
+#pragma once
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+#include "array.h"
+#include "list.h"
+#include "map.h"
+#include "mapped_file.h"
+#include "multiset.h"
+#include "queue.h"
+#include "set.h"
+#include "vector.h"
+
+namespace containers {
+// Binary snapshots of containers of trivially copyable elements. A snapshot
+// is a 64-byte header followed by the elements as they lie in memory, in
+// iteration order, so it can only be read back on a machine with the same
+// byte order and layout, which the header records. save() writes through a
+// large buffer into a temporary file that replaces path once complete.
+// load() maps the file and builds the container straight from the mapped
+// elements: vector and array are filled by one copy, and the sorted
+// elements of a set, multiset or map are linked into a balanced tree in
+// linear time. A file that does not fit the container throws
+// std::runtime_error and leaves the container unchanged.
+struct SnapshotHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t value_size;
+  uint64_t value_align;
+  uint64_t count;
+  char reserved[24];
+};
+
+static_assert(sizeof(SnapshotHeader) == 64, "snapshot header is 64 bytes");
+
+constexpr char kSnapshotMagic[8] = {'C', 'N', 'T', 'S', 'N', 'A', 'P', '\0'};
+constexpr uint32_t kSnapshotVersion = 1;
+constexpr uint32_t kSnapshotByteOrder = 0x01020304;
+
+// Writes a file through a buffer of kBufferSize bytes, so node containers
+// cost one system call per megabyte rather than per element.
+class SnapshotWriter {
+ public:
+  static constexpr size_t kBufferSize = size_t(1) << 20;
+
+  explicit SnapshotWriter(const std::string& path)
+      : path_(path),
+        temp_path_(path + ".tmp"),
+        buffer_(new char[kBufferSize]),
+        used_(0) {
+    fd_ = ::open(temp_path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                 0644);
+    if (fd_ < 0) fail("open " + temp_path_);
+  }
+  SnapshotWriter(const SnapshotWriter&) = delete;
+  SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+  ~SnapshotWriter() {
+    if (fd_ >= 0) {
+      ::close(fd_);
+      ::unlink(temp_path_.c_str());
+    }
+  }
+
+  // Writes the header of a snapshot of count elements of type T.
+  template <class T>
+  void write_header(size_t count) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "snapshots hold trivially copyable elements only");
+    static_assert(alignof(T) <= sizeof(SnapshotHeader),
+                  "elements follow the header without padding");
+    SnapshotHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kSnapshotMagic, sizeof(header.magic));
+    header.version = kSnapshotVersion;
+    header.byte_order = kSnapshotByteOrder;
+    header.value_size = sizeof(T);
+    header.value_align = alignof(T);
+    header.count = count;
+    write(&header, sizeof(header));
+  }
+
+  void write(const void* data, size_t n) {
+    const char* bytes = static_cast<const char*>(data);
+    if (used_ + n > kBufferSize) {
+      flush();
+      if (n >= kBufferSize) {
+        write_all(bytes, n);
+        return;
+      }
+    }
+    std::memcpy(buffer_.get() + used_, bytes, n);
+    used_ += n;
+  }
+
+  // Flushes the buffer and moves the file into place.
+  void commit() {
+    flush();
+    int fd = fd_;
+    fd_ = -1;
+    if (::close(fd) != 0) {
+      ::unlink(temp_path_.c_str());
+      fail("close " + temp_path_);
+    }
+    if (std::rename(temp_path_.c_str(), path_.c_str()) != 0) {
+      int error = errno;
+      ::unlink(temp_path_.c_str());
+      throw std::system_error(error, std::generic_category(),
+                              "rename " + temp_path_);
+    }
+  }
+
+ private:
+  std::string path_;
+  std::string temp_path_;
+  std::unique_ptr<char[]> buffer_;
+  size_t used_;
+  int fd_;
+
+  [[noreturn]] static void fail(const std::string& what) {
+    throw std::system_error(errno, std::generic_category(), what);
+  }
+
+  void flush() {
+    write_all(buffer_.get(), used_);
+    used_ = 0;
+  }
+
+  void write_all(const char* data, size_t n) {
+    while (n > 0) {
+      ssize_t written = ::write(fd_, data, n);
+      if (written < 0) {
+        if (errno == EINTR) continue;
+        fail("write " + temp_path_);
+      }
+      data += written;
+      n -= static_cast<size_t>(written);
+    }
+  }
+};
+
+// Saves count elements of type T from [first, last).
+template <class T, class InputIt>
+void save_snapshot(const std::string& path, size_t count, InputIt first,
+                   InputIt last) {
+  SnapshotWriter writer(path);
+  writer.write_header<T>(count);
+  for (; first != last; ++first) {
+    const T& value = *first;
+    writer.write(&value, sizeof(T));
+  }
+  writer.commit();
+}
+
+template <class T>
+void save_snapshot(const std::string& path, const T* data, size_t count) {
+  SnapshotWriter writer(path);
+  writer.write_header<T>(count);
+  if (count) writer.write(data, count * sizeof(T));
+  writer.commit();
+}
+
+// Maps a snapshot of elements of type T and checks its header. The
+// elements are then at begin()[0, count()).
+template <class T>
+class SnapshotReader {
+ public:
+  explicit SnapshotReader(const std::string& path) : file_(path) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "snapshots hold trivially copyable elements only");
+    SnapshotHeader header;
+    if (file_.size() < sizeof(header))
+      throw std::runtime_error("Snapshot " + path + " is truncated");
+    std::memcpy(&header, file_.data(), sizeof(header));
+    if (std::memcmp(header.magic, kSnapshotMagic, sizeof(header.magic)) != 0)
+      throw std::runtime_error(path + " is not a snapshot");
+    if (header.version != kSnapshotVersion)
+      throw std::runtime_error("Snapshot " + path +
+                               " has an unsupported version");
+    if (header.byte_order != kSnapshotByteOrder ||
+        header.value_size != sizeof(T) || header.value_align != alignof(T))
+      throw std::runtime_error("Snapshot " + path +
+                               " holds elements of another layout");
+    if ((file_.size() - sizeof(header)) / sizeof(T) < header.count)
+      throw std::runtime_error("Snapshot " + path + " is truncated");
+    count_ = static_cast<size_t>(header.count);
+    file_.advise_sequential();
+  }
+
+  const T* begin() const {
+    return reinterpret_cast<const T*>(file_.data() + sizeof(SnapshotHeader));
+  }
+
+  const T* end() const { return begin() + count_; }
+
+  size_t count() const { return count_; }
+
+ private:
+  MappedFile file_;
+  size_t count_;
+};
+
+template <class T, class Allocator>
+void save(const vector<T, Allocator>& v, const std::string& path) {
+  save_snapshot(path, v.data(), v.size());
+}
+
+template <class T, size_t N>
+void save(const array<T, N>& a, const std::string& path) {
+  save_snapshot<T>(path, &*a.begin(), N);
+}
+
+template <class T, class Allocator>
+void save(const list<T, Allocator>& l, const std::string& path) {
+  save_snapshot<T>(path, l.size(), l.begin(), l.end());
+}
+
+template <class T, class Allocator>
+void save(const queue<T, Allocator>& q, const std::string& path) {
+  SnapshotWriter writer(path);
+  writer.write_header<T>(q.size());
+  q.for_each([&writer](const T& value) { writer.write(&value, sizeof(T)); });
+  writer.commit();
+}
+
+template <class Key, class Compare, class Allocator>
+void save(const set<Key, Compare, Allocator>& s, const std::string& path) {
+  save_snapshot<Key>(path, s.size(), s.begin(), s.end());
+}
+
+template <class Key, class Compare, class Allocator>
+void save(const multiset<Key, Compare, Allocator>& s,
+          const std::string& path) {
+  save_snapshot<Key>(path, s.size(), s.begin(), s.end());
+}
+
+template <class Key, class T, class Compare, class Allocator>
+void save(const map<Key, T, Compare, Allocator>& m, const std::string& path) {
+  save_snapshot<std::pair<const Key, T>>(path, m.size(), m.begin(),
+                                         m.end());
+}
+
+template <class T, class Allocator>
+void load(vector<T, Allocator>& v, const std::string& path) {
+  SnapshotReader<T> reader(path);
+  vector<T, Allocator> loaded(v.get_allocator());
+  if (reader.count()) {
+    vector<T, Allocator> filled(reader.count(), v.get_allocator());
+    std::memcpy(filled.data(), reader.begin(), reader.count() * sizeof(T));
+    loaded = std::move(filled);
+  }
+  v = std::move(loaded);
+}
+
+// The snapshot has to hold exactly N elements.
+template <class T, size_t N>
+void load(array<T, N>& a, const std::string& path) {
+  SnapshotReader<T> reader(path);
+  if (reader.count() != N)
+    throw std::runtime_error("Snapshot " + path +
+                             " holds another number of elements");
+  if (N) std::memcpy(&*a.begin(), reader.begin(), N * sizeof(T));
+}
+
+template <class T, class Allocator>
+void load(list<T, Allocator>& l, const std::string& path) {
+  SnapshotReader<T> reader(path);
+  list<T, Allocator> loaded(l.get_allocator());
+  for (const T* i = reader.begin(); i != reader.end(); ++i)
+    loaded.push_back(*i);
+  l = std::move(loaded);
+}
+
+template <class T, class Allocator>
+void load(queue<T, Allocator>& q, const std::string& path) {
+  SnapshotReader<T> reader(path);
+  queue<T, Allocator> loaded(q.get_allocator());
+  for (const T* i = reader.begin(); i != reader.end(); ++i) {
+    T value = *i;
+    loaded.push(value);
+  }
+  q = std::move(loaded);
+}
+
+template <class Key, class Compare, class Allocator>
+void load(set<Key, Compare, Allocator>& s, const std::string& path) {
+  SnapshotReader<Key> reader(path);
+  s.assign_sorted(reader.begin(), reader.end());
+}
+
+template <class Key, class Compare, class Allocator>
+void load(multiset<Key, Compare, Allocator>& s, const std::string& path) {
+  SnapshotReader<Key> reader(path);
+  s.assign_sorted(reader.begin(), reader.end());
+}
+
+template <class Key, class T, class Compare, class Allocator>
+void load(map<Key, T, Compare, Allocator>& m, const std::string& path) {
+  SnapshotReader<std::pair<const Key, T>> reader(path);
+  m.assign_sorted(reader.begin(), reader.end());
+}
+}  // namespace containers
@@ -4,53 +4,138 @@
 #include "vector.h"
 
 namespace containers {
-template <class Key>
-class set : public containers::BinaryTree<Key> {
+template <class Key, class Compare = std::less<Key>,
+          class Allocator = std::allocator<Key>>
+class set : public containers::BinaryTree<Key, containers::Identity<Key>,
+                                          Compare, Allocator> {
  public:
   using key_type = Key;
   using value_type = Key;
+  using size_type = size_t;
+  using key_compare = Compare;
+  using allocator_type = Allocator;
+  using tree =
+      containers::BinaryTree<value_type, containers::Identity<value_type>,
+                             Compare, Allocator>;
 
-  using iterator = typename containers::BinaryTree<value_type>::iterator;
-  using const_iterator =
-      typename containers::BinaryTree<value_type>::const_iterator;
-  using node = typename containers::BinaryTree<value_type>::Node;
-
-  set() : containers::BinaryTree<value_type>::BinaryTree() {}
-  explicit set(std::initializer_list<value_type> const& items)
-      : containers::BinaryTree<value_type>::BinaryTree() {
-    typename std::initializer_list<value_type>::const_iterator i =
-        items.begin();
-    while (i != items.end()) {
-      if (!(this->contains(*i))) this->insert(*i);
-      ++i;
-    }
+  using iterator = typename tree::iterator;
+  using const_iterator = typename tree::const_iterator;
+  using node = typename tree::Node;
+  using node_type = typename tree::node_type;
+  using insert_return_type = typename tree::insert_return_type;
+
+  set() : tree::BinaryTree() {}
+  explicit set(const Allocator& alloc) : tree::BinaryTree(alloc) {}
+  explicit set(const Compare& comp, const Allocator& alloc = Allocator())
+      : tree::BinaryTree(comp, alloc) {}
+  // Sorted input is built into a balanced tree in linear time, unsorted input
+  // is inserted one by one. The first of equivalent keys is kept.
+  template <class InputIt>
+  set(InputIt first, InputIt last, const Compare& comp = Compare(),
+      const Allocator& alloc = Allocator())
+      : tree::BinaryTree(comp, alloc) {
+    this->assign_range(first, last, true);
+  }
+  explicit set(std::initializer_list<value_type> const& items,
+               const Allocator& alloc = Allocator())
+      : tree::BinaryTree(alloc) {
+    this->assign_range(items.begin(), items.end(), true);
   }
-  set(const set& s) : containers::BinaryTree<value_type>::BinaryTree(s) {}
-  set(set&& s) : containers::BinaryTree<value_type>::BinaryTree(std::move(s)) {}
+  set(const set& s) : tree::BinaryTree(s) {}
+  set(set&& s) : tree::BinaryTree(std::move(s)) {}
   ~set() {}
 
+  set& operator=(const set& s) {
+    tree::operator=(s);
+    return *this;
+  }
+
+  set& operator=(set&& s) {
+    tree::operator=(std::move(s));
+    return *this;
+  }
+
+  // Replaces the contents with [first, last), in linear time if it is sorted.
+  template <class InputIt>
+  void assign_sorted(InputIt first, InputIt last) {
+    this->assign_range(first, last, true);
+  }
+
+  // Replaces the contents with [first, last) in any order, sorting it on the
+  // threads of the pool. The first of equivalent keys is kept.
+  template <class InputIt>
+  void assign(InputIt first, InputIt last, ThreadPool& threads) {
+    this->assign_range(first, last, true, threads);
+  }
+
+  size_type count(const Key& key) const { return this->contains(key); }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  size_type count(const K& key) const {
+    return this->contains(key);
+  }
+
   void merge(set& other) {
     if (this->empty()) {
       this->swap(other);
     } else {
-      iterator i = other.begin();
-      while (i != other.end()) {
-        if (!(this->contains(*i))) {
-          this->merge_node(i++, other);
-        } else {
-          ++i;
-        }
-      }
+      this->merge_unique(other);
     }
   }
 
+  // Replace the contents with the union, intersection or difference of this
+  // set and other, and leave other empty. The trees are split and joined, so
+  // the cost is O(m log(n / m + 1)) for sizes m <= n, and the nodes that stay
+  // are relinked rather than copied.
+  void set_union(set& other) { this->set_operation(other, tree::kUnion); }
+
+  void set_intersection(set& other) {
+    this->set_operation(other, tree::kIntersection);
+  }
+
+  void set_difference(set& other) {
+    this->set_operation(other, tree::kDifference);
+  }
+
+  void symmetric_difference(set& other) {
+    this->set_operation(other, tree::kSymmetricDifference);
+  }
+
+  // The same, with the two sides of large splits processed on the threads of
+  // the pool.
+  void set_union(set& other, ThreadPool& threads) {
+    this->set_operation(other, tree::kUnion, &threads);
+  }
+
+  void set_intersection(set& other, ThreadPool& threads) {
+    this->set_operation(other, tree::kIntersection, &threads);
+  }
+
+  void set_difference(set& other, ThreadPool& threads) {
+    this->set_operation(other, tree::kDifference, &threads);
+  }
+
+  void symmetric_difference(set& other, ThreadPool& threads) {
+    this->set_operation(other, tree::kSymmetricDifference, &threads);
+  }
+
+  // Constructs the element from args in its node.
+  template <class... Args>
+  std::pair<iterator, bool> emplace(Args&&... args) {
+    return this->emplace_unique(std::forward<Args>(args)...);
+  }
+
+  // The same, with the key looked up next to hint first, as by insert.
   template <class... Args>
-  containers::vector<std::pair<iterator, bool>> emplace(Args&&... args) {
+  iterator emplace_hint(iterator hint, Args&&... args) {
+    return this->emplace_hint_unique(hint, std::forward<Args>(args)...);
+  }
+
+  // Inserts every argument in turn.
+  template <class... Args>
+  containers::vector<std::pair<iterator, bool>> insert_many(Args&&... args) {
     containers::vector<std::pair<iterator, bool>> v;
-    const value_type data[] = {args...};
-    for (const value_type item : data) {
-      v.push_back(this->insert(item));
-    }
+    (v.push_back(this->insert(std::forward<Args>(args))), ...);
     return v;
   }
 };
@@ -2,24 +2,31 @@
 
 #include <cstddef>
 #include <iostream>
+#include <memory>
+
+#include "node_pool.h"
 
 namespace containers {
 
-template <class T>
+template <class T, class Allocator = std::allocator<T>>
 class stack {
  public:
   using value_type = T;
   using reference = T&;
   using const_reference = const reference;
   using size_type = size_t;
+  using allocator_type = Allocator;
   using Node = containers::node<T>;
 
  private:
   Node* head_;
+  NodePool<Node, Allocator> pool_;
 
  public:
   stack() : head_(nullptr){};
 
+  explicit stack(const Allocator& alloc) : head_(nullptr), pool_(alloc){};
+
   explicit stack(std::initializer_list<value_type> const& items) : stack() {
     for (auto i = items.begin(); i != items.end(); ++i) {
       value_type value = *i;
@@ -37,13 +44,14 @@ class stack {
     if (this != &other) {
       std::swap(head_, other.head_);
       other.head_ = nullptr;
+      pool_.swap(other.pool_);
     }
   };
 
   ~stack() { free_stack(); };
 
   void push(const_reference value) {
-    Node* new_head = new Node(value);
+    Node* new_head = pool_.create(value);
     new_head->set_next(nullptr);
     if (!empty()) {
       new_head->set_next(head_);
@@ -53,7 +61,7 @@ class stack {
 
   void pop() {
     Node* tmp = head_->get_next();
-    delete head_;
+    pool_.destroy(head_);
     head_ = tmp;
   };
 
@@ -75,16 +83,20 @@ class stack {
     }
   };
 
+  allocator_type get_allocator() const { return pool_.get_allocator(); }
+
   const_reference top() { return head_->get_value(); };
 
   void swap(stack& other) {
     Node* tmp = head_;
     head_ = other.head_;
     other.head_ = tmp;
+    pool_.swap(other.pool_);
   };
 
   stack& operator=(stack&& other) {
     std::swap(this->head_, other.head_);
+    pool_.swap(other.pool_);
     return *this;
   };
 
@@ -1,20 +1,46 @@
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <iterator>
 #include <list>
 #include <map>
 #include <queue>
+#include <random>
 #include <set>
 #include <stack>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "containers.h"
 #include "gtest/gtest.h"
+#include "tests/copy_counter.h"
+#include "tests/counting_allocator.h"
+#include "tests/aggregate_map_test.cpp"
 #include "tests/array_test.cpp"
+#include "tests/btree_map_test.cpp"
+#include "tests/btree_set_test.cpp"
+#include "tests/concurrent_map_test.cpp"
+#include "tests/counted_multiset_test.cpp"
+#include "tests/flat_map_test.cpp"
+#include "tests/flat_set_test.cpp"
+#include "tests/interval_map_test.cpp"
 #include "tests/list_test.cpp"
 #include "tests/map_test.cpp"
+#include "tests/mapped_flat_map_test.cpp"
 #include "tests/multiset_test.cpp"
+#include "tests/persistent_map_test.cpp"
 #include "tests/queue_test.cpp"
+#include "tests/serialize_test.cpp"
 #include "tests/set_test.cpp"
 #include "tests/stack_test.cpp"
+#include "tests/thread_pool_test.cpp"
+#include "tests/unordered_map_test.cpp"
+#include "tests/unordered_set_test.cpp"
 #include "tests/vector_test.cpp"
 
 int main() {
@@ -0,0 +1,92 @@
+// Concatenates in key order, to check that values are combined in order.
+struct ConcatMonoid {
+  using result_type = std::string;
+  std::string identity() const { return std::string(); }
+  std::string of(const std::string& value) const { return value; }
+  std::string combine(const std::string& a, const std::string& b) const {
+    return a + b;
+  }
+};
+
+TEST(aggregate_map, sum) {
+  containers::aggregate_map<int, long> map{{1, 10}, {2, 20}, {3, 30}, {5, 50}};
+  EXPECT_EQ(map.aggregate(), 110);
+  EXPECT_EQ(map.aggregate(2, 5), 50);
+  EXPECT_EQ(map.aggregate(2, 6), 100);
+  EXPECT_EQ(map.aggregate(4, 5), 0);
+  EXPECT_EQ(map.aggregate(5, 2), 0);
+  EXPECT_FALSE(map.insert_or_assign(2, 25).second);
+  EXPECT_TRUE(map.insert_or_assign(4, 40).second);
+  EXPECT_EQ(map.aggregate(2, 5), 95);
+  EXPECT_TRUE(map.update(3, [](long& value) { value *= 2; }));
+  EXPECT_FALSE(map.update(7, [](long& value) { value *= 2; }));
+  EXPECT_EQ(map.at(3), 60);
+  EXPECT_THROW(map.at(7), std::out_of_range);
+  EXPECT_EQ(map.aggregate(), 185);
+  EXPECT_EQ(map.erase(1), 1U);
+  EXPECT_EQ(map.erase(1), 0U);
+  map.erase(map.find(5));
+  EXPECT_EQ(map.aggregate(), 125);
+  map.clear();
+  EXPECT_EQ(map.aggregate(), 0);
+}
+
+TEST(aggregate_map, min_max_count) {
+  containers::aggregate_map<int, double, containers::MinMonoid<double>> min;
+  containers::aggregate_map<int, int, containers::MaxMonoid<int>> max;
+  containers::aggregate_map<int, int, containers::CountMonoid<int>> count;
+  EXPECT_EQ(min.aggregate(), std::numeric_limits<double>::infinity());
+  EXPECT_EQ(max.aggregate(), std::numeric_limits<int>::lowest());
+  for (int key = 0; key < 100; ++key) {
+    min.insert(key, (key - 40) * (key - 40));
+    max.insert(key, -(key - 70) * (key - 70));
+    count.insert(key, key);
+  }
+  EXPECT_EQ(min.aggregate(), 0);
+  EXPECT_EQ(min.aggregate(0, 30), 121);
+  EXPECT_EQ(max.aggregate(), 0);
+  EXPECT_EQ(max.aggregate(80, 90), -100);
+  EXPECT_EQ(count.aggregate(10, 20), 10U);
+  EXPECT_EQ(count.aggregate(-5, 200), 100U);
+}
+
+TEST(aggregate_map, matches_brute_force) {
+  std::mt19937 gen(23);
+  std::uniform_int_distribution<int> key(0, 499);
+  containers::aggregate_map<int, std::string, ConcatMonoid> map;
+  std::map<int, std::string> std_map;
+  for (int step = 0; step < 5000; ++step) {
+    int k = key(gen);
+    std::string value(1, static_cast<char>('a' + step % 26));
+    if (step % 5 == 4) {
+      EXPECT_EQ(map.erase(k), std_map.erase(k));
+    } else if (step % 5 == 3) {
+      EXPECT_EQ(map.update(k, [](std::string& v) { v += "!"; }),
+                std_map.count(k) == 1);
+      if (std_map.count(k)) std_map[k] += "!";
+    } else {
+      map.insert_or_assign(k, value);
+      std_map[k] = value;
+    }
+    if (step % 100 != 0) continue;
+    containers::aggregate_map<int, std::string, ConcatMonoid> copy(map);
+    for (int query = 0; query < 20; ++query) {
+      int lo = key(gen);
+      int hi = lo + key(gen) / 4;
+      std::string expected;
+      for (std::map<int, std::string>::iterator i = std_map.lower_bound(lo);
+           i != std_map.end() && i->first < hi; ++i)
+        expected += i->second;
+      EXPECT_EQ(map.aggregate(lo, hi), expected);
+      EXPECT_EQ(copy.aggregate(lo, hi), expected);
+    }
+  }
+  std::string all;
+  for (const std::pair<const int, std::string>& item : std_map)
+    all += item.second;
+  EXPECT_EQ(map.aggregate(), all);
+  containers::aggregate_map<int, std::string, ConcatMonoid> built(
+      std_map.begin(), std_map.end());
+  EXPECT_EQ(built.aggregate(), all);
+  EXPECT_EQ(built.aggregate(100, 300), map.aggregate(100, 300));
+}
@@ -0,0 +1,137 @@
+class BtreeMapTest : public ::testing::Test {
+ protected:
+  containers::btree_map<int, std::string> map{
+      std::pair<int, std::string>{3, "pomodoro"},
+      std::pair<int, std::string>{-1, "cantaloupes"},
+      std::pair<int, std::string>{1, "focaccia"},
+      std::pair<int, std::string>{2, "chives"},
+      std::pair<int, std::string>{11, "chile peppers"},
+      std::pair<int, std::string>{-1, "marmalade"}};
+  std::map<int, std::string> std_map{
+      std::pair<int, std::string>{3, "pomodoro"},
+      std::pair<int, std::string>{-1, "cantaloupes"},
+      std::pair<int, std::string>{1, "focaccia"},
+      std::pair<int, std::string>{2, "chives"},
+      std::pair<int, std::string>{11, "chile peppers"},
+      std::pair<int, std::string>{-1, "marmalade"}};
+  void eq_map(const containers::btree_map<int, std::string>& map,
+              const std::map<int, std::string>& std_map);
+};
+
+void BtreeMapTest::eq_map(const containers::btree_map<int, std::string>& map,
+                          const std::map<int, std::string>& std_map) {
+  EXPECT_EQ(map.size(), std_map.size());
+  containers::btree_map<int, std::string>::iterator i = map.begin();
+  for (const std::pair<const int, std::string>& value : std_map) {
+    EXPECT_EQ(i->first, value.first);
+    EXPECT_EQ(i->second, value.second);
+    ++i;
+  }
+  EXPECT_EQ(i, map.end());
+}
+
+TEST_F(BtreeMapTest, init_constructor_insert) {
+  eq_map(map, std_map);
+  EXPECT_FALSE(map.insert(3, "chives").second);
+  EXPECT_TRUE(map.insert({4, "chives"}).second);
+  std_map.insert({4, "chives"});
+  eq_map(map, std_map);
+}
+
+TEST_F(BtreeMapTest, element_access) {
+  EXPECT_EQ(map.at(3), "pomodoro");
+  EXPECT_THROW(map.at(4), std::out_of_range);
+  map[4] = "beans";
+  map[3] = "squid";
+  std_map[4] = "beans";
+  std_map[3] = "squid";
+  eq_map(map, std_map);
+  map.insert_or_assign(1, "dates");
+  map.insert_or_assign(5, "sazon");
+  std_map.insert_or_assign(1, "dates");
+  std_map.insert_or_assign(5, "sazon");
+  eq_map(map, std_map);
+  (*map.find(2)).second = "lettuce";
+  EXPECT_EQ(map.at(2), "lettuce");
+}
+
+TEST_F(BtreeMapTest, copy_merge) {
+  containers::btree_map<int, std::string> copy(map);
+  eq_map(copy, std_map);
+  containers::btree_map<int, std::string> other{
+      std::pair<int, std::string>{3, "beans"},
+      std::pair<int, std::string>{4, "beans"}};
+  map.merge(other);
+  std_map.insert({4, "beans"});
+  eq_map(map, std_map);
+  EXPECT_EQ(other.size(), 1);
+  EXPECT_EQ(other.at(3), "beans");
+}
+
+TEST(btree_map, random_insert_erase) {
+  containers::btree_map<int, int> map;
+  std::map<int, int> std_map;
+  std::mt19937 random(11);
+  for (int i = 0; i < 100000; ++i) {
+    int key = static_cast<int>(random() % 30000);
+    if (random() % 2 == 0) {
+      containers::btree_map<int, int>::iterator j = map.find(key);
+      EXPECT_EQ(j != map.end(), std_map.erase(key) == 1);
+      if (j != map.end()) map.erase(j);
+    } else {
+      map[key] += i;
+      std_map[key] += i;
+    }
+  }
+  EXPECT_EQ(map.size(), std_map.size());
+  containers::btree_map<int, int>::iterator j = map.begin();
+  for (const std::pair<const int, int>& value : std_map) {
+    EXPECT_EQ((*j).first, value.first);
+    EXPECT_EQ((*j).second, value.second);
+    ++j;
+  }
+  EXPECT_EQ(j, map.end());
+}
+
+TEST(btree_map, transparent_lookup) {
+  containers::btree_map<std::string, int, std::less<>> map;
+  for (int i = 0; i < 1000; ++i) map.insert(std::to_string(i), i);
+  EXPECT_EQ(map.at("512"), 512);
+  EXPECT_EQ(map.at(std::string_view("7")), 7);
+  EXPECT_EQ(map.count("1000"), 0);
+  EXPECT_THROW(map.at("1000"), std::out_of_range);
+}
+
+TEST(btree_map, in_place_construction) {
+  containers::btree_map<int, CopyCounter> map;
+  CopyCounter::reset();
+  EXPECT_TRUE(map.try_emplace(1, 10).second);
+  EXPECT_TRUE(map.try_emplace(2, 7, 13).second);
+  EXPECT_EQ(CopyCounter::constructed, 2);
+  EXPECT_EQ(CopyCounter::copied + CopyCounter::moved, 0);
+  CopyCounter::reset();
+  EXPECT_FALSE(map.try_emplace(1, 99).second);
+  EXPECT_EQ(CopyCounter::constructed, 0);
+  EXPECT_TRUE(map.emplace(3, 30).second);
+  EXPECT_FALSE(map.emplace(3, 31).second);
+  EXPECT_EQ(CopyCounter::copied, 0);
+  EXPECT_EQ(CopyCounter::moved, 1);
+  EXPECT_EQ(map.at(1).value, 10);
+  EXPECT_EQ(map.at(2).value, 20);
+  EXPECT_EQ(map.at(3).value, 30);
+}
+
+TEST(btree_map, insert_many) {
+  containers::btree_map<int, int> map;
+  containers::vector<std::pair<containers::btree_map<int, int>::iterator,
+                               bool>>
+      res = map.insert_many(std::pair<const int, int>(1, 10),
+                            std::pair<const int, int>(2, 20),
+                            std::pair<const int, int>(1, 30));
+  ASSERT_EQ(res.size(), 3U);
+  EXPECT_TRUE(res[0].second);
+  EXPECT_TRUE(res[1].second);
+  EXPECT_FALSE(res[2].second);
+  EXPECT_EQ(map.size(), 2U);
+  EXPECT_EQ(map.at(1), 10);
+}
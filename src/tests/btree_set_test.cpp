@@ -0,0 +1,130 @@
+class BtreeSetTest : public ::testing::Test {
+ protected:
+  containers::btree_set<int> set{8,  20,  -14, -18, 1, -18, -8,
+                                 -20, -14, -12, -9, 15, -19, -17,
+                                 -3,  7,   4,   -12, -17, -14, -20};
+  std::set<int> std_set{8,  20,  -14, -18, 1, -18, -8,  -20, -14, -12, -9,
+                        15, -19, -17, -3,  7, 4,   -12, -17, -14, -20};
+  void eq_set(const containers::btree_set<int>& set,
+              const std::set<int>& std_set);
+};
+
+void BtreeSetTest::eq_set(const containers::btree_set<int>& set,
+                          const std::set<int>& std_set) {
+  EXPECT_EQ(set.size(), std_set.size());
+  containers::btree_set<int>::iterator i1 = set.begin();
+  for (int value : std_set) EXPECT_EQ(*(i1++), value);
+  EXPECT_EQ(i1, set.end());
+  std::set<int>::reverse_iterator i2 = std_set.rbegin();
+  for (i1 = set.end(); i1 != set.begin(); ++i2) EXPECT_EQ(*(--i1), *i2);
+}
+
+TEST(btree_set, default_constructor_empty) {
+  containers::btree_set<int> set;
+  EXPECT_TRUE(set.empty());
+  EXPECT_EQ(set.begin(), set.end());
+  EXPECT_EQ(set.find(1), set.end());
+  EXPECT_EQ(set.lower_bound(1), set.end());
+}
+
+TEST_F(BtreeSetTest, init_constructor_insert) { eq_set(set, std_set); }
+
+TEST_F(BtreeSetTest, copy_move) {
+  containers::btree_set<int> copy(set);
+  eq_set(copy, std_set);
+  containers::btree_set<int> moved(std::move(copy));
+  eq_set(moved, std_set);
+  copy = std::move(moved);
+  eq_set(copy, std_set);
+}
+
+TEST_F(BtreeSetTest, find_bounds) {
+  for (int key = -22; key < 22; ++key) {
+    EXPECT_EQ(set.contains(key), std_set.count(key) == 1);
+    EXPECT_EQ(set.count(key), std_set.count(key));
+    if (std_set.lower_bound(key) == std_set.end())
+      EXPECT_EQ(set.lower_bound(key), set.end());
+    else
+      EXPECT_EQ(*set.lower_bound(key), *std_set.lower_bound(key));
+    if (std_set.upper_bound(key) == std_set.end())
+      EXPECT_EQ(set.upper_bound(key), set.end());
+    else
+      EXPECT_EQ(*set.upper_bound(key), *std_set.upper_bound(key));
+  }
+}
+
+TEST_F(BtreeSetTest, merge) {
+  containers::btree_set<int> other{1, 2, 3, 100};
+  set.merge(other);
+  std_set.insert({2, 3, 100});
+  eq_set(set, std_set);
+  EXPECT_EQ(other.size(), 1);
+  EXPECT_EQ(*other.begin(), 1);
+}
+
+TEST(btree_set, random_insert_erase) {
+  containers::btree_set<int> set;
+  std::set<int> std_set;
+  std::mt19937 random(7);
+  for (int i = 0; i < 100000; ++i) {
+    int key = static_cast<int>(random() % 20000);
+    if (random() % 3 == 0) {
+      containers::btree_set<int>::iterator j = set.find(key);
+      EXPECT_EQ(j != set.end(), std_set.erase(key) == 1);
+      if (j != set.end()) set.erase(j);
+    } else {
+      EXPECT_EQ(set.insert(key).second, std_set.insert(key).second);
+    }
+  }
+  EXPECT_EQ(set.size(), std_set.size());
+  containers::btree_set<int>::iterator i1 = set.begin();
+  for (int value : std_set) EXPECT_EQ(*(i1++), value);
+  EXPECT_EQ(i1, set.end());
+  while (!set.empty()) set.erase(set.begin());
+  EXPECT_EQ(set.begin(), set.end());
+}
+
+TEST(btree_set, strings) {
+  containers::btree_set<std::string, std::less<>> set;
+  std::set<std::string> std_set;
+  for (int i = 0; i < 5000; ++i) {
+    set.insert(std::to_string(i * 7919 % 5000));
+    std_set.insert(std::to_string(i * 7919 % 5000));
+  }
+  for (int i = 0; i < 5000; i += 2) set.erase(set.find(std::to_string(i)));
+  for (int i = 0; i < 5000; i += 2) std_set.erase(std::to_string(i));
+  EXPECT_TRUE(set.contains("1"));
+  EXPECT_FALSE(set.contains(std::string_view("2")));
+  EXPECT_EQ(set.size(), std_set.size());
+  containers::btree_set<std::string, std::less<>>::iterator i = set.begin();
+  for (const std::string& value : std_set) EXPECT_EQ(*(i++), value);
+}
+
+TEST(btree_set, allocator) {
+  long live = 0;
+  {
+    containers::btree_set<std::string, std::less<std::string>,
+                          CountingAllocator<std::string>>
+        set(CountingAllocator<std::string>{&live});
+    for (int i = 0; i < 1000; ++i) set.insert(std::to_string(i));
+    EXPECT_GT(live, 0);
+    set.clear();
+    EXPECT_EQ(live, 1);
+  }
+  EXPECT_EQ(live, 0);
+}
+
+TEST(btree_set, emplace_insert_many) {
+  containers::btree_set<std::string> set;
+  EXPECT_TRUE(set.emplace(3, 'a').second);
+  EXPECT_FALSE(set.emplace("aaa").second);
+  EXPECT_TRUE(set.contains("aaa"));
+  containers::vector<std::pair<containers::btree_set<std::string>::iterator,
+                               bool>>
+      res = set.insert_many("b", "aaa", "c");
+  ASSERT_EQ(res.size(), 3U);
+  EXPECT_TRUE(res[0].second);
+  EXPECT_FALSE(res[1].second);
+  EXPECT_TRUE(res[2].second);
+  EXPECT_EQ(set.size(), 3U);
+}
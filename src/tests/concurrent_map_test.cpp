@@ -0,0 +1,55 @@
+TEST(concurrent_map, single_thread) {
+  containers::concurrent_map<int, std::string> map(6);
+  EXPECT_EQ(map.shard_count(), 8U);
+  EXPECT_TRUE(map.empty());
+  EXPECT_TRUE(map.insert(1, "one"));
+  EXPECT_FALSE(map.insert(1, "uno"));
+  EXPECT_EQ(*map.find(1), "one");
+  EXPECT_FALSE(map.insert_or_assign(1, "uno"));
+  EXPECT_TRUE(map.insert_or_assign(2, "two"));
+  EXPECT_EQ(*map.find(1), "uno");
+  EXPECT_FALSE(map.find(3).has_value());
+  EXPECT_TRUE(map.contains(2));
+  EXPECT_EQ(map.size(), 2U);
+  EXPECT_TRUE(map.compute(2, [](std::string& value) { value += "!"; }));
+  EXPECT_FALSE(map.compute(3, [](std::string& value) { value += "!"; }));
+  EXPECT_EQ(*map.find(2), "two!");
+  EXPECT_TRUE(map.upsert(3, "three", [](std::string& value) { value = "?"; }));
+  EXPECT_FALSE(map.upsert(3, "drei", [](std::string& value) { value += "3"; }));
+  EXPECT_EQ(*map.find(3), "three3");
+  EXPECT_EQ(map.erase(2), 1U);
+  EXPECT_EQ(map.erase(2), 0U);
+  std::map<int, std::string> seen;
+  map.for_each([&seen](const std::pair<const int, std::string>& item) {
+    seen.insert(item);
+  });
+  EXPECT_EQ(seen, (std::map<int, std::string>{{1, "uno"}, {3, "three3"}}));
+  map.clear();
+  EXPECT_TRUE(map.empty());
+}
+
+TEST(concurrent_map, counters_from_many_threads) {
+  containers::concurrent_map<int, long> map(4);
+  const int kThreads = 8;
+  const int kKeys = 64;
+  const int kRounds = 2000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&map, t] {
+      for (int i = 0; i < kRounds; ++i) {
+        int key = (i * 7 + t) % kKeys;
+        map.upsert(key, 1L, [](long& count) { ++count; });
+        if (i % 16 == 0) map.erase(kKeys + t);
+        if (i % 16 == 8) map.insert_or_assign(kKeys + t, long(i));
+        map.contains(key);
+      }
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+  long total = 0;
+  map.for_each([&total](const std::pair<const int, long>& item) {
+    if (item.first < kKeys) total += item.second;
+  });
+  EXPECT_EQ(total, long(kThreads) * kRounds);
+  EXPECT_EQ(map.size(), size_t(kKeys + kThreads));
+}
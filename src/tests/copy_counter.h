@@ -0,0 +1,36 @@
+#pragma once
+
+// Value that counts how often it is constructed, copied and moved, to check
+// that containers build their elements in place.
+struct CopyCounter {
+  static int constructed;
+  static int copied;
+  static int moved;
+
+  int value;
+
+  explicit CopyCounter(int v = 0) : value(v) { ++constructed; }
+  CopyCounter(int a, int b) : value(a + b) { ++constructed; }
+  CopyCounter(const CopyCounter& other) : value(other.value) { ++copied; }
+  CopyCounter(CopyCounter&& other) : value(other.value) { ++moved; }
+  CopyCounter& operator=(const CopyCounter& other) {
+    value = other.value;
+    ++copied;
+    return *this;
+  }
+  CopyCounter& operator=(CopyCounter&& other) {
+    value = other.value;
+    ++moved;
+    return *this;
+  }
+
+  bool operator<(const CopyCounter& other) const {
+    return value < other.value;
+  }
+
+  static void reset() { constructed = copied = moved = 0; }
+};
+
+inline int CopyCounter::constructed = 0;
+inline int CopyCounter::copied = 0;
+inline int CopyCounter::moved = 0;
@@ -0,0 +1,169 @@
+class CountedMultisetTest : public ::testing::Test {
+ protected:
+  containers::counted_multiset<int> multiset{
+      8,   20, -14, -18, 1,  -18, -8,  -20, -14, -12, -9,
+      15, -19, -17, -3,  7,  4,   -12, -17, -14, -20};
+  std::multiset<int> std_multiset{8,   20, -14, -18, 1,  -18, -8,
+                                  -20, -14, -12, -9, 15, -19, -17,
+                                  -3,  7,   4,  -12, -17, -14, -20};
+  void eq_set(const containers::counted_multiset<int>& multiset,
+              const std::multiset<int>& std_multiset);
+};
+
+void CountedMultisetTest::eq_set(
+    const containers::counted_multiset<int>& multiset,
+    const std::multiset<int>& std_multiset) {
+  ASSERT_EQ(multiset.size(), std_multiset.size());
+  containers::counted_multiset<int>::iterator i1 = multiset.begin();
+  std::multiset<int>::const_iterator i2 = std_multiset.begin();
+  while (i2 != std_multiset.end()) {
+    EXPECT_EQ(*i1, *i2);
+    ++i1;
+    ++i2;
+  }
+  EXPECT_TRUE(i1 == multiset.end());
+  while (i2 != std_multiset.begin()) {
+    --i1;
+    --i2;
+    EXPECT_EQ(*i1, *i2);
+  }
+  EXPECT_TRUE(i1 == multiset.begin());
+}
+
+TEST(counted_multiset, default_constructor_empty) {
+  containers::counted_multiset<int> multiset;
+  EXPECT_TRUE(multiset.empty());
+  EXPECT_EQ(multiset.size(), 0U);
+  EXPECT_TRUE(multiset.begin() == multiset.end());
+}
+
+TEST_F(CountedMultisetTest, init_constructor_insert) {
+  eq_set(multiset, std_multiset);
+  EXPECT_EQ(multiset.distinct_size(), 15U);
+}
+
+TEST_F(CountedMultisetTest, copy_move) {
+  containers::counted_multiset<int> copy(multiset);
+  eq_set(copy, std_multiset);
+  containers::counted_multiset<int> moved(std::move(copy));
+  eq_set(moved, std_multiset);
+  EXPECT_TRUE(copy.empty());
+  copy = std::move(moved);
+  eq_set(copy, std_multiset);
+}
+
+TEST_F(CountedMultisetTest, count) {
+  for (int key = -21; key <= 21; ++key)
+    EXPECT_EQ(multiset.count(key), std_multiset.count(key));
+  EXPECT_TRUE(multiset.contains(-14));
+  EXPECT_FALSE(multiset.contains(0));
+}
+
+TEST_F(CountedMultisetTest, insert_many) {
+  containers::counted_multiset<int>::iterator i = multiset.insert(-14, 3);
+  for (int k = 0; k < 3; ++k) std_multiset.insert(-14);
+  EXPECT_EQ(*i, -14);
+  EXPECT_EQ(i.repeats(), 6U);
+  multiset.insert(0, 2);
+  std_multiset.insert(0);
+  std_multiset.insert(0);
+  eq_set(multiset, std_multiset);
+}
+
+TEST_F(CountedMultisetTest, insert_zero_adds_nothing) {
+  EXPECT_TRUE(multiset.insert(5, 0) == multiset.lower_bound(5));
+  EXPECT_FALSE(multiset.contains(5));
+  EXPECT_EQ(*multiset.insert(-14, 0), -14);
+  eq_set(multiset, std_multiset);
+  containers::counted_multiset<int> empty;
+  EXPECT_TRUE(empty.insert(1, 0) == empty.end());
+  EXPECT_TRUE(empty.begin() == empty.end());
+  EXPECT_EQ(empty.distinct_size(), 0U);
+}
+
+TEST_F(CountedMultisetTest, increment_decrement) {
+  containers::counted_multiset<int>::iterator i = multiset.find(-18);
+  multiset.increment(i, 2);
+  std_multiset.insert(-18);
+  std_multiset.insert(-18);
+  eq_set(multiset, std_multiset);
+  multiset.decrement(i, 4);
+  std_multiset.erase(-18);
+  eq_set(multiset, std_multiset);
+  EXPECT_FALSE(multiset.contains(-18));
+  EXPECT_EQ(multiset.distinct_size(), 14U);
+}
+
+TEST_F(CountedMultisetTest, decrement_more_than_present_throws) {
+  containers::counted_multiset<int>::iterator i = multiset.find(-14);
+  EXPECT_THROW(multiset.decrement(i, 4), std::invalid_argument);
+  EXPECT_EQ(multiset.count(-14), 3U);
+  eq_set(multiset, std_multiset);
+}
+
+TEST_F(CountedMultisetTest, erase) {
+  multiset.erase(multiset.find(-20));
+  std_multiset.erase(std_multiset.find(-20));
+  multiset.erase(multiset.find(8));
+  std_multiset.erase(std_multiset.find(8));
+  eq_set(multiset, std_multiset);
+  EXPECT_EQ(multiset.erase(-14), 3U);
+  EXPECT_EQ(multiset.erase(-14), 0U);
+  std_multiset.erase(-14);
+  eq_set(multiset, std_multiset);
+}
+
+TEST_F(CountedMultisetTest, bounds) {
+  for (int key = -21; key <= 21; ++key) {
+    std::pair<containers::counted_multiset<int>::iterator,
+              containers::counted_multiset<int>::iterator>
+        range = multiset.equal_range(key);
+    size_t n = 0;
+    for (; range.first != range.second; ++range.first) {
+      EXPECT_EQ(*range.first, key);
+      ++n;
+    }
+    EXPECT_EQ(n, std_multiset.count(key));
+    containers::counted_multiset<int>::iterator lower =
+        multiset.lower_bound(key);
+    std::multiset<int>::iterator std_lower = std_multiset.lower_bound(key);
+    if (std_lower == std_multiset.end())
+      EXPECT_TRUE(lower == multiset.end());
+    else
+      EXPECT_EQ(*lower, *std_lower);
+  }
+}
+
+TEST_F(CountedMultisetTest, merge_swap) {
+  containers::counted_multiset<int> other{-14, 0, 0, 30};
+  multiset.merge(other);
+  for (int key : {-14, 0, 0, 30}) std_multiset.insert(key);
+  EXPECT_TRUE(other.empty());
+  eq_set(multiset, std_multiset);
+  other.swap(multiset);
+  eq_set(other, std_multiset);
+  EXPECT_TRUE(multiset.empty());
+}
+
+TEST(counted_multiset, histogram_matches_std) {
+  std::mt19937 gen(14);
+  std::uniform_int_distribution<int> key(0, 63);
+  containers::counted_multiset<int> counted;
+  std::multiset<int> expected;
+  for (int step = 0; step < 20000; ++step) {
+    int k = key(gen);
+    if (step % 3 == 2 && counted.contains(k)) {
+      counted.erase(counted.find(k));
+      expected.erase(expected.find(k));
+    } else {
+      counted.insert(k);
+      expected.insert(k);
+    }
+  }
+  ASSERT_EQ(counted.size(), expected.size());
+  EXPECT_LE(counted.distinct_size(), 64U);
+  for (int k = 0; k < 64; ++k) EXPECT_EQ(counted.count(k), expected.count(k));
+  containers::counted_multiset<int>::iterator i = counted.begin();
+  for (int k : expected) EXPECT_EQ(*i++, k);
+  EXPECT_TRUE(i == counted.end());
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+// Stateful allocator that counts live allocations of its group, and all
+// allocations if given a second counter. Copies and rebinds share the
+// counters and compare equal.
+template <class T>
+class CountingAllocator {
+ public:
+  using value_type = T;
+
+  explicit CountingAllocator(long* live, long* total = nullptr)
+      : live_(live), total_(total) {}
+  template <class U>
+  CountingAllocator(const CountingAllocator<U>& other)
+      : live_(other.live_), total_(other.total_) {}
+
+  T* allocate(size_t n) {
+    ++*live_;
+    if (total_) ++*total_;
+    return std::allocator<T>().allocate(n);
+  }
+
+  void deallocate(T* pointer, size_t n) {
+    --*live_;
+    std::allocator<T>().deallocate(pointer, n);
+  }
+
+  template <class U>
+  bool operator==(const CountingAllocator<U>& other) const {
+    return live_ == other.live_;
+  }
+  template <class U>
+  bool operator!=(const CountingAllocator<U>& other) const {
+    return live_ != other.live_;
+  }
+
+ private:
+  template <class U>
+  friend class CountingAllocator;
+
+  long* live_;
+  long* total_;
+};
@@ -0,0 +1,98 @@
+class FlatMapTest : public ::testing::Test {
+ protected:
+  containers::flat_map<int, std::string> map{
+      std::pair<int, std::string>{3, "pomodoro"},
+      std::pair<int, std::string>{-1, "cantaloupes"},
+      std::pair<int, std::string>{1, "focaccia"},
+      std::pair<int, std::string>{2, "chives"},
+      std::pair<int, std::string>{11, "chile peppers"},
+      std::pair<int, std::string>{-1, "marmalade"}};
+  std::map<int, std::string> std_map{
+      std::pair<int, std::string>{3, "pomodoro"},
+      std::pair<int, std::string>{-1, "cantaloupes"},
+      std::pair<int, std::string>{1, "focaccia"},
+      std::pair<int, std::string>{2, "chives"},
+      std::pair<int, std::string>{11, "chile peppers"},
+      std::pair<int, std::string>{-1, "marmalade"}};
+  void eq_map(const containers::flat_map<int, std::string>& map,
+              const std::map<int, std::string>& std_map);
+};
+
+void FlatMapTest::eq_map(const containers::flat_map<int, std::string>& map,
+                         const std::map<int, std::string>& std_map) {
+  EXPECT_EQ(map.size(), std_map.size());
+  containers::flat_map<int, std::string>::iterator i = map.begin();
+  for (const std::pair<const int, std::string>& value : std_map) {
+    EXPECT_EQ(i->first, value.first);
+    EXPECT_EQ(i->second, value.second);
+    ++i;
+  }
+  EXPECT_EQ(i, map.end());
+}
+
+TEST_F(FlatMapTest, init_constructor_insert) {
+  eq_map(map, std_map);
+  EXPECT_FALSE(map.insert(3, "chives").second);
+  EXPECT_TRUE(map.insert({4, "chives"}).second);
+  EXPECT_TRUE(map.insert({-5, "beans"}).second);
+  std_map.insert({4, "chives"});
+  std_map.insert({-5, "beans"});
+  eq_map(map, std_map);
+}
+
+TEST_F(FlatMapTest, element_access) {
+  EXPECT_EQ(map.at(3), "pomodoro");
+  EXPECT_THROW(map.at(4), std::out_of_range);
+  map[4] = "beans";
+  map[3] = "squid";
+  std_map[4] = "beans";
+  std_map[3] = "squid";
+  eq_map(map, std_map);
+  map.insert_or_assign(1, "dates");
+  map.insert_or_assign(5, "sazon");
+  std_map.insert_or_assign(1, "dates");
+  std_map.insert_or_assign(5, "sazon");
+  eq_map(map, std_map);
+  (*map.find(2)).second = "lettuce";
+  EXPECT_EQ(map.at(2), "lettuce");
+}
+
+TEST_F(FlatMapTest, erase_copy_move) {
+  map.erase(map.find(2));
+  map.erase(map.begin());
+  std_map.erase(2);
+  std_map.erase(std_map.begin());
+  containers::flat_map<int, std::string> copy(map);
+  eq_map(copy, std_map);
+  containers::flat_map<int, std::string> moved(std::move(copy));
+  eq_map(moved, std_map);
+}
+
+TEST(flat_map, range_constructor) {
+  std::vector<std::pair<int, int>> items;
+  std::mt19937 random(5);
+  for (int i = 0; i < 20000; ++i)
+    items.push_back({static_cast<int>(random() % 5000), i});
+  containers::flat_map<int, int> map(items.begin(), items.end());
+  std::map<int, int> std_map(items.begin(), items.end());
+  EXPECT_EQ(map.size(), std_map.size());
+  containers::flat_map<int, int>::iterator i = map.begin();
+  for (const std::pair<const int, int>& value : std_map) {
+    EXPECT_EQ((*i).first, value.first);
+    EXPECT_EQ((*i).second, value.second);
+    ++i;
+  }
+}
+
+TEST(flat_map, allocator) {
+  long live = 0;
+  {
+    containers::flat_map<int, int, std::less<int>,
+                         CountingAllocator<std::pair<const int, int>>>
+        map(CountingAllocator<std::pair<const int, int>>{&live});
+    for (int i = 0; i < 100; ++i) map[i] = i;
+    EXPECT_EQ(live, 2);
+    EXPECT_EQ(map.at(42), 42);
+  }
+  EXPECT_EQ(live, 0);
+}
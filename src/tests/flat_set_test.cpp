@@ -0,0 +1,82 @@
+class FlatSetTest : public ::testing::Test {
+ protected:
+  containers::flat_set<int> set{8,   20,  -14, -18, 1,  -18, -8,
+                                -20, -14, -12, -9,  15, -19, -17,
+                                -3,  7,   4,   -12, -17, -14, -20};
+  std::set<int> std_set{8,  20,  -14, -18, 1, -18, -8,  -20, -14, -12, -9,
+                        15, -19, -17, -3,  7, 4,   -12, -17, -14, -20};
+  void eq_set(const containers::flat_set<int>& set,
+              const std::set<int>& std_set);
+};
+
+void FlatSetTest::eq_set(const containers::flat_set<int>& set,
+                         const std::set<int>& std_set) {
+  EXPECT_EQ(set.size(), std_set.size());
+  containers::flat_set<int>::iterator i = set.begin();
+  for (int value : std_set) EXPECT_EQ(*(i++), value);
+  EXPECT_EQ(i, set.end());
+}
+
+TEST(flat_set, default_constructor_empty) {
+  containers::flat_set<int> set;
+  EXPECT_TRUE(set.empty());
+  EXPECT_EQ(set.begin(), set.end());
+  EXPECT_EQ(set.find(1), set.end());
+  EXPECT_EQ(set.lower_bound(1), set.end());
+}
+
+TEST_F(FlatSetTest, init_constructor) { eq_set(set, std_set); }
+
+TEST_F(FlatSetTest, copy_move) {
+  containers::flat_set<int> copy(set);
+  eq_set(copy, std_set);
+  containers::flat_set<int> moved(std::move(copy));
+  eq_set(moved, std_set);
+  copy = std::move(moved);
+  eq_set(copy, std_set);
+}
+
+TEST_F(FlatSetTest, insert_erase) {
+  EXPECT_FALSE(set.insert(8).second);
+  EXPECT_TRUE(set.insert(9).second);
+  EXPECT_EQ(*set.insert(-30).first, -30);
+  EXPECT_TRUE(set.insert(30).second);
+  set.erase(set.find(-14));
+  set.erase(set.begin());
+  std_set.insert({9, 30});
+  std_set.erase(-14);
+  eq_set(set, std_set);
+}
+
+TEST_F(FlatSetTest, find_bounds) {
+  for (int key = -22; key < 22; ++key) {
+    EXPECT_EQ(set.contains(key), std_set.count(key) == 1);
+    EXPECT_EQ(set.count(key), std_set.count(key));
+    if (std_set.lower_bound(key) == std_set.end())
+      EXPECT_EQ(set.lower_bound(key), set.end());
+    else
+      EXPECT_EQ(*set.lower_bound(key), *std_set.lower_bound(key));
+    if (std_set.upper_bound(key) == std_set.end())
+      EXPECT_EQ(set.upper_bound(key), set.end());
+    else
+      EXPECT_EQ(*set.upper_bound(key), *std_set.upper_bound(key));
+  }
+}
+
+TEST(flat_set, range_constructor) {
+  std::vector<int> items(20000);
+  std::mt19937 random(3);
+  for (int& item : items) item = static_cast<int>(random() % 5000);
+  containers::flat_set<int, std::greater<int>> set(items.begin(), items.end());
+  std::set<int, std::greater<int>> std_set(items.begin(), items.end());
+  EXPECT_EQ(set.size(), std_set.size());
+  containers::flat_set<int, std::greater<int>>::iterator i = set.begin();
+  for (int value : std_set) EXPECT_EQ(*(i++), value);
+}
+
+TEST(flat_set, transparent_lookup) {
+  containers::flat_set<std::string, std::less<>> set{"one", "two", "three"};
+  EXPECT_TRUE(set.contains("two"));
+  EXPECT_EQ(*set.find(std::string_view("one")), "one");
+  EXPECT_EQ(set.count("four"), 0);
+}
@@ -0,0 +1,101 @@
+using IntervalMap = containers::interval_map<int, std::string>;
+
+// Returns the keys of the intervals the iterators point to.
+std::vector<std::pair<int, int>> interval_keys(
+    const containers::vector<IntervalMap::iterator>& found) {
+  std::vector<std::pair<int, int>> keys;
+  for (size_t i = 0; i < found.size(); ++i) {
+    IntervalMap::iterator it = found.data()[i];
+    keys.push_back(std::get<0>(*it));
+  }
+  return keys;
+}
+
+TEST(interval_map, insert_find_erase) {
+  IntervalMap map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_TRUE(map.insert(10, 20, "a").second);
+  EXPECT_FALSE(map.insert(10, 20, "b").second);
+  EXPECT_TRUE(map.insert(10, 15, "c").second);
+  EXPECT_EQ(map.at(10, 20), "a");
+  EXPECT_FALSE(map.insert_or_assign(10, 20, "d").second);
+  EXPECT_EQ(map.at(10, 20), "d");
+  EXPECT_THROW(map.at(10, 30), std::out_of_range);
+  EXPECT_THROW(map.insert(5, 5, "e"), std::invalid_argument);
+  EXPECT_THROW(map.insert(6, 5, "e"), std::invalid_argument);
+  EXPECT_EQ(map.size(), 2U);
+  EXPECT_TRUE(map.contains(10, 15));
+  EXPECT_EQ(std::get<0>(*map.begin()), std::make_pair(10, 15));
+  EXPECT_EQ(map.erase(10, 15), 1U);
+  EXPECT_EQ(map.erase(10, 15), 0U);
+  map.erase(map.find(10, 20));
+  EXPECT_TRUE(map.empty());
+}
+
+TEST(interval_map, queries) {
+  IntervalMap map{{{0, 10}, "a"},  {{5, 8}, "b"},   {{10, 20}, "c"},
+                  {{15, 25}, "d"}, {{30, 40}, "e"}, {{2, 3}, "f"}};
+  containers::vector<IntervalMap::iterator> found;
+  map.stabbing(10, found);
+  EXPECT_EQ(interval_keys(found),
+            (std::vector<std::pair<int, int>>{{10, 20}}));
+  found.clear();
+  map.stabbing(7, found);
+  EXPECT_EQ(interval_keys(found),
+            (std::vector<std::pair<int, int>>{{0, 10}, {5, 8}}));
+  found.clear();
+  map.overlapping(8, 16, found);
+  EXPECT_EQ(interval_keys(found),
+            (std::vector<std::pair<int, int>>{{0, 10}, {10, 20}, {15, 25}}));
+  found.clear();
+  map.overlapping(25, 30, found);
+  map.overlapping(12, 12, found);
+  map.stabbing(40, found);
+  EXPECT_EQ(found.size(), 0U);
+  EXPECT_TRUE(map.any_overlap(39, 100));
+  EXPECT_TRUE(map.any_overlap(-5, 1));
+  EXPECT_FALSE(map.any_overlap(25, 30));
+  EXPECT_FALSE(map.any_overlap(40, 50));
+  EXPECT_FALSE(map.any_overlap(3, 3));
+}
+
+TEST(interval_map, matches_brute_force) {
+  std::mt19937 gen(22);
+  std::uniform_int_distribution<int> point(0, 999);
+  std::uniform_int_distribution<int> length(1, 60);
+  IntervalMap map;
+  std::set<std::pair<int, int>> intervals;
+  for (int step = 0; step < 6000; ++step) {
+    int lo = point(gen);
+    int hi = lo + length(gen);
+    if (step % 4 == 3 && !intervals.empty()) {
+      std::set<std::pair<int, int>>::iterator i =
+          intervals.lower_bound({lo, 0});
+      std::pair<int, int> victim = i == intervals.end() ? *intervals.begin()
+                                                        : *i;
+      EXPECT_EQ(map.erase(victim.first, victim.second), 1U);
+      intervals.erase(victim);
+    } else {
+      EXPECT_EQ(map.insert(lo, hi, "x").second,
+                intervals.insert({lo, hi}).second);
+    }
+    if (step % 50 != 0) continue;
+    IntervalMap copy(map);
+    for (int query = 0; query < 20; ++query) {
+      int qlo = point(gen);
+      int qhi = qlo + length(gen);
+      std::vector<std::pair<int, int>> expected, stabbed;
+      for (const std::pair<int, int>& i : intervals) {
+        if (i.first < qhi && qlo < i.second) expected.push_back(i);
+        if (i.first <= qlo && qlo < i.second) stabbed.push_back(i);
+      }
+      containers::vector<IntervalMap::iterator> found;
+      copy.overlapping(qlo, qhi, found);
+      EXPECT_EQ(interval_keys(found), expected);
+      EXPECT_EQ(map.any_overlap(qlo, qhi), !expected.empty());
+      found.clear();
+      map.stabbing(qlo, found);
+      EXPECT_EQ(interval_keys(found), stabbed);
+    }
+  }
+}
@@ -255,3 +255,42 @@ TEST_F(ListTest, emplace) {
   eq_list(list, test);
   eq_from_end(list, test);
 }
+
+TEST(list, splice_merge_outlive_source) {
+  containers::list<std::string> list{"b", "d"};
+  {
+    containers::list<std::string> other{"a", "c"};
+    list.merge(other);
+    EXPECT_TRUE(other.empty());
+    other.push_back("0");
+    list.splice(list.cbegin(), other);
+  }
+  std::list<std::string> std_list{"0", "a", "b", "c", "d"};
+  EXPECT_EQ(list.size(), std_list.size());
+  containers::list<std::string>::iterator i = list.begin();
+  for (const std::string& value : std_list) EXPECT_EQ(*(i++), value);
+  list.clear();
+  EXPECT_TRUE(list.empty());
+  list.push_front("f");
+  EXPECT_EQ(list.front(), "f");
+}
+
+TEST(list, allocator) {
+  long live = 0;
+  long other_live = 0;
+  {
+    using counting_list = containers::list<int, CountingAllocator<int>>;
+    counting_list list(CountingAllocator<int>{&live});
+    for (int i = 0; i < 100; i += 2) list.push_back(i);
+    EXPECT_GT(live, 0);
+    counting_list other(CountingAllocator<int>{&other_live});
+    for (int i = 1; i < 100; i += 2) other.push_back(i);
+    list.merge(other);
+    EXPECT_TRUE(other.empty());
+    EXPECT_EQ(list.size(), 100);
+    int expected = 0;
+    for (int value : list) EXPECT_EQ(value, expected++);
+  }
+  EXPECT_EQ(live, 0);
+  EXPECT_EQ(other_live, 0);
+}
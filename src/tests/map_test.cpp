@@ -177,13 +177,13 @@ TEST_F(MapTest, contains) {
   EXPECT_TRUE(map.contains(10));
 }
 
-TEST_F(MapTest, emplace) {
+TEST_F(MapTest, insert_many) {
   std::pair<int, std::string> pair1{17, "cantaloupes"};
   std::pair<int, std::string> pair2{3, "anchovies"};
   std::pair<int, std::string> pair3{-20, "veal"};
   std::pair<int, std::string> pair4{25, "leeks"};
   std::pair<int, std::string> pair5{0, "milk"};
-  map.emplace(pair1, pair2, pair3, pair4, pair5);
+  map.insert_many(pair1, pair2, pair3, pair4, pair5);
   std_map.insert(pair1);
   std_map.insert(pair2);
   std_map.insert(pair3);
@@ -191,3 +191,363 @@ TEST_F(MapTest, emplace) {
   std_map.insert(pair5);
   eq_map(map, std_map);
 }
+
+TEST(map, reverse_sorted_insert_erase) {
+  containers::map<int, int> map;
+  std::map<int, int> std_map;
+  for (int i = 10000; i > 0; --i) {
+    map.insert(i, -i);
+    std_map.insert({i, -i});
+  }
+  for (int i = 1; i <= 10000; i += 2) {
+    map.erase(map.find(i));
+    std_map.erase(i);
+  }
+  EXPECT_EQ(map.size(), std_map.size());
+  EXPECT_THROW(map.at(0), std::out_of_range);
+  containers::map<int, int>::iterator i1 = map.begin();
+  for (const std::pair<const int, int>& value : std_map)
+    EXPECT_EQ(*(i1++), value);
+  EXPECT_EQ(i1, map.end());
+}
+
+TEST_F(MapTest, order_statistics) {
+  std::map<int, std::string>::iterator j = std_map.begin();
+  std::advance(j, 10);
+  EXPECT_EQ(*(map.nth(10)), *j);
+  EXPECT_EQ(map.rank(std::get<0>(*j)), 10);
+  EXPECT_EQ(map.count_range(-10, 10),
+            std::distance(std_map.lower_bound(-10), std_map.lower_bound(10)));
+}
+
+TEST(map, merge_outlive_source) {
+  containers::map<int, std::string> map{std::pair<int, std::string>{1, "a"}};
+  {
+    containers::map<int, std::string> other{
+        std::pair<int, std::string>{1, "b"},
+        std::pair<int, std::string>{2, "c"}};
+    map.merge(other);
+    EXPECT_EQ(other.size(), 1);
+  }
+  EXPECT_EQ(map.size(), 2);
+  EXPECT_EQ(map.at(1), "a");
+  EXPECT_EQ(map.at(2), "c");
+  map.clear();
+  map[3] = "d";
+  EXPECT_EQ(map.at(3), "d");
+}
+
+TEST(map, merge_relinks_nodes) {
+  long live = 0;
+  long total = 0;
+  {
+    using counting_map =
+        containers::map<int, std::string, std::less<int>,
+                        CountingAllocator<std::pair<const int, std::string>>>;
+    CountingAllocator<std::pair<const int, std::string>> alloc(&live, &total);
+    counting_map map(alloc);
+    map.insert(1, "a");
+    {
+      counting_map other(alloc);
+      other.insert(1, "b");
+      other.insert(2, "c");
+      const std::string* moved = &other.at(2);
+      long allocations = total;
+      map.merge(other);
+      EXPECT_EQ(total, allocations);
+      EXPECT_EQ(&map.at(2), moved);
+      EXPECT_EQ(other.at(1), "b");
+    }
+    EXPECT_EQ(map.at(1), "a");
+    EXPECT_EQ(map.at(2), "c");
+  }
+  EXPECT_EQ(live, 0);
+}
+
+TEST(map, allocator) {
+  long live = 0;
+  {
+    using counting_map =
+        containers::map<int, std::string, std::less<int>,
+                        CountingAllocator<std::pair<const int, std::string>>>;
+    CountingAllocator<std::pair<const int, std::string>> alloc(&live);
+    counting_map map(alloc);
+    for (int i = 0; i < 100; ++i) map.insert(i, std::to_string(i));
+    EXPECT_GT(live, 0);
+    counting_map copy(map);
+    EXPECT_EQ(copy.get_allocator(), alloc);
+    EXPECT_EQ(copy.at(42), "42");
+    copy.clear();
+    EXPECT_TRUE(copy.empty());
+  }
+  EXPECT_EQ(live, 0);
+}
+
+TEST(map, transparent_lookup) {
+  containers::map<std::string, int, std::less<>> map{
+      std::pair<std::string, int>{"one", 1},
+      std::pair<std::string, int>{"two", 2}};
+  std::string_view key = "two";
+  EXPECT_EQ(map.at(key), 2);
+  EXPECT_EQ(map.at("one"), 1);
+  EXPECT_EQ(*map.find(key), *map.find(std::string("two")));
+  EXPECT_TRUE(map.contains("one"));
+  EXPECT_FALSE(map.contains(std::string_view("three")));
+  EXPECT_EQ(map.count("two"), 1);
+  EXPECT_EQ(map.count("three"), 0);
+  EXPECT_THROW(map.at("three"), std::out_of_range);
+}
+
+TEST(map, sorted_range_constructor) {
+  containers::list<std::pair<int, std::string>> items{
+      {1, "one"}, {2, "two"}, {2, "second two"}, {3, "three"}};
+  containers::map<int, std::string> map(items.begin(), items.end());
+  EXPECT_EQ(map.size(), 3);
+  EXPECT_EQ(map.at(2), "two");
+  EXPECT_EQ(map.at(3), "three");
+  items.push_back({0, "zero"});
+  map.assign_sorted(items.begin(), items.end());
+  EXPECT_EQ(map.size(), 4);
+  EXPECT_EQ((*map.begin()).second, "zero");
+  EXPECT_EQ(map.at(2), "two");
+}
+
+TEST(map, set_algebra) {
+  containers::map<int, std::string> map{
+      std::pair<int, std::string>{1, "one"},
+      std::pair<int, std::string>{2, "two"},
+      std::pair<int, std::string>{3, "three"}};
+  containers::map<int, std::string> other{
+      std::pair<int, std::string>{2, "other two"},
+      std::pair<int, std::string>{4, "four"}};
+  map.set_union(other);
+  EXPECT_TRUE(other.empty());
+  EXPECT_EQ(map.size(), 4);
+  EXPECT_EQ(map.at(2), "two");
+  EXPECT_EQ(map.at(4), "four");
+  containers::map<int, std::string> odd{
+      std::pair<int, std::string>{1, "other one"},
+      std::pair<int, std::string>{3, "other three"},
+      std::pair<int, std::string>{5, "five"}};
+  map.set_intersection(odd);
+  EXPECT_EQ(map.size(), 2);
+  EXPECT_EQ(map.at(1), "one");
+  EXPECT_EQ(map.at(3), "three");
+  containers::map<int, std::string> three{
+      std::pair<int, std::string>{3, "other three"}};
+  map.set_difference(three);
+  EXPECT_EQ(map.size(), 1);
+  EXPECT_EQ(map.at(1), "one");
+}
+
+TEST(map, bounds) {
+  containers::map<std::string, int, std::less<>> map{
+      std::pair<std::string, int>{"apple", 1},
+      std::pair<std::string, int>{"banana", 2},
+      std::pair<std::string, int>{"cherry", 3}};
+  EXPECT_EQ((*map.lower_bound("b")).second, 2);
+  EXPECT_EQ((*map.upper_bound(std::string_view("banana"))).second, 3);
+  EXPECT_EQ(map.lower_bound("d"), map.end());
+  EXPECT_EQ((*map.lower_bound(std::string("apple"))).second, 1);
+  std::pair<containers::map<std::string, int, std::less<>>::iterator,
+            containers::map<std::string, int, std::less<>>::iterator>
+      range = map.equal_range("banana");
+  EXPECT_EQ((*range.first).second, 2);
+  EXPECT_EQ((*range.second).second, 3);
+}
+
+TEST(map, in_place_construction) {
+  containers::map<int, CopyCounter> map;
+  CopyCounter::reset();
+  map.try_emplace(1, 10);
+  map.emplace(std::piecewise_construct, std::forward_as_tuple(2),
+              std::forward_as_tuple(7, 13));
+  map[3].value = 30;
+  EXPECT_EQ(CopyCounter::constructed, 3);
+  EXPECT_EQ(CopyCounter::copied, 0);
+  EXPECT_EQ(CopyCounter::moved, 0);
+  std::pair<const int, CopyCounter> value(4, CopyCounter(40));
+  CopyCounter::reset();
+  map.insert(std::move(value));
+  EXPECT_EQ(CopyCounter::copied, 0);
+  EXPECT_EQ(CopyCounter::moved, 1);
+  CopyCounter::reset();
+  EXPECT_FALSE(map.try_emplace(1, 99).second);
+  EXPECT_FALSE(map.emplace(2, 99).second);
+  map[3].value += 1;
+  EXPECT_EQ(CopyCounter::constructed, 1);
+  EXPECT_EQ(CopyCounter::copied + CopyCounter::moved, 0);
+  EXPECT_EQ(map.at(1).value, 10);
+  EXPECT_EQ(map.at(2).value, 20);
+  EXPECT_EQ(map.at(3).value, 31);
+  EXPECT_EQ(map.at(4).value, 40);
+}
+
+TEST(map, insert_or_assign_moves) {
+  containers::map<int, CopyCounter> map;
+  CopyCounter::reset();
+  EXPECT_TRUE(map.insert_or_assign(1, CopyCounter(1)).second);
+  EXPECT_FALSE(map.insert_or_assign(1, CopyCounter(2)).second);
+  EXPECT_EQ(CopyCounter::copied, 0);
+  EXPECT_EQ(CopyCounter::moved, 2);
+  EXPECT_EQ(map.at(1).value, 2);
+  std::string key = "long enough to live on the heap";
+  containers::map<std::string, int> names;
+  names[std::move(key)] = 1;
+  EXPECT_EQ(names.at("long enough to live on the heap"), 1);
+}
+
+TEST(map, extract_rekey) {
+  containers::map<int, CopyCounter> map;
+  for (int i = 0; i < 10; ++i) map.try_emplace(i, i * 10);
+  CopyCounter* address = &(*map.find(3)).second;
+  CopyCounter::reset();
+  containers::map<int, CopyCounter>::node_type nh = map.extract(3);
+  EXPECT_FALSE(nh.empty());
+  EXPECT_EQ(nh.key(), 3);
+  EXPECT_EQ(map.size(), 9U);
+  EXPECT_FALSE(map.contains(3));
+  nh.key() = 30;
+  containers::map<int, CopyCounter>::insert_return_type res =
+      map.insert(std::move(nh));
+  EXPECT_TRUE(res.inserted);
+  EXPECT_TRUE(res.node.empty());
+  EXPECT_EQ(&(*res.position).second, address);
+  EXPECT_EQ(map.at(30).value, 30);
+  EXPECT_EQ(CopyCounter::copied + CopyCounter::moved, 0);
+  res = map.insert(map.extract(map.find(30)));
+  EXPECT_TRUE(res.inserted);
+  nh = map.extract(4);
+  nh.key() = 5;
+  res = map.insert(std::move(nh));
+  EXPECT_FALSE(res.inserted);
+  EXPECT_EQ((*res.position).second.value, 50);
+  EXPECT_EQ(res.node.mapped().value, 40);
+  EXPECT_EQ(map.size(), 9U);
+  EXPECT_TRUE(map.extract(42).empty());
+  EXPECT_FALSE(map.insert(containers::map<int, CopyCounter>::node_type())
+                   .inserted);
+  for (int key : {0, 1, 2, 5, 6, 7, 8, 9, 30}) EXPECT_TRUE(map.contains(key));
+}
+
+TEST(map, extract_to_other_map) {
+  containers::map<int, CopyCounter> hot;
+  containers::map<int, CopyCounter> cold;
+  for (int i = 0; i < 100; ++i) hot.try_emplace(i, i);
+  CopyCounter::reset();
+  for (int i = 0; i < 100; i += 2) {
+    EXPECT_TRUE(cold.insert(hot.extract(i)).inserted);
+  }
+  EXPECT_EQ(CopyCounter::copied, 0);
+  EXPECT_EQ(CopyCounter::moved, 0);
+  EXPECT_EQ(hot.size(), 50U);
+  EXPECT_EQ(cold.size(), 50U);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(hot.contains(i), i % 2 == 1);
+    if (i % 2 == 0) {
+      EXPECT_EQ(cold.at(i).value, i);
+    }
+  }
+  {
+    containers::map<int, CopyCounter>::node_type dropped = cold.extract(0);
+  }
+  EXPECT_FALSE(cold.contains(0));
+  EXPECT_EQ(cold.size(), 49U);
+}
+
+TEST(map, node_handle_outlives_source) {
+  long live = 0;
+  long total = 0;
+  {
+    using counting_map =
+        containers::map<int, std::string, std::less<int>,
+                        CountingAllocator<std::pair<const int, std::string>>>;
+    CountingAllocator<std::pair<const int, std::string>> alloc(&live, &total);
+    counting_map target(alloc);
+    target.insert(0, "zero");
+    counting_map::node_type kept;
+    counting_map::node_type dropped;
+    {
+      counting_map source(alloc);
+      for (int i = 1; i < 100; ++i) source.insert(i, std::to_string(i));
+      kept = source.extract(7);
+      dropped = source.extract(8);
+      long allocations = total;
+      EXPECT_TRUE(target.insert(source.extract(9)).inserted);
+      EXPECT_EQ(total, allocations);
+    }
+    EXPECT_EQ(kept.mapped(), "7");
+    kept.key() = 70;
+    long allocations = total;
+    EXPECT_TRUE(target.insert(std::move(kept)).inserted);
+    EXPECT_EQ(total, allocations);
+    EXPECT_EQ(target.at(70), "7");
+    EXPECT_EQ(target.at(9), "9");
+    EXPECT_EQ(dropped.get_allocator(), alloc);
+    dropped = counting_map::node_type();
+    target.clear();
+    EXPECT_TRUE(target.empty());
+  }
+  EXPECT_EQ(live, 0);
+}
+
+TEST(map, hinted_insert) {
+  containers::map<int, std::string> map;
+  for (int i = 0; i < 100; ++i)
+    map.insert(map.end(), std::pair<const int, std::string>(i, "v"));
+  containers::map<int, std::string>::iterator i =
+      map.emplace_hint(map.find(50), 50, "other");
+  EXPECT_EQ((*i).second, "v");
+  i = map.emplace_hint(map.begin(), -1, "first");
+  EXPECT_EQ(i, map.begin());
+  EXPECT_EQ(map.size(), 101U);
+  EXPECT_EQ(map.rank(99), 100U);
+}
+
+TEST(map, copy_assignment_reuses_nodes) {
+  containers::map<int, CopyCounter> source;
+  containers::map<int, CopyCounter> target;
+  for (int i = 0; i < 100; ++i) source.try_emplace(i, i);
+  for (int i = 0; i < 60; ++i) target.try_emplace(-i, -i);
+  long live = 0;
+  {
+    CountingAllocator<std::pair<const int, int>> alloc(&live);
+    containers::map<int, int, std::less<int>,
+                    CountingAllocator<std::pair<const int, int>>>
+        small(alloc), large(alloc);
+    for (int i = 0; i < 1000; ++i) large.insert(i, i);
+    for (int i = 0; i < 2000; ++i) small.insert(i, i);
+    long before = live;
+    small = large;
+    EXPECT_EQ(live, before);
+    EXPECT_EQ(small.size(), 1000U);
+    EXPECT_EQ(small.at(999), 999);
+  }
+  CopyCounter::reset();
+  target = source;
+  EXPECT_EQ(CopyCounter::copied, 100);
+  EXPECT_EQ(CopyCounter::moved, 0);
+  ASSERT_EQ(target.size(), 100U);
+  for (int i = 0; i < 100; ++i) EXPECT_EQ(target.at(i).value, i);
+  EXPECT_FALSE(target.contains(-1));
+}
+
+TEST(map, contains_many) {
+  containers::map<std::string, int, std::less<>> map;
+  for (int i = 0; i < 100; ++i) map.insert(std::to_string(i), i);
+  std::vector<std::string_view> keys{"7", "70", "700", "", "99", "x"};
+  containers::vector<bool> present;
+  map.contains_many(keys.begin(), keys.end(), present);
+  ASSERT_EQ(present.size(), keys.size());
+  EXPECT_TRUE(present[0]);
+  EXPECT_TRUE(present[1]);
+  EXPECT_FALSE(present[2]);
+  EXPECT_FALSE(present[3]);
+  EXPECT_TRUE(present[4]);
+  EXPECT_FALSE(present[5]);
+  containers::vector<containers::map<std::string, int, std::less<>>::iterator>
+      found;
+  map.find_many(keys.begin(), keys.end(), found);
+  EXPECT_EQ((*found[1]).second, 70);
+  EXPECT_EQ(found[5], map.end());
+}
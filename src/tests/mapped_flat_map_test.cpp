@@ -0,0 +1,136 @@
+// Returns a path for a table in the temporary directory of the tests.
+std::string table_path(const char* name) {
+  return testing::TempDir() + "containers_" + name + ".table";
+}
+
+TEST(mapped_flat_map, build_from_map) {
+  std::string path = table_path("from_map");
+  containers::map<int, double> map;
+  for (int key = 0; key < 1000; ++key) map.insert((key * 37) % 1000 * 2, key);
+  containers::mapped_flat_map<int, double>::build(map, path);
+  containers::mapped_flat_map<int, double> table(path);
+  ASSERT_EQ(table.size(), map.size());
+  EXPECT_FALSE(table.empty());
+  for (int key = 0; key < 2000; ++key) {
+    EXPECT_EQ(table.contains(key), key % 2 == 0);
+    EXPECT_EQ(table.count(key), map.count(key));
+  }
+  for (int key = 0; key < 2000; key += 2) {
+    EXPECT_EQ(table.at(key), map.at(key));
+    EXPECT_EQ(table.find(key)->first, key);
+    EXPECT_EQ(table.find(key)->second, map.at(key));
+  }
+  EXPECT_TRUE(table.find(1) == table.end());
+  EXPECT_THROW(table.at(1), std::out_of_range);
+  auto expected = map.begin();
+  for (std::pair<const int&, const double&> item : table) {
+    EXPECT_EQ(item.first, (*expected).first);
+    EXPECT_EQ(item.second, (*expected).second);
+    ++expected;
+  }
+  EXPECT_TRUE(expected == map.end());
+  std::remove(path.c_str());
+}
+
+TEST(mapped_flat_map, build_from_sorted_vector) {
+  std::string path = table_path("from_vector");
+  containers::vector<std::pair<int, char>> items;
+  for (int key = 0; key < 26; ++key)
+    items.push_back(std::pair<int, char>(key * 10, 'a' + key));
+  containers::mapped_flat_map<int, char>::build(items, path);
+  containers::mapped_flat_map<int, char> table(path);
+  ASSERT_EQ(table.size(), 26U);
+  EXPECT_EQ(table.at(0), 'a');
+  EXPECT_EQ(table.at(250), 'z');
+  EXPECT_EQ(table.lower_bound(15)->first, 20);
+  EXPECT_EQ(table.lower_bound(20)->first, 20);
+  EXPECT_EQ(table.upper_bound(20)->first, 30);
+  EXPECT_TRUE(table.lower_bound(251) == table.end());
+  std::string range;
+  for (auto i = table.lower_bound(95); i != table.lower_bound(150); ++i)
+    range += (*i).second;
+  EXPECT_EQ(range, "klmno");
+  auto last = table.end();
+  --last;
+  EXPECT_EQ(last->second, 'z');
+  auto bounds = table.equal_range(40);
+  EXPECT_EQ(bounds.first->second, 'e');
+  EXPECT_EQ(bounds.second->second, 'f');
+  std::remove(path.c_str());
+}
+
+TEST(mapped_flat_map, empty_table) {
+  std::string path = table_path("empty");
+  containers::mapped_flat_map<int, int>::build(containers::map<int, int>(),
+                                               path);
+  containers::mapped_flat_map<int, int> table(path);
+  EXPECT_TRUE(table.empty());
+  EXPECT_TRUE(table.begin() == table.end());
+  EXPECT_TRUE(table.find(0) == table.end());
+  containers::mapped_flat_map<int, int> unopened;
+  EXPECT_EQ(unopened.size(), 0U);
+  EXPECT_TRUE(unopened.lower_bound(3) == unopened.end());
+  std::remove(path.c_str());
+}
+
+TEST(mapped_flat_map, rejects_unsorted_input) {
+  std::string path = table_path("unsorted");
+  containers::vector<std::pair<int, int>> items;
+  items.push_back(std::pair<int, int>(1, 1));
+  items.push_back(std::pair<int, int>(3, 3));
+  items.push_back(std::pair<int, int>(3, 4));
+  EXPECT_THROW((containers::mapped_flat_map<int, int>::build(items, path)),
+               std::invalid_argument);
+  items[2].first = 2;
+  EXPECT_THROW((containers::mapped_flat_map<int, int>::build(items, path)),
+               std::invalid_argument);
+  EXPECT_THROW((containers::mapped_flat_map<int, int>(path)),
+               std::system_error);
+}
+
+TEST(mapped_flat_map, rejects_other_files) {
+  std::string path = table_path("other");
+  containers::map<int, int> map{{1, 2}, {3, 4}};
+  containers::mapped_flat_map<int, int>::build(map, path);
+  EXPECT_THROW((containers::mapped_flat_map<int, double>(path)),
+               std::runtime_error);
+  EXPECT_THROW((containers::mapped_flat_map<long long, int>(path)),
+               std::runtime_error);
+  containers::save(map, path);
+  EXPECT_THROW((containers::mapped_flat_map<int, int>(path)),
+               std::runtime_error);
+  std::FILE* file = std::fopen(path.c_str(), "w");
+  std::fputs("short", file);
+  std::fclose(file);
+  EXPECT_THROW((containers::mapped_flat_map<int, int>(path)),
+               std::runtime_error);
+  std::remove(path.c_str());
+}
+
+TEST(mapped_flat_map, move) {
+  std::string path = table_path("move");
+  containers::map<int, int> map{{1, 10}, {2, 20}, {3, 30}};
+  containers::mapped_flat_map<int, int>::build(map, path);
+  containers::mapped_flat_map<int, int> table(path);
+  containers::mapped_flat_map<int, int> moved(std::move(table));
+  EXPECT_EQ(table.size(), 0U);
+  EXPECT_EQ(moved.at(2), 20);
+  containers::mapped_flat_map<int, int> assigned;
+  assigned = std::move(moved);
+  EXPECT_EQ(assigned.size(), 3U);
+  EXPECT_EQ(assigned.at(3), 30);
+  // The mapping outlives the file name.
+  std::remove(path.c_str());
+  EXPECT_EQ(assigned.at(1), 10);
+}
+
+TEST(mapped_flat_map, transparent_lookup) {
+  std::string path = table_path("transparent");
+  containers::map<int, int, std::less<>> map{{1, 10}, {5, 50}};
+  containers::mapped_flat_map<int, int, std::less<>>::build(map, path);
+  containers::mapped_flat_map<int, int, std::less<>> table(path);
+  EXPECT_TRUE(table.contains(5L));
+  EXPECT_EQ(table.find(1.0)->second, 10);
+  EXPECT_EQ(table.at(5L), 50);
+  std::remove(path.c_str());
+}
@@ -131,8 +131,323 @@ TEST_F(MultisetTest, equal_range_bound) {
   EXPECT_EQ(i2, up);
 }
 
-TEST_F(MultisetTest, emplace) {
-  multiset.emplace(0, 1, 2, 3, 4);
+TEST_F(MultisetTest, insert_many) {
+  multiset.insert_many(0, 1, 2, 3, 4);
   for (int i = 0; i < 5; ++i) std_multiset.insert(i);
   eq_set(multiset, std_multiset);
 }
+
+TEST(multiset, sorted_insert_erase) {
+  containers::multiset<int> multiset;
+  std::multiset<int> std_multiset;
+  for (int i = 0; i < 10000; ++i) {
+    multiset.insert(i / 4);
+    std_multiset.insert(i / 4);
+  }
+  for (int i = 0; i < 2500; i += 2) {
+    multiset.erase(multiset.find(i));
+    std_multiset.erase(std_multiset.find(i));
+  }
+  EXPECT_EQ(multiset.size(), std_multiset.size());
+  containers::multiset<int>::iterator i1 = multiset.begin();
+  for (int value : std_multiset) EXPECT_EQ(*(i1++), value);
+  EXPECT_EQ(i1, multiset.end());
+}
+
+TEST_F(MultisetTest, order_statistics) {
+  EXPECT_EQ(*(multiset.nth(0)), -20);
+  EXPECT_EQ(*(multiset.nth(2)), -19);
+  EXPECT_EQ(multiset.rank(-19), 2);
+  EXPECT_EQ(multiset.rank(-14), 7);
+  EXPECT_EQ(multiset.count_range(-14, -12), multiset.count(-14));
+  multiset.erase(multiset.nth(3));
+  EXPECT_EQ(multiset.size(), std_multiset.size() - 1);
+  EXPECT_EQ(multiset.rank(-14), 6);
+}
+
+TEST(multiset, merge_outlive_source) {
+  containers::multiset<std::string> multiset{"b", "d", "b"};
+  {
+    containers::multiset<std::string> other{"a", "b", "e"};
+    multiset.merge(other);
+    EXPECT_TRUE(other.empty());
+  }
+  std::multiset<std::string> std_multiset{"a", "b", "b", "b", "d", "e"};
+  EXPECT_EQ(multiset.size(), std_multiset.size());
+  containers::multiset<std::string>::iterator i = multiset.begin();
+  for (const std::string& value : std_multiset) EXPECT_EQ(*(i++), value);
+}
+
+TEST(multiset, allocator) {
+  long live = 0;
+  long other_live = 0;
+  {
+    using counting_multiset =
+        containers::multiset<int, std::less<int>, CountingAllocator<int>>;
+    counting_multiset multiset(CountingAllocator<int>{&live});
+    counting_multiset other(CountingAllocator<int>{&other_live});
+    for (int i = 0; i < 100; ++i) {
+      multiset.insert(i % 10);
+      other.insert(i % 7);
+    }
+    multiset.merge(other);
+    EXPECT_TRUE(other.empty());
+    EXPECT_EQ(multiset.size(), 200);
+    EXPECT_EQ(multiset.count(3), 24);
+  }
+  EXPECT_EQ(live, 0);
+  EXPECT_EQ(other_live, 0);
+}
+
+TEST_F(MultisetTest, sorted_range_constructor) {
+  std::vector<int> items(std_multiset.begin(), std_multiset.end());
+  containers::multiset<int> sorted(items.begin(), items.end());
+  eq_set(sorted, std_multiset);
+  EXPECT_EQ(sorted.count(-14), 3);
+  items.push_back(-100);
+  sorted.assign_sorted(items.begin(), items.end());
+  std_multiset.insert(-100);
+  eq_set(sorted, std_multiset);
+}
+
+TEST_F(MultisetTest, set_algebra) {
+  std::initializer_list<int> init = {-14, -14, -14, -14, 8, 8, 0, -20};
+  std::multiset<int> std_other(init);
+  for (int op = 0; op < 4; ++op) {
+    containers::multiset<int> copy(multiset);
+    containers::multiset<int> other(init);
+    std::multiset<int> expected;
+    std::insert_iterator<std::multiset<int>> out(expected, expected.end());
+    if (op == 0) {
+      copy.set_union(other);
+      std::set_union(std_multiset.begin(), std_multiset.end(),
+                     std_other.begin(), std_other.end(), out);
+    } else if (op == 1) {
+      copy.set_intersection(other);
+      std::set_intersection(std_multiset.begin(), std_multiset.end(),
+                            std_other.begin(), std_other.end(), out);
+    } else if (op == 2) {
+      copy.set_difference(other);
+      std::set_difference(std_multiset.begin(), std_multiset.end(),
+                          std_other.begin(), std_other.end(), out);
+    } else {
+      copy.symmetric_difference(other);
+      std::set_symmetric_difference(std_multiset.begin(), std_multiset.end(),
+                                    std_other.begin(), std_other.end(), out);
+    }
+    eq_set(copy, expected);
+    EXPECT_TRUE(other.empty());
+  }
+}
+
+TEST(multiset, set_algebra_keeps_order_of_equivalents) {
+  struct Less {
+    bool operator()(const std::pair<int, int>& a,
+                    const std::pair<int, int>& b) const {
+      return a.first < b.first;
+    }
+  };
+  using pair_multiset = containers::multiset<std::pair<int, int>, Less>;
+  std::mt19937 gen(29);
+  for (int op = 0; op < 4; ++op) {
+    for (int size : {1, 10, 300, 3000}) {
+      std::uniform_int_distribution<int> key(0, size / 4 + 1);
+      std::vector<std::pair<int, int>> a, b;
+      for (int i = 0; i < 1000; ++i) a.push_back({key(gen), i});
+      for (int i = 0; i < size; ++i) b.push_back({key(gen), -i});
+      std::stable_sort(a.begin(), a.end(), Less());
+      std::stable_sort(b.begin(), b.end(), Less());
+      pair_multiset multiset(a.begin(), a.end());
+      pair_multiset other(b.begin(), b.end());
+      std::vector<std::pair<int, int>> expected;
+      auto out = std::back_inserter(expected);
+      if (op == 0) {
+        multiset.set_union(other);
+        std::set_union(a.begin(), a.end(), b.begin(), b.end(), out, Less());
+      } else if (op == 1) {
+        multiset.set_intersection(other);
+        std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), out,
+                              Less());
+      } else if (op == 2) {
+        multiset.set_difference(other);
+        std::set_difference(a.begin(), a.end(), b.begin(), b.end(), out,
+                            Less());
+      } else {
+        multiset.symmetric_difference(other);
+        std::set_symmetric_difference(a.begin(), a.end(), b.begin(), b.end(),
+                                      out, Less());
+      }
+      EXPECT_TRUE(other.empty());
+      ASSERT_EQ(multiset.size(), expected.size());
+      size_t rank = 0;
+      for (const std::pair<int, int>& item : multiset) {
+        EXPECT_EQ(item, expected[rank]);
+        EXPECT_EQ(*multiset.nth(rank), expected[rank]);
+        ++rank;
+      }
+      for (int i = 0; i < 100; ++i) multiset.insert({i, 0});
+      EXPECT_EQ(multiset.size(), expected.size() + 100);
+    }
+  }
+}
+
+TEST(multiset, parallel) {
+  containers::ThreadPool pool(4);
+  std::mt19937 gen(5);
+  std::vector<int> keys;
+  for (int i = 0; i < 100000; ++i) keys.push_back(gen() % 20000);
+  std::vector<int> others;
+  for (int i = 0; i < 50000; ++i) others.push_back(gen() % 20000);
+  containers::multiset<int> multiset;
+  multiset.assign(keys.begin(), keys.end(), pool);
+  containers::multiset<int> other;
+  other.assign(others.begin(), others.end(), pool);
+  for (int op = 0; op < 4; ++op) {
+    containers::multiset<int> parallel(multiset);
+    containers::multiset<int> parallel_other(other);
+    containers::multiset<int> serial(multiset);
+    containers::multiset<int> serial_other(other);
+    if (op == 0) {
+      parallel.set_union(parallel_other, pool);
+      serial.set_union(serial_other);
+    } else if (op == 1) {
+      parallel.set_intersection(parallel_other, pool);
+      serial.set_intersection(serial_other);
+    } else if (op == 2) {
+      parallel.set_difference(parallel_other, pool);
+      serial.set_difference(serial_other);
+    } else {
+      parallel.symmetric_difference(parallel_other, pool);
+      serial.symmetric_difference(serial_other);
+    }
+    EXPECT_TRUE(parallel_other.empty());
+    ASSERT_EQ(parallel.size(), serial.size());
+    containers::multiset<int>::iterator i = parallel.begin();
+    for (int key : serial) EXPECT_EQ(*i++, key);
+  }
+}
+
+TEST_F(MultisetTest, bounds_of_absent_keys) {
+  for (int key = -22; key <= 22; ++key) {
+    containers::multiset<int>::iterator low = multiset.lower_bound(key);
+    containers::multiset<int>::iterator up = multiset.upper_bound(key);
+    std::multiset<int>::iterator std_low = std_multiset.lower_bound(key);
+    std::multiset<int>::iterator std_up = std_multiset.upper_bound(key);
+    if (std_low == std_multiset.end())
+      EXPECT_EQ(low, multiset.end());
+    else
+      EXPECT_EQ(*low, *std_low);
+    if (std_up == std_multiset.end())
+      EXPECT_EQ(up, multiset.end());
+    else
+      EXPECT_EQ(*up, *std_up);
+    EXPECT_EQ(multiset.count(key), std_multiset.count(key));
+    EXPECT_EQ(multiset.equal_range(key).first, low);
+    EXPECT_EQ(multiset.equal_range(key).second, up);
+  }
+}
+
+TEST(multiset, logarithmic_count) {
+  int calls = 0;
+  auto less = [&calls](int a, int b) {
+    ++calls;
+    return a < b;
+  };
+  containers::multiset<int, decltype(less)> multiset(less);
+  for (int i = 0; i < 4096; ++i) multiset.insert(i % 4);
+  calls = 0;
+  EXPECT_EQ(multiset.count(2), 1024);
+  EXPECT_LE(calls, 2 * 25);
+  calls = 0;
+  containers::multiset<int, decltype(less)>::iterator up =
+      multiset.upper_bound(2);
+  EXPECT_EQ(*up, 3);
+  EXPECT_EQ(*--up, 2);
+  EXPECT_LE(calls, 25);
+}
+
+TEST(multiset, in_place_construction) {
+  containers::multiset<CopyCounter> multiset;
+  CopyCounter::reset();
+  multiset.emplace(1, 2);
+  multiset.emplace(3);
+  multiset.insert(CopyCounter(3));
+  EXPECT_EQ(CopyCounter::copied, 0);
+  EXPECT_EQ(CopyCounter::moved, 1);
+  EXPECT_EQ(multiset.count(CopyCounter(3)), 3U);
+}
+
+TEST_F(MultisetTest, extract_insert) {
+  containers::multiset<int> other;
+  for (int key : {-14, -14, -20}) {
+    other.insert(multiset.extract(key));
+    std_multiset.erase(std_multiset.find(key));
+  }
+  eq_set(multiset, std_multiset);
+  EXPECT_EQ(other.count(-14), 2U);
+  EXPECT_EQ(other.count(-20), 1U);
+  containers::multiset<int>::node_type nh = other.extract(-20);
+  nh.value() = -14;
+  other.insert(std::move(nh));
+  EXPECT_EQ(other.count(-14), 3U);
+  EXPECT_TRUE(multiset.extract(0).empty());
+}
+
+TEST(multiset, node_handle_outlives_merge) {
+  containers::multiset<std::string>::node_type nh;
+  containers::multiset<std::string> multiset{"a", "b"};
+  {
+    containers::multiset<std::string> source{"b", "c", "c"};
+    nh = source.extract("c");
+    multiset.merge(source);
+  }
+  EXPECT_EQ(multiset.count("b"), 2U);
+  multiset.clear();
+  nh.value() = "z";
+  EXPECT_EQ(*multiset.insert(std::move(nh)), "z");
+  EXPECT_EQ(multiset.size(), 1U);
+}
+
+TEST(multiset, hinted_insert) {
+  std::mt19937 gen(17);
+  std::uniform_int_distribution<int> key(0, 300);
+  containers::multiset<int> multiset;
+  std::multiset<int> std_multiset;
+  containers::multiset<int>::iterator hint = multiset.end();
+  for (int step = 0; step < 5000; ++step) {
+    int k = step % 4 == 0 ? key(gen) : step / 8;
+    if (step % 5 == 0)
+      hint = multiset.emplace_hint(hint, k);
+    else
+      hint = multiset.insert(step % 3 ? multiset.end() : hint, k);
+    std_multiset.insert(k);
+    EXPECT_EQ(*hint, k);
+  }
+  ASSERT_EQ(multiset.size(), std_multiset.size());
+  size_t rank = 0;
+  for (int k : std_multiset) EXPECT_EQ(*multiset.nth(rank++), k);
+  for (int k = 0; k <= 700; ++k)
+    EXPECT_EQ(multiset.count(k), std_multiset.count(k));
+}
+
+TEST_F(MultisetTest, copy_assignment) {
+  containers::multiset<int> other{5, 5, 5};
+  other = multiset;
+  eq_set(other, std_multiset);
+  EXPECT_EQ(other.count(-14), 3U);
+  other.insert(-14);
+  EXPECT_EQ(multiset.count(-14), 3U);
+}
+
+TEST_F(MultisetTest, find_many) {
+  int keys[] = {-14, 0, -20, 20, -21, 21, -12, -12};
+  containers::vector<containers::multiset<int>::iterator> found;
+  multiset.find_many(keys, keys + 8, found);
+  ASSERT_EQ(found.size(), 8U);
+  for (size_t i = 0; i < 8; ++i) {
+    EXPECT_EQ(found[i], multiset.find(keys[i]));
+    if (found[i] != multiset.end()) {
+      EXPECT_EQ(found[i], multiset.lower_bound(keys[i]));
+    }
+  }
+}
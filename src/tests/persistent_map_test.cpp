@@ -0,0 +1,164 @@
+template <class Snapshot>
+void eq_persistent_map(const Snapshot& snapshot,
+                       const std::map<int, int>& std_map) {
+  ASSERT_EQ(snapshot.size(), std_map.size());
+  typename Snapshot::const_iterator i1 = snapshot.begin();
+  for (std::map<int, int>::const_iterator i2 = std_map.begin();
+       i2 != std_map.end(); ++i1, ++i2) {
+    EXPECT_EQ((*i1).first, i2->first);
+    EXPECT_EQ((*i1).second, i2->second);
+  }
+  EXPECT_TRUE(i1 == snapshot.end());
+}
+
+TEST(persistent_map, default_constructor_empty) {
+  containers::persistent_map<int, int> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.size(), 0U);
+  containers::persistent_map<int, int>::snapshot_type snapshot =
+      map.snapshot();
+  EXPECT_TRUE(snapshot.empty());
+  EXPECT_TRUE(snapshot.begin() == snapshot.end());
+}
+
+TEST(persistent_map, insert_assign_erase) {
+  containers::persistent_map<int, std::string> map;
+  EXPECT_TRUE(map.insert(1, "one"));
+  EXPECT_FALSE(map.insert(1, "uno"));
+  EXPECT_EQ(map.at(1), "one");
+  EXPECT_FALSE(map.insert_or_assign(1, "uno"));
+  EXPECT_TRUE(map.insert_or_assign(2, "two"));
+  EXPECT_EQ(map.at(1), "uno");
+  EXPECT_TRUE(map.contains(2));
+  EXPECT_EQ(map.size(), 2U);
+  EXPECT_EQ(map.erase(1), 1U);
+  EXPECT_EQ(map.erase(1), 0U);
+  EXPECT_FALSE(map.contains(1));
+  EXPECT_THROW(map.at(1), std::out_of_range);
+  map.clear();
+  EXPECT_TRUE(map.empty());
+}
+
+TEST(persistent_map, snapshot_lookups) {
+  containers::persistent_map<int, int> map;
+  for (int key = 0; key < 100; key += 2) map.insert(key, key * key);
+  containers::persistent_map<int, int>::snapshot_type snapshot =
+      map.snapshot();
+  EXPECT_EQ(snapshot.size(), 50U);
+  EXPECT_EQ(snapshot.at(10), 100);
+  EXPECT_THROW(snapshot.at(11), std::out_of_range);
+  EXPECT_EQ(snapshot.count(12), 1U);
+  EXPECT_EQ(snapshot.count(13), 0U);
+  EXPECT_TRUE(snapshot.find(13) == snapshot.end());
+  EXPECT_EQ((*snapshot.find(14)).second, 196);
+  EXPECT_EQ((*snapshot.lower_bound(15)).first, 16);
+  EXPECT_EQ((*snapshot.lower_bound(-5)).first, 0);
+  EXPECT_TRUE(snapshot.lower_bound(99) == snapshot.end());
+  int expected = 30;
+  for (containers::persistent_map<int, int>::const_iterator i =
+           snapshot.lower_bound(29);
+       i != snapshot.end(); ++i, expected += 2)
+    EXPECT_EQ((*i).first, expected);
+  EXPECT_EQ(expected, 100);
+}
+
+TEST(persistent_map, snapshots_keep_their_version) {
+  containers::persistent_map<int, int> map;
+  std::map<int, int> std_map;
+  std::vector<containers::persistent_map<int, int>::snapshot_type> snapshots;
+  std::vector<std::map<int, int>> versions;
+  std::mt19937 gen(21);
+  std::uniform_int_distribution<int> key(0, 255);
+  for (int step = 0; step < 4000; ++step) {
+    int k = key(gen);
+    if (step % 3 == 2) {
+      EXPECT_EQ(map.erase(k), std_map.erase(k));
+    } else if (step % 3 == 1) {
+      EXPECT_EQ(map.insert_or_assign(k, step), std_map.count(k) == 0);
+      std_map[k] = step;
+    } else {
+      EXPECT_EQ(map.insert(k, step), std_map.emplace(k, step).second);
+    }
+    if (step % 100 == 0) {
+      snapshots.push_back(map.snapshot());
+      versions.push_back(std_map);
+    }
+  }
+  eq_persistent_map(map.snapshot(), std_map);
+  for (size_t i = 0; i < snapshots.size(); ++i)
+    eq_persistent_map(snapshots[i], versions[i]);
+}
+
+TEST(persistent_map, snapshot_copy_move) {
+  containers::persistent_map<int, int> map;
+  for (int key = 0; key < 10; ++key) map.insert(key, key);
+  containers::persistent_map<int, int>::snapshot_type snapshot =
+      map.snapshot();
+  containers::persistent_map<int, int>::snapshot_type copy(snapshot);
+  containers::persistent_map<int, int>::snapshot_type moved(
+      std::move(snapshot));
+  EXPECT_TRUE(snapshot.empty());
+  map.clear();
+  EXPECT_EQ(copy.size(), 10U);
+  EXPECT_EQ(moved.size(), 10U);
+  copy = map.snapshot();
+  EXPECT_TRUE(copy.empty());
+  EXPECT_EQ(moved.at(9), 9);
+}
+
+TEST(persistent_map, frees_nodes_of_released_versions) {
+  long live = 0;
+  {
+    containers::persistent_map<int, int, std::less<int>,
+                               CountingAllocator<std::pair<const int, int>>>
+        map(std::less<int>(),
+            CountingAllocator<std::pair<const int, int>>{&live});
+    for (int key = 0; key < 64; ++key) map.insert(key, key);
+    EXPECT_EQ(live, 64);
+    {
+      auto snapshot = map.snapshot();
+      for (int key = 0; key < 64; key += 2) map.erase(key);
+      EXPECT_GT(live, 64);
+      EXPECT_EQ(snapshot.size(), 64U);
+    }
+    EXPECT_EQ(live, 32);
+    map.insert_or_assign(1, -1);
+    EXPECT_EQ(live, 32);
+  }
+  EXPECT_EQ(live, 0);
+}
+
+TEST(persistent_map, readers_during_writes) {
+  constexpr int kKeys = 512;
+  constexpr int kRounds = 160;
+  containers::persistent_map<int, int> map;
+  for (int key = 0; key < kKeys; ++key) map.insert(key, 0);
+  std::atomic<bool> done{false};
+  std::atomic<int> inconsistent{0};
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 2; ++t) {
+    readers.emplace_back([&] {
+      while (!done.load()) {
+        containers::persistent_map<int, int>::snapshot_type snapshot =
+            map.snapshot();
+        // The writer bumps every value to the round number in key order,
+        // so any version is a run of round r followed by round r - 1.
+        int first = (*snapshot.begin()).second, previous = first;
+        size_t n = 0;
+        bool ok = true;
+        for (const std::pair<const int, int>& item : snapshot) {
+          ok = ok && item.second <= previous && item.second + 1 >= first;
+          previous = item.second;
+          ++n;
+        }
+        if (!ok || n != snapshot.size()) inconsistent.fetch_add(1);
+      }
+    });
+  }
+  for (int round = 1; round <= kRounds; ++round)
+    for (int key = 0; key < kKeys; ++key) map.insert_or_assign(key, round);
+  done = true;
+  for (std::thread& reader : readers) reader.join();
+  EXPECT_EQ(inconsistent.load(), 0);
+  EXPECT_EQ(map.snapshot().at(kKeys - 1), kRounds);
+}
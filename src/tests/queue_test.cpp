@@ -108,3 +108,16 @@ TEST(bonus_test_1, test_emplace) {
   ASSERT_EQ(oq_my.front(), 100);
   ASSERT_EQ(oq_my.back(), 320);
 }
+
+TEST(test_allocator, queue_allocator) {
+  long live = 0;
+  {
+    containers::queue<int, CountingAllocator<int>> q(
+        CountingAllocator<int>{&live});
+    for (int i = 0; i < 100; ++i) q.push(i);
+    ASSERT_GT(live, 0);
+    ASSERT_EQ(q.front(), 0);
+    ASSERT_EQ(q.size(), 100);
+  }
+  ASSERT_EQ(live, 0);
+}
@@ -0,0 +1,99 @@
+// Returns a path for a snapshot in the temporary directory of the tests.
+std::string snapshot_path(const char* name) {
+  return testing::TempDir() + "containers_" + name + ".snapshot";
+}
+
+TEST(serialize, vector_round_trip) {
+  std::string path = snapshot_path("vector");
+  containers::vector<double> v{1.5, -2, 3.25, 0};
+  containers::save(v, path);
+  containers::vector<double> loaded{7};
+  containers::load(loaded, path);
+  ASSERT_EQ(loaded.size(), v.size());
+  for (size_t i = 0; i < v.size(); ++i) EXPECT_EQ(loaded[i], v[i]);
+  containers::save(containers::vector<double>(), path);
+  containers::load(loaded, path);
+  EXPECT_EQ(loaded.size(), 0U);
+  std::remove(path.c_str());
+}
+
+TEST(serialize, array_list_queue_round_trip) {
+  std::string path = snapshot_path("sequences");
+  containers::array<int, 4> a{4, 3, 2, 1};
+  containers::save(a, path);
+  containers::array<int, 4> loaded_array{0, 0, 0, 0};
+  containers::load(loaded_array, path);
+  for (size_t i = 0; i < 4; ++i) EXPECT_EQ(loaded_array[i], a[i]);
+  containers::array<int, 5> wrong_size{0, 0, 0, 0, 0};
+  EXPECT_THROW(containers::load(wrong_size, path), std::runtime_error);
+
+  containers::list<int> l{5, 6, 7};
+  containers::save(l, path);
+  containers::list<int> loaded_list{1};
+  containers::load(loaded_list, path);
+  EXPECT_EQ(loaded_list.size(), 3U);
+  int expected = 5;
+  for (int value : loaded_list) EXPECT_EQ(value, expected++);
+
+  containers::queue<int> q{8, 9, 10};
+  containers::save(q, path);
+  containers::queue<int> loaded_queue;
+  containers::load(loaded_queue, path);
+  EXPECT_EQ(loaded_queue.size(), 3U);
+  for (expected = 8; !loaded_queue.empty(); ++expected) {
+    EXPECT_EQ(loaded_queue.front(), expected);
+    loaded_queue.pop();
+  }
+  EXPECT_EQ(expected, 11);
+  std::remove(path.c_str());
+}
+
+TEST(serialize, tree_round_trip) {
+  std::string path = snapshot_path("trees");
+  containers::map<int, double> map;
+  for (int key = 0; key < 1000; ++key) map.insert((key * 37) % 1000, key);
+  containers::save(map, path);
+  containers::map<int, double> loaded_map{{-1, 0}};
+  containers::load(loaded_map, path);
+  ASSERT_EQ(loaded_map.size(), map.size());
+  for (int key = 0; key < 1000; ++key)
+    EXPECT_EQ(loaded_map.at(key), map.at(key));
+
+  containers::set<int> set{5, 1, 3};
+  containers::save(set, path);
+  containers::set<int> loaded_set;
+  containers::load(loaded_set, path);
+  EXPECT_EQ(loaded_set.size(), 3U);
+  EXPECT_TRUE(loaded_set.contains(3));
+
+  containers::multiset<int> multiset{2, 2, 1, 2};
+  containers::save(multiset, path);
+  containers::multiset<int> loaded_multiset;
+  containers::load(loaded_multiset, path);
+  EXPECT_EQ(loaded_multiset.size(), 4U);
+  EXPECT_EQ(loaded_multiset.count(2), 3U);
+  std::remove(path.c_str());
+}
+
+TEST(serialize, rejects_bad_files) {
+  std::string path = snapshot_path("bad");
+  containers::vector<int> v{1, 2, 3};
+  EXPECT_THROW(containers::load(v, snapshot_path("missing")),
+               std::system_error);
+  containers::save(containers::vector<long>{1, 2}, path);
+  EXPECT_THROW(containers::load(v, path), std::runtime_error);
+  EXPECT_EQ(v.size(), 3U);
+  containers::save(v, path);
+  std::FILE* file = std::fopen(path.c_str(), "r+b");
+  ASSERT_NE(file, nullptr);
+  std::fputc('X', file);
+  std::fclose(file);
+  EXPECT_THROW(containers::load(v, path), std::runtime_error);
+  containers::save(v, path);
+  ASSERT_EQ(truncate(path.c_str(), 64 + 2 * sizeof(int)), 0);
+  EXPECT_THROW(containers::load(v, path), std::runtime_error);
+  ASSERT_EQ(truncate(path.c_str(), 10), 0);
+  EXPECT_THROW(containers::load(v, path), std::runtime_error);
+  EXPECT_EQ(v.size(), 3U);
+  std::remove(path.c_str());
+}
@@ -105,8 +105,423 @@ TEST_F(SetTest, contains) {
   EXPECT_FALSE(set.contains(10));
 }
 
-TEST_F(SetTest, emplace) {
-  set.emplace(0, 1, 2, 3, 4);
+TEST_F(SetTest, insert_many) {
+  set.insert_many(0, 1, 2, 3, 4);
   for (int i = 0; i < 5; ++i) std_set.insert(i);
   eq_set(set, std_set);
 }
+
+TEST(set, sorted_insert_erase) {
+  containers::set<int> set;
+  std::set<int> std_set;
+  for (int i = 0; i < 10000; ++i) {
+    set.insert(i);
+    std_set.insert(i);
+  }
+  for (int i = 20000; i > 10000; --i) {
+    set.insert(i);
+    std_set.insert(i);
+  }
+  for (int i = 0; i < 20000; i += 3) {
+    set.erase(set.find(i));
+    std_set.erase(i);
+  }
+  EXPECT_EQ(set.size(), std_set.size());
+  containers::set<int>::iterator i1 = set.begin();
+  for (int value : std_set) EXPECT_EQ(*(i1++), value);
+  EXPECT_EQ(i1, set.end());
+}
+
+TEST(set, begin_end_stay_valid) {
+  containers::set<int> set;
+  containers::set<int>::iterator end = set.end();
+  EXPECT_EQ(set.begin(), end);
+  for (int i : {5, 3, 8, 1, 9, 7}) set.insert(i);
+  EXPECT_EQ(set.end(), end);
+  EXPECT_EQ(*(set.begin()), 1);
+  EXPECT_EQ(*(--end), 9);
+  set.erase(set.begin());
+  set.erase(end);
+  EXPECT_EQ(*(set.begin()), 3);
+  EXPECT_EQ(*(--(set.end())), 8);
+  EXPECT_EQ(++(set.find(8)), set.end());
+  set.clear();
+  EXPECT_EQ(set.begin(), set.end());
+}
+
+TEST_F(SetTest, order_statistics) {
+  containers::set<int>::iterator i = set.begin();
+  std::set<int>::iterator j = std_set.begin();
+  for (size_t k = 0; k < std_set.size(); ++k, ++i, ++j) {
+    EXPECT_EQ(set.nth(k), i);
+    EXPECT_EQ(set.rank(*j), k);
+  }
+  EXPECT_EQ(set.nth(std_set.size()), set.end());
+  EXPECT_EQ(set.rank(100), std_set.size());
+  EXPECT_EQ(set.count_range(-14, 8),
+            std::distance(std_set.lower_bound(-14), std_set.lower_bound(8)));
+  EXPECT_EQ(set.count_range(8, -14), 0);
+}
+
+TEST(set, allocator) {
+  long live = 0;
+  {
+    containers::set<int, std::less<int>, CountingAllocator<int>> set(
+        CountingAllocator<int>{&live});
+    for (int i = 0; i < 100; ++i) set.insert(i);
+    EXPECT_GT(live, 0);
+  }
+  EXPECT_EQ(live, 0);
+}
+
+TEST(set, compare) {
+  containers::set<int, std::greater<int>> set{3, 1, 2};
+  EXPECT_EQ(*set.begin(), 3);
+  EXPECT_EQ(*set.nth(2), 1);
+  EXPECT_EQ(set.rank(1), 2);
+  EXPECT_FALSE(set.insert(2).second);
+  EXPECT_EQ(set.count(2), 1);
+  EXPECT_EQ(set.count(4), 0);
+}
+
+TEST(set, one_comparison_per_level) {
+  int calls = 0;
+  auto less = [&calls](int a, int b) {
+    ++calls;
+    return a < b;
+  };
+  containers::set<int, decltype(less)> set(less);
+  for (int i = 0; i < 1023; ++i) set.insert(i);
+  for (int i = 0; i < 1023; ++i) {
+    calls = 0;
+    EXPECT_TRUE(set.contains(i));
+    EXPECT_LE(calls, 21);
+  }
+}
+
+TEST(set, sorted_range_constructor) {
+  int calls = 0;
+  auto less = [&calls](int a, int b) {
+    ++calls;
+    return a < b;
+  };
+  std::vector<int> items;
+  for (int i = 0; i < 1000; ++i) items.push_back(i / 2);
+  containers::set<int, decltype(less)> set(items.begin(), items.end(), less);
+  EXPECT_LE(calls, 2000);
+  EXPECT_EQ(set.size(), 500);
+  for (int i = 0; i < 500; ++i) EXPECT_EQ(*set.nth(i), i);
+  EXPECT_EQ(*--set.end(), 499);
+  set.insert(1000);
+  set.erase(set.find(0));
+  EXPECT_EQ(*set.begin(), 1);
+  EXPECT_EQ(*--set.end(), 1000);
+}
+
+TEST_F(SetTest, unsorted_range_constructor) {
+  std::vector<int> items{1, 5, 7, 3, 5, 2, 9};
+  containers::set<int> set(items.begin(), items.end());
+  eq_set(set, std::set<int>(items.begin(), items.end()));
+  set.assign_sorted(items.begin(), items.begin() + 3);
+  eq_set(set, std::set<int>{1, 5, 7});
+  set.assign_sorted(items.end(), items.end());
+  EXPECT_TRUE(set.empty());
+}
+
+TEST_F(SetTest, set_algebra) {
+  std::initializer_list<int> init = {14, 8, 13, 15, 6, 7, 13, 9, 16, -20};
+  std::set<int> std_other(init);
+  for (int op = 0; op < 4; ++op) {
+    containers::set<int> copy(set);
+    containers::set<int> other(init);
+    std::set<int> expected;
+    std::insert_iterator<std::set<int>> out(expected, expected.end());
+    if (op == 0) {
+      copy.set_union(other);
+      std::set_union(std_set.begin(), std_set.end(), std_other.begin(),
+                     std_other.end(), out);
+    } else if (op == 1) {
+      copy.set_intersection(other);
+      std::set_intersection(std_set.begin(), std_set.end(), std_other.begin(),
+                            std_other.end(), out);
+    } else if (op == 2) {
+      copy.set_difference(other);
+      std::set_difference(std_set.begin(), std_set.end(), std_other.begin(),
+                          std_other.end(), out);
+    } else {
+      copy.symmetric_difference(other);
+      std::set_symmetric_difference(std_set.begin(), std_set.end(),
+                                    std_other.begin(), std_other.end(), out);
+    }
+    eq_set(copy, expected);
+    EXPECT_TRUE(other.empty());
+  }
+  containers::set<int> copy(set);
+  copy.set_intersection(copy);
+  eq_set(copy, std_set);
+  copy.symmetric_difference(copy);
+  EXPECT_TRUE(copy.empty());
+}
+
+TEST(set, set_algebra_small_into_large) {
+  int calls = 0;
+  auto less = [&calls](int a, int b) {
+    ++calls;
+    return a < b;
+  };
+  containers::set<int, decltype(less)> large(less);
+  containers::set<int, decltype(less)> small(less);
+  for (int i = 0; i < 65536; ++i) large.insert(2 * i);
+  for (int i = 0; i < 16; ++i) small.insert(8191 * i);
+  calls = 0;
+  large.set_union(small);
+  EXPECT_LE(calls, 4000);
+  EXPECT_EQ(large.size(), 65536 + 8);
+  EXPECT_TRUE(large.contains(8191));
+  EXPECT_EQ(large.rank(8192), 4096 + 1);
+}
+
+TEST(set, set_algebra_allocators) {
+  long live = 0;
+  long other_live = 0;
+  {
+    containers::set<int, std::less<int>, CountingAllocator<int>> set(
+        CountingAllocator<int>{&live});
+    containers::set<int, std::less<int>, CountingAllocator<int>> other(
+        CountingAllocator<int>{&other_live});
+    for (int i = 0; i < 100; ++i) set.insert(i);
+    for (int i = 50; i < 150; ++i) other.insert(i);
+    set.set_union(other);
+    EXPECT_EQ(set.size(), 150);
+    EXPECT_EQ(*set.nth(149), 149);
+    EXPECT_TRUE(other.empty());
+  }
+  EXPECT_EQ(live, 0);
+  EXPECT_EQ(other_live, 0);
+}
+
+TEST(set, merge_relinks_nodes) {
+  long live = 0;
+  long total = 0;
+  {
+    using counting_set =
+        containers::set<int, std::less<int>, CountingAllocator<int>>;
+    counting_set set(CountingAllocator<int>{&live, &total});
+    for (int i = 0; i < 100; i += 2) set.insert(i);
+    {
+      counting_set other(CountingAllocator<int>{&live, &total});
+      for (int i = 0; i < 100; i += 3) other.insert(i);
+      const int* moved = &*other.find(3);
+      long allocations = total;
+      set.merge(other);
+      EXPECT_EQ(total, allocations);
+      EXPECT_EQ(&*set.find(3), moved);
+      EXPECT_EQ(set.size(), 67);
+      EXPECT_EQ(other.size(), 17);
+      EXPECT_TRUE(other.contains(6));
+    }
+    EXPECT_EQ(*set.nth(1), 2);
+    EXPECT_TRUE(set.contains(99));
+    for (int round = 0; round < 10; ++round) {
+      set.clear();
+      for (int i = 0; i < 100; ++i) set.insert(i);
+    }
+    EXPECT_EQ(set.size(), 100);
+  }
+  EXPECT_EQ(live, 0);
+}
+
+TEST(set, parallel) {
+  containers::ThreadPool pool(4);
+  std::mt19937 gen(3);
+  std::vector<int> keys;
+  for (int i = 0; i < 100000; ++i) keys.push_back(gen() % 200000);
+  std::vector<int> others;
+  for (int i = 0; i < 50000; ++i) others.push_back(gen() % 200000);
+  containers::set<int> set;
+  set.assign(keys.begin(), keys.end(), pool);
+  std::set<int> std_set(keys.begin(), keys.end());
+  EXPECT_EQ(set.size(), std_set.size());
+  containers::set<int>::iterator i = set.begin();
+  for (int key : std_set) EXPECT_EQ(*i++, key);
+  containers::set<int> other;
+  other.assign(others.begin(), others.end(), pool);
+  containers::set<int> serial(set);
+  containers::set<int> serial_other(other);
+  set.set_union(other, pool);
+  serial.set_union(serial_other);
+  EXPECT_EQ(set.size(), serial.size());
+  i = set.begin();
+  for (int key : serial) EXPECT_EQ(*i++, key);
+  std::atomic<long long> sum{0};
+  set.for_each([&sum](int key) { sum += key; }, pool);
+  long long expected = 0;
+  for (int key : serial) expected += key;
+  EXPECT_EQ(sum, expected);
+}
+
+TEST_F(SetTest, bounds) {
+  for (int key = -22; key <= 22; ++key) {
+    std::set<int>::iterator std_low = std_set.lower_bound(key);
+    std::set<int>::iterator std_up = std_set.upper_bound(key);
+    containers::set<int>::iterator low = set.lower_bound(key);
+    containers::set<int>::iterator up = set.upper_bound(key);
+    EXPECT_EQ(low == set.end(), std_low == std_set.end());
+    EXPECT_EQ(up == set.end(), std_up == std_set.end());
+    if (std_low != std_set.end()) {
+      EXPECT_EQ(*low, *std_low);
+    }
+    if (std_up != std_set.end()) {
+      EXPECT_EQ(*up, *std_up);
+    }
+    EXPECT_EQ(set.equal_range(key).first, low);
+    EXPECT_EQ(set.equal_range(key).second, up);
+  }
+}
+
+TEST(set, in_place_construction) {
+  containers::set<CopyCounter> set;
+  CopyCounter::reset();
+  EXPECT_TRUE(set.emplace(1, 2).second);
+  EXPECT_TRUE(set.insert(CopyCounter(5)).second);
+  EXPECT_FALSE(set.emplace(3).second);
+  EXPECT_EQ(CopyCounter::copied, 0);
+  EXPECT_EQ(CopyCounter::moved, 1);
+  EXPECT_EQ(set.size(), 2U);
+}
+
+TEST_F(SetTest, extract_insert) {
+  containers::set<int>::node_type nh = set.extract(set.find(-18));
+  std_set.erase(-18);
+  EXPECT_EQ(nh.value(), -18);
+  eq_set(set, std_set);
+  nh.value() = 100;
+  containers::set<int>::insert_return_type res = set.insert(std::move(nh));
+  std_set.insert(100);
+  EXPECT_TRUE(res.inserted);
+  EXPECT_EQ(*res.position, 100);
+  eq_set(set, std_set);
+  res = set.insert(set.extract(100));
+  EXPECT_TRUE(res.inserted);
+  nh = set.extract(8);
+  nh.value() = 15;
+  res = set.insert(std::move(nh));
+  std_set.erase(8);
+  EXPECT_FALSE(res.inserted);
+  EXPECT_EQ(res.node.value(), 15);
+  eq_set(set, std_set);
+}
+
+TEST(set, node_handle_outlives_set_operation) {
+  containers::set<std::string> set{"a", "b"};
+  containers::set<std::string>::node_type nh;
+  {
+    containers::set<std::string> source{"c", "d", "e"};
+    nh = source.extract("d");
+    set.set_union(source);
+  }
+  set.clear();
+  EXPECT_EQ(nh.value(), "d");
+  containers::set<std::string> other;
+  EXPECT_TRUE(other.insert(std::move(nh)).inserted);
+  EXPECT_TRUE(other.contains("d"));
+}
+
+TEST(set, hinted_insert) {
+  int calls = 0;
+  auto less = [&calls](int a, int b) {
+    ++calls;
+    return a < b;
+  };
+  containers::set<int, decltype(less)> set(less);
+  for (int i = 0; i < 1000; ++i) {
+    calls = 0;
+    set.insert(set.end(), 2 * i);
+    EXPECT_LE(calls, 1);
+  }
+  calls = 0;
+  EXPECT_EQ(*set.insert(set.find(10), 11), 11);
+  EXPECT_EQ(*set.emplace_hint(set.find(10), 9), 9);
+  EXPECT_EQ(*set.insert(set.find(10), 10), 10);
+  EXPECT_EQ(set.size(), 1002U);
+  EXPECT_EQ(set.rank(11), 7U);
+}
+
+TEST(set, hinted_insert_matches_std) {
+  std::mt19937 gen(17);
+  std::uniform_int_distribution<int> key(0, 2000);
+  containers::set<int> set;
+  std::set<int> std_set;
+  containers::set<int>::iterator hint = set.end();
+  for (int step = 0; step < 5000; ++step) {
+    int k = step % 4 == 0 ? key(gen) : step;
+    hint = set.insert(step % 3 ? set.end() : hint, k);
+    std_set.insert(k);
+    EXPECT_EQ(*hint, k);
+  }
+  ASSERT_EQ(set.size(), std_set.size());
+  size_t rank = 0;
+  for (int k : std_set) {
+    EXPECT_EQ(*set.nth(rank), k);
+    EXPECT_EQ(set.rank(k), rank++);
+  }
+}
+
+TEST(set, copy_clones_shape) {
+  int calls = 0;
+  auto less = [&calls](int a, int b) {
+    ++calls;
+    return a < b;
+  };
+  containers::set<int, decltype(less)> set(less);
+  for (int i = 0; i < 1023; ++i) set.insert(set.end(), i);
+  calls = 0;
+  containers::set<int, decltype(less)> copy(set);
+  EXPECT_EQ(calls, 0);
+  ASSERT_EQ(copy.size(), set.size());
+  for (int i = 0; i < 1023; ++i) EXPECT_EQ(*copy.nth(i), i);
+  for (int i = 0; i < 1023; ++i) {
+    calls = 0;
+    EXPECT_TRUE(copy.contains(i));
+    EXPECT_LE(calls, 21);
+  }
+  copy.erase(copy.find(5));
+  EXPECT_TRUE(set.contains(5));
+}
+
+TEST_F(SetTest, copy_assignment) {
+  containers::set<int> other{1, 2, 3, 100, 200};
+  other = set;
+  eq_set(other, std_set);
+  containers::set<int> empty;
+  other = empty;
+  EXPECT_TRUE(other.empty());
+  EXPECT_TRUE(other.begin() == other.end());
+  other = set;
+  other = other;
+  eq_set(other, std_set);
+  containers::set<int> moved;
+  moved = std::move(other);
+  eq_set(moved, std_set);
+}
+
+TEST(set, find_many) {
+  containers::set<int> set;
+  for (int i = 0; i < 1000; i += 2) set.insert(i);
+  std::vector<int> keys;
+  for (int i = -5; i < 1005; i += 3) keys.push_back(i);
+  containers::vector<containers::set<int>::iterator> found;
+  set.find_many(keys.begin(), keys.end(), found);
+  containers::vector<bool> present;
+  set.contains_many(keys.begin(), keys.end(), present);
+  ASSERT_EQ(found.size(), keys.size());
+  ASSERT_EQ(present.size(), keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    EXPECT_EQ(found[i], set.find(keys[i]));
+    EXPECT_EQ(present[i], set.contains(keys[i]));
+  }
+  containers::set<int> empty;
+  empty.find_many(keys.begin(), keys.begin() + 3, found);
+  EXPECT_EQ(found.size(), keys.size() + 3);
+  EXPECT_EQ(found[keys.size()], empty.end());
+}
@@ -178,3 +178,16 @@ TEST(bonus_test, test_emplace) {  //
   st_my.emplace_front(1000000);
   ASSERT_EQ(st_my.top(), 1000000);
 }
+
+TEST(test_allocator, stack_allocator) {
+  long live = 0;
+  {
+    containers::stack<int, CountingAllocator<int>> st(
+        CountingAllocator<int>{&live});
+    for (int i = 0; i < 100; ++i) st.push(i);
+    ASSERT_GT(live, 0);
+    ASSERT_EQ(st.top(), 99);
+    ASSERT_EQ(st.size(), 100);
+  }
+  ASSERT_EQ(live, 0);
+}
@@ -0,0 +1,38 @@
+long long parallel_sum(containers::ThreadPool& pool, const int* values,
+                       size_t n) {
+  if (n < 1000) {
+    long long sum = 0;
+    for (size_t i = 0; i < n; ++i) sum += values[i];
+    return sum;
+  }
+  long long left = 0;
+  long long right = 0;
+  pool.invoke([&] { left = parallel_sum(pool, values, n / 2); },
+              [&] { right = parallel_sum(pool, values + n / 2, n - n / 2); });
+  return left + right;
+}
+
+TEST(thread_pool, nested_invoke) {
+  std::vector<int> values(1000000);
+  for (size_t i = 0; i < values.size(); ++i) values[i] = i % 1000;
+  for (size_t threads = 1; threads <= 8; threads *= 2) {
+    containers::ThreadPool pool(threads);
+    EXPECT_EQ(pool.size(), threads);
+    EXPECT_EQ(parallel_sum(pool, values.data(), values.size()),
+              499500LL * 1000);
+  }
+}
+
+TEST(thread_pool, exceptions) {
+  containers::ThreadPool pool(4);
+  bool second_ran = false;
+  EXPECT_THROW(pool.invoke([] { throw std::runtime_error("first"); },
+                           [&] { second_ran = true; }),
+               std::runtime_error);
+  EXPECT_TRUE(second_ran);
+  EXPECT_THROW(pool.invoke([] {}, [] { throw std::out_of_range("second"); }),
+               std::out_of_range);
+  std::atomic<int> calls{0};
+  pool.invoke([&] { ++calls; }, [&] { ++calls; });
+  EXPECT_EQ(calls, 2);
+}
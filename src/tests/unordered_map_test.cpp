@@ -0,0 +1,95 @@
+struct StringHash {
+  using is_transparent = void;
+  size_t operator()(std::string_view s) const {
+    return std::hash<std::string_view>()(s);
+  }
+};
+
+TEST(unordered_map, insert_access) {
+  containers::unordered_map<int, std::string> map{
+      std::pair<int, std::string>{3, "pomodoro"},
+      std::pair<int, std::string>{-1, "cantaloupes"},
+      std::pair<int, std::string>{-1, "marmalade"}};
+  EXPECT_EQ(map.size(), 2);
+  EXPECT_EQ(map.at(-1), "cantaloupes");
+  EXPECT_THROW(map.at(4), std::out_of_range);
+  EXPECT_FALSE(map.insert(3, "chives").second);
+  EXPECT_TRUE(map.insert({4, "chives"}).second);
+  map[5] = "beans";
+  map[3] = "squid";
+  EXPECT_EQ(map.at(3), "squid");
+  EXPECT_EQ(map[6], "");
+  map.insert_or_assign(4, "dates");
+  EXPECT_FALSE(map.insert_or_assign(4, "lettuce").second);
+  EXPECT_EQ(map.at(4), "lettuce");
+  map.find(5)->second = "sazon";
+  EXPECT_EQ(map.at(5), "sazon");
+  EXPECT_EQ(map.size(), 5);
+}
+
+TEST(unordered_map, random_against_std) {
+  containers::unordered_map<long, long> map;
+  std::unordered_map<long, long> std_map;
+  std::mt19937 random(17);
+  for (long i = 0; i < 200000; ++i) {
+    long key = static_cast<long>(random() % 30000) << 32;
+    if (random() % 3 == 0) {
+      EXPECT_EQ(map.erase(key), std_map.erase(key));
+    } else {
+      map[key] += i;
+      std_map[key] += i;
+    }
+  }
+  EXPECT_EQ(map.size(), std_map.size());
+  for (const std::pair<const long, long>& value : std_map)
+    EXPECT_EQ(map.at(value.first), value.second);
+  containers::unordered_map<long, long> copy(map);
+  for (const std::pair<const long, long>& value : std_map)
+    EXPECT_EQ(copy.at(value.first), value.second);
+}
+
+TEST(unordered_map, transparent_lookup) {
+  containers::unordered_map<std::string, int, StringHash, std::equal_to<>>
+      map;
+  for (int i = 0; i < 1000; ++i) map.insert(std::to_string(i), i);
+  EXPECT_EQ(map.at("512"), 512);
+  EXPECT_EQ(map.at(std::string_view("7")), 7);
+  EXPECT_TRUE(map.contains("999"));
+  EXPECT_EQ(map.count("1000"), 0);
+  EXPECT_EQ(map.find(std::string_view("1000")), map.end());
+}
+
+TEST(unordered_map, in_place_construction) {
+  containers::unordered_map<int, CopyCounter> map;
+  map.reserve(8);
+  CopyCounter::reset();
+  EXPECT_TRUE(map.try_emplace(1, 10).second);
+  EXPECT_TRUE(map.try_emplace(2, 7, 13).second);
+  EXPECT_EQ(CopyCounter::constructed, 2);
+  EXPECT_EQ(CopyCounter::copied + CopyCounter::moved, 0);
+  CopyCounter::reset();
+  EXPECT_FALSE(map.try_emplace(1, 99).second);
+  EXPECT_EQ(CopyCounter::constructed, 0);
+  EXPECT_TRUE(map.emplace(3, 30).second);
+  EXPECT_FALSE(map.emplace(3, 31).second);
+  EXPECT_EQ(CopyCounter::copied, 0);
+  EXPECT_EQ(CopyCounter::moved, 1);
+  EXPECT_EQ(map.at(1).value, 10);
+  EXPECT_EQ(map.at(2).value, 20);
+  EXPECT_EQ(map.at(3).value, 30);
+}
+
+TEST(unordered_map, insert_many) {
+  containers::unordered_map<int, int> map;
+  containers::vector<std::pair<containers::unordered_map<int, int>::iterator,
+                               bool>>
+      res = map.insert_many(std::pair<const int, int>(1, 10),
+                            std::pair<const int, int>(2, 20),
+                            std::pair<const int, int>(1, 30));
+  ASSERT_EQ(res.size(), 3U);
+  EXPECT_TRUE(res[0].second);
+  EXPECT_TRUE(res[1].second);
+  EXPECT_FALSE(res[2].second);
+  EXPECT_EQ(map.size(), 2U);
+  EXPECT_EQ(map.at(1), 10);
+}
@@ -0,0 +1,129 @@
+class UnorderedSetTest : public ::testing::Test {
+ protected:
+  containers::unordered_set<int> set{8,   20,  -14, -18, 1,  -18, -8,
+                                     -20, -14, -12, -9,  15, -19, -17,
+                                     -3,  7,   4,   -12, -17, -14, -20};
+  std::unordered_set<int> std_set{8,   20,  -14, -18, 1,  -18, -8,
+                                  -20, -14, -12, -9,  15, -19, -17,
+                                  -3,  7,   4,   -12, -17, -14, -20};
+  void eq_set(const containers::unordered_set<int>& set,
+              const std::unordered_set<int>& std_set);
+};
+
+void UnorderedSetTest::eq_set(const containers::unordered_set<int>& set,
+                              const std::unordered_set<int>& std_set) {
+  EXPECT_EQ(set.size(), std_set.size());
+  size_t n = 0;
+  for (containers::unordered_set<int>::iterator i = set.begin();
+       i != set.end(); ++i, ++n)
+    EXPECT_EQ(std_set.count(*i), 1);
+  EXPECT_EQ(n, std_set.size());
+}
+
+TEST(unordered_set, default_constructor_empty) {
+  containers::unordered_set<int> set;
+  EXPECT_TRUE(set.empty());
+  EXPECT_EQ(set.begin(), set.end());
+  EXPECT_EQ(set.find(1), set.end());
+  EXPECT_EQ(set.erase(1), 0);
+}
+
+TEST_F(UnorderedSetTest, init_constructor_insert) {
+  eq_set(set, std_set);
+  EXPECT_FALSE(set.insert(8).second);
+  EXPECT_EQ(*set.insert(9).first, 9);
+  std_set.insert(9);
+  eq_set(set, std_set);
+}
+
+TEST_F(UnorderedSetTest, copy_move) {
+  containers::unordered_set<int> copy(set);
+  eq_set(copy, std_set);
+  containers::unordered_set<int> moved(std::move(copy));
+  eq_set(moved, std_set);
+  copy = std::move(moved);
+  eq_set(copy, std_set);
+}
+
+TEST_F(UnorderedSetTest, erase_clear) {
+  set.erase(set.find(8));
+  EXPECT_EQ(set.erase(20), 1);
+  EXPECT_EQ(set.erase(20), 0);
+  std_set.erase(8);
+  std_set.erase(20);
+  eq_set(set, std_set);
+  set.clear();
+  EXPECT_TRUE(set.empty());
+  EXPECT_EQ(set.begin(), set.end());
+  EXPECT_FALSE(set.contains(1));
+}
+
+TEST(unordered_set, random_insert_erase) {
+  containers::unordered_set<int> set;
+  std::unordered_set<int> std_set;
+  std::mt19937 random(13);
+  for (int i = 0; i < 200000; ++i) {
+    int key = static_cast<int>(random() % 20000) * 1024;
+    if (random() % 2 == 0)
+      EXPECT_EQ(set.erase(key), std_set.erase(key));
+    else
+      EXPECT_EQ(set.insert(key).second, std_set.insert(key).second);
+  }
+  EXPECT_EQ(set.size(), std_set.size());
+  for (int key : std_set) EXPECT_TRUE(set.contains(key));
+  size_t n = 0;
+  for (containers::unordered_set<int>::iterator i = set.begin();
+       i != set.end(); ++i)
+    ++n;
+  EXPECT_EQ(n, std_set.size());
+}
+
+TEST(unordered_set, reserve_load_factor) {
+  containers::unordered_set<int> set;
+  set.reserve(1000);
+  size_t buckets = set.bucket_count();
+  EXPECT_GE(buckets * set.max_load_factor(), 1000);
+  for (int i = 0; i < 1000; ++i) set.insert(i);
+  EXPECT_EQ(set.bucket_count(), buckets);
+  EXPECT_LE(set.load_factor(), set.max_load_factor());
+  set.max_load_factor(0.5f);
+  EXPECT_LE(set.load_factor(), 0.5f);
+  for (int i = 1000; i < 1100; ++i) set.insert(i);
+  EXPECT_LE(set.load_factor(), 0.5f);
+  EXPECT_GT(set.bucket_count(), buckets);
+  for (int i = 0; i < 1000; ++i) EXPECT_TRUE(set.contains(i));
+  set.rehash(100000);
+  EXPECT_GE(set.bucket_count(), 100000);
+  EXPECT_EQ(set.size(), 1100);
+  EXPECT_TRUE(set.contains(1099));
+}
+
+TEST(unordered_set, allocator) {
+  long live = 0;
+  {
+    containers::unordered_set<std::string, std::hash<std::string>,
+                              std::equal_to<std::string>,
+                              CountingAllocator<std::string>>
+        set(CountingAllocator<std::string>{&live});
+    for (int i = 0; i < 1000; ++i) set.insert(std::to_string(i));
+    EXPECT_EQ(live, 2);
+    set.clear();
+    EXPECT_EQ(live, 2);
+  }
+  EXPECT_EQ(live, 0);
+}
+
+TEST(unordered_set, emplace_insert_many) {
+  containers::unordered_set<std::string> set;
+  EXPECT_TRUE(set.emplace(3, 'a').second);
+  EXPECT_FALSE(set.emplace("aaa").second);
+  EXPECT_TRUE(set.contains("aaa"));
+  containers::vector<
+      std::pair<containers::unordered_set<std::string>::iterator, bool>>
+      res = set.insert_many("b", "aaa", "c");
+  ASSERT_EQ(res.size(), 3U);
+  EXPECT_TRUE(res[0].second);
+  EXPECT_FALSE(res[1].second);
+  EXPECT_TRUE(res[2].second);
+  EXPECT_EQ(set.size(), 3U);
+}
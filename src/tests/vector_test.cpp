@@ -90,6 +90,15 @@ TEST_F(VectorTest, reserve) {
   eq_vector(vector, std_vector);
 }
 
+TEST(vector, reserve_empty) {
+  containers::vector<int> vector;
+  vector.reserve(4);
+  EXPECT_TRUE(vector.empty());
+  EXPECT_EQ(vector.size(), 0);
+  vector.push_back(1);
+  EXPECT_EQ(vector.size(), 1);
+}
+
 TEST_F(VectorTest, shrink_to_fit) {
   vector.shrink_to_fit();
   std_vector.shrink_to_fit();
@@ -166,3 +175,17 @@ TEST_F(VectorTest, emplace) {
   std_vector.push_back(9);
   eq_vector(vector, std_vector);
 }
+
+TEST(vector, allocator) {
+  long live = 0;
+  {
+    CountingAllocator<int> alloc(&live);
+    containers::vector<int, CountingAllocator<int>> vector(alloc);
+    for (int i = 0; i < 100; ++i) vector.push_back(i);
+    EXPECT_GT(live, 0);
+    containers::vector<int, CountingAllocator<int>> copy(vector);
+    EXPECT_EQ(copy.get_allocator(), alloc);
+    EXPECT_EQ(copy[99], 99);
+  }
+  EXPECT_EQ(live, 0);
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace containers {
+// Fixed set of threads for fork-join parallelism. invoke runs two functions,
+// possibly at the same time: the calling thread runs the first one, and
+// while the second one is running elsewhere it runs other queued work
+// instead of blocking, so nested invokes cannot starve the pool. A pool of n
+// threads starts n - 1 workers, the caller being the n-th, so a pool of one
+// thread runs everything on the caller.
+class ThreadPool {
+ public:
+  using size_type = size_t;
+
+  explicit ThreadPool(size_type threads = default_threads()) : stop_(false) {
+    for (size_type i = 1; i < threads; ++i)
+      workers_.emplace_back([this] { work(); });
+  }
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    ready_.notify_all();
+    for (std::thread& worker : workers_) worker.join();
+  }
+
+  // Pool with one thread per hardware thread, for callers that do not need
+  // their own.
+  static ThreadPool& shared() {
+    static ThreadPool pool;
+    return pool;
+  }
+
+  static size_type default_threads() {
+    return std::max<size_type>(1, std::thread::hardware_concurrency());
+  }
+
+  size_type size() const { return workers_.size() + 1; }
+
+  // Returns once both functions have returned. If either throws, the
+  // exception is rethrown after both are done, the first one's first.
+  template <class F, class G>
+  void invoke(F&& first, G&& second) {
+    if (workers_.empty()) {
+      first();
+      second();
+      return;
+    }
+    Task task(&call<typename std::remove_reference<G>::type>, &second);
+    push(&task);
+    std::exception_ptr error;
+    try {
+      first();
+    } catch (...) {
+      error = std::current_exception();
+    }
+    if (take(&task)) {
+      task.run();
+    } else {
+      while (!task.done.load(std::memory_order_acquire))
+        if (!run_one()) std::this_thread::yield();
+    }
+    if (error) std::rethrow_exception(error);
+    if (task.error) std::rethrow_exception(task.error);
+  }
+
+ private:
+  struct Task {
+    Task(void (*function)(void*), void* argument)
+        : function(function), argument(argument) {}
+
+    void (*function)(void*);
+    void* argument;
+    std::atomic<bool> done{false};
+    std::exception_ptr error;
+
+    void run() {
+      try {
+        function(argument);
+      } catch (...) {
+        error = std::current_exception();
+      }
+      done.store(true, std::memory_order_release);
+    }
+  };
+
+  std::vector<std::thread> workers_;
+  std::deque<Task*> tasks_;
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  bool stop_;
+
+  template <class F>
+  static void call(void* f) {
+    (*static_cast<F*>(f))();
+  }
+
+  void push(Task* task) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      tasks_.push_back(task);
+    }
+    ready_.notify_one();
+  }
+
+  // Removes the task from the queue if no thread has started it yet.
+  bool take(Task* task) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::deque<Task*>::reverse_iterator i =
+        std::find(tasks_.rbegin(), tasks_.rend(), task);
+    if (i == tasks_.rend()) return false;
+    tasks_.erase(std::next(i).base());
+    return true;
+  }
+
+  // Runs the oldest queued task, which covers the most work, if there is one.
+  bool run_one() {
+    Task* task = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (tasks_.empty()) return false;
+      task = tasks_.front();
+      tasks_.pop_front();
+    }
+    task->run();
+    return true;
+  }
+
+  void work() {
+    for (;;) {
+      Task* task = nullptr;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ready_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+        if (tasks_.empty()) return;
+        task = tasks_.front();
+        tasks_.pop_front();
+      }
+      task->run();
+    }
+  }
+};
+}  // namespace containers
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <stdexcept>
+#include <tuple>
+
+#include "hash_table.h"
+#include "vector.h"
+
+namespace containers {
+template <class Key, class T, class Hash = std::hash<Key>,
+          class KeyEqual = std::equal_to<Key>,
+          class Allocator = std::allocator<std::pair<const Key, T>>>
+class unordered_map
+    : public containers::HashTable<
+          std::pair<const Key, T>,
+          containers::SelectFirst<std::pair<const Key, T>>, Hash, KeyEqual,
+          Allocator> {
+ public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<const key_type, mapped_type>;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using size_type = size_t;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using allocator_type = Allocator;
+  using table =
+      containers::HashTable<value_type, containers::SelectFirst<value_type>,
+                            Hash, KeyEqual, Allocator>;
+
+  using iterator = typename table::iterator;
+  using const_iterator = typename table::const_iterator;
+
+  unordered_map() : table::HashTable() {}
+  explicit unordered_map(size_type bucket_count, const Hash& hash = Hash(),
+                         const KeyEqual& equal = KeyEqual(),
+                         const Allocator& alloc = Allocator())
+      : table::HashTable(bucket_count, hash, equal, alloc) {}
+  explicit unordered_map(const Allocator& alloc) : table::HashTable(alloc) {}
+  explicit unordered_map(std::initializer_list<value_type> const& items,
+                         const Allocator& alloc = Allocator())
+      : table::HashTable(alloc) {
+    this->reserve(items.size());
+    for (const value_type& item : items) insert(item);
+  }
+  unordered_map(const unordered_map& m) : table::HashTable(m) {}
+  unordered_map(unordered_map&& m) : table::HashTable(std::move(m)) {}
+  ~unordered_map() {}
+
+  unordered_map& operator=(unordered_map&& m) {
+    table::operator=(std::move(m));
+    return *this;
+  }
+
+  T& at(const Key& key) { return at_key(key); }
+
+  template <class K, class H = Hash, class E = KeyEqual,
+            class = typename H::is_transparent,
+            class = typename E::is_transparent>
+  T& at(const K& key) {
+    return at_key(key);
+  }
+
+  T& operator[](const Key& key) {
+    return std::get<0>(this->insert_unique(key, std::piecewise_construct,
+                                           std::forward_as_tuple(key),
+                                           std::tuple<>()))
+        ->second;
+  }
+
+  std::pair<iterator, bool> insert(const value_type& value) {
+    return this->insert_unique(std::get<0>(value), value);
+  }
+
+  std::pair<iterator, bool> insert(const Key& key, const T& obj) {
+    return this->insert_unique(key, key, obj);
+  }
+
+  std::pair<iterator, bool> insert_or_assign(const Key& key, const T& obj) {
+    std::pair<iterator, bool> res = this->insert_unique(key, key, obj);
+    if (!std::get<1>(res)) std::get<0>(res)->second = obj;
+    return res;
+  }
+
+  // Builds the element from args and moves it into its slot. try_emplace
+  // constructs it in the slot when the key is at hand.
+  template <class... Args>
+  std::pair<iterator, bool> emplace(Args&&... args) {
+    std::pair<Key, T> value(std::forward<Args>(args)...);
+    return this->insert_unique(value.first, std::move(value.first),
+                               std::move(value.second));
+  }
+
+  // Constructs the mapped value from args in its slot if key is not present,
+  // and leaves args untouched otherwise.
+  template <class... Args>
+  std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+    return this->insert_unique(
+        key, std::piecewise_construct, std::forward_as_tuple(key),
+        std::forward_as_tuple(std::forward<Args>(args)...));
+  }
+
+  template <class... Args>
+  std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args) {
+    return this->insert_unique(
+        key, std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+        std::forward_as_tuple(std::forward<Args>(args)...));
+  }
+
+  // Inserts every argument in turn.
+  template <class... Args>
+  containers::vector<std::pair<iterator, bool>> insert_many(Args&&... args) {
+    containers::vector<std::pair<iterator, bool>> v;
+    (v.push_back(insert(std::forward<Args>(args))), ...);
+    return v;
+  }
+
+ private:
+  template <class K>
+  T& at_key(const K& key) {
+    iterator i = this->find(key);
+    if (i == this->end())
+      throw std::out_of_range("There's no obj in map with such key");
+    return i->second;
+  }
+};
+}  // namespace containers
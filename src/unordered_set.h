@@ -0,0 +1,67 @@
+#pragma once
+
+#include "hash_table.h"
+#include "vector.h"
+
+namespace containers {
+template <class Key, class Hash = std::hash<Key>,
+          class KeyEqual = std::equal_to<Key>,
+          class Allocator = std::allocator<Key>>
+class unordered_set
+    : public containers::HashTable<Key, containers::Identity<Key>, Hash,
+                                   KeyEqual, Allocator> {
+ public:
+  using key_type = Key;
+  using value_type = Key;
+  using size_type = size_t;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using allocator_type = Allocator;
+  using table = containers::HashTable<Key, containers::Identity<Key>, Hash,
+                                      KeyEqual, Allocator>;
+
+  using iterator = typename table::iterator;
+  using const_iterator = typename table::const_iterator;
+
+  unordered_set() : table::HashTable() {}
+  explicit unordered_set(size_type bucket_count, const Hash& hash = Hash(),
+                         const KeyEqual& equal = KeyEqual(),
+                         const Allocator& alloc = Allocator())
+      : table::HashTable(bucket_count, hash, equal, alloc) {}
+  explicit unordered_set(const Allocator& alloc) : table::HashTable(alloc) {}
+  explicit unordered_set(std::initializer_list<value_type> const& items,
+                         const Allocator& alloc = Allocator())
+      : table::HashTable(alloc) {
+    this->reserve(items.size());
+    for (const value_type& item : items) insert(item);
+  }
+  unordered_set(const unordered_set& s) : table::HashTable(s) {}
+  unordered_set(unordered_set&& s) : table::HashTable(std::move(s)) {}
+  ~unordered_set() {}
+
+  unordered_set& operator=(unordered_set&& s) {
+    table::operator=(std::move(s));
+    return *this;
+  }
+
+  std::pair<iterator, bool> insert(const value_type& value) {
+    return this->insert_unique(value, value);
+  }
+
+  // Builds the key from args and moves it into its slot unless it is
+  // present.
+  template <class... Args>
+  std::pair<iterator, bool> emplace(Args&&... args) {
+    value_type value(std::forward<Args>(args)...);
+    return this->insert_unique(value, std::move(value));
+  }
+
+  // Inserts every argument in turn.
+  template <class... Args>
+  containers::vector<std::pair<iterator, bool>> insert_many(Args&&... args) {
+    containers::vector<std::pair<iterator, bool>> v;
+    (v.push_back(insert(std::forward<Args>(args))), ...);
+    return v;
+  }
+};
+}  // namespace containers
@@ -2,16 +2,18 @@
 
 #include <cstdint>
 #include <limits>
+#include <memory>
 #include <stdexcept>
 
 namespace containers {
-template <class T>
+template <class T, class Allocator = std::allocator<T>>
 class vector {
  public:
   using value_type = T;
   using reference = T&;
   using const_reference = const T&;
   using size_type = size_t;
+  using allocator_type = Allocator;
 
   class VectorIterator {
    public:
@@ -97,32 +99,41 @@ class vector {
 
   using const_iterator = VectorConstIterator;
 
-  vector() : data_(nullptr), back_(data_), capacity_(0) {}
+  vector() : vector(Allocator()) {}
 
-  explicit vector(size_type n)
-      : data_(new value_type[n]()), back_(data_ + n - 1), capacity_(n) {}
+  explicit vector(const Allocator& alloc)
+      : data_(nullptr), back_(data_), capacity_(0), allocator_(alloc) {}
 
-  explicit vector(std::initializer_list<value_type> const& items)
-      : vector(items.size()) {
+  explicit vector(size_type n, const Allocator& alloc = Allocator())
+      : data_(nullptr), back_(nullptr), capacity_(n), allocator_(alloc) {
+    data_ = allocate_data(n);
+    back_ = data_ + n - 1;
+  }
+
+  explicit vector(std::initializer_list<value_type> const& items,
+                  const Allocator& alloc = Allocator())
+      : vector(items.size(), alloc) {
     typename std::initializer_list<value_type>::iterator j = items.begin();
     for (size_type i = 0; i < items.size() && j != items.end(); ++i, ++j)
       data_[i] = *j;
   }
 
-  vector(const vector& v) : vector(v.size()) {
+  vector(const vector& v)
+      : vector(v.size(), std::allocator_traits<Allocator>::
+                             select_on_container_copy_construction(
+                                 v.allocator_)) {
     iterator i = begin();
     iterator j = v.begin();
     while (i != end()) *(i++) = *(j++);
   }
 
-  vector(vector&& v) : data_(nullptr), back_(nullptr), capacity_(0) {
-    std::swap(data_, v.data_);
-    std::swap(back_, v.back_);
-    std::swap(capacity_, v.capacity_);
+  vector(vector&& v)
+      : data_(nullptr), back_(nullptr), capacity_(0), allocator_(v.allocator_) {
+    swap(v);
   }
 
   ~vector() {
-    if (data_ != nullptr) delete[] data_;
+    if (data_ != nullptr) deallocate_data(data_, capacity_);
     data_ = nullptr;
     back_ = nullptr;
     capacity_ = 0;
@@ -130,15 +141,15 @@ class vector {
 
   vector& operator=(vector&& v) {
     if (&v == this) return *this;
-    if (data_ != nullptr) delete[] data_;
+    if (data_ != nullptr) deallocate_data(data_, capacity_);
     data_ = nullptr, back_ = nullptr;
     capacity_ = 0;
-    std::swap(data_, v.front_);
-    std::swap(back_, v.back_);
-    std::swap(capacity_, v.capacity_);
+    swap(v);
     return *this;
   }
 
+  allocator_type get_allocator() const { return allocator_; }
+
   reference at(size_type pos) {
     if (pos >= size())
       throw std::out_of_range(
@@ -152,6 +163,7 @@ class vector {
   const_reference back() { return *back_; }
 
   value_type* data() { return data_; }
+  const value_type* data() const { return data_; }
 
   iterator begin() const { return iterator(data_); }
   iterator end() const {
@@ -164,15 +176,7 @@ class vector {
 
   bool empty() { return begin() == end(); }
 
-  size_type size() const {
-    size_type result = 0;
-    iterator i = begin();
-    while (i != end()) {
-      ++result;
-      ++i;
-    }
-    return result;
-  }
+  size_type size() const { return back_ == nullptr ? 0 : back_ - data_ + 1; }
 
   size_type max_size() {
     return (std::numeric_limits<intmax_t>::max()) / sizeof(value_type);
@@ -195,8 +199,9 @@ class vector {
     if (pos != end()) {
       value_type* i;
       if (size() == capacity_) {
+        size_type old_capacity = capacity_;
         capacity_ = capacity_ ? capacity_ * 2 : 1;
-        value_type* new_data = new value_type[capacity_];
+        value_type* new_data = allocate_data(capacity_);
         i = new_data;
         for (value_type* j = data_; iterator(j) != end(); ++i) {
           if (iterator(j) == pos) {
@@ -207,7 +212,7 @@ class vector {
         }
 
         back_ = --i;
-        delete[] data_;
+        deallocate_data(data_, old_capacity);
         data_ = new_data;
       } else {
         i = back_ + 1;
@@ -262,6 +267,7 @@ class vector {
     std::swap(data_, other.data_);
     std::swap(back_, other.back_);
     std::swap(capacity_, other.capacity_);
+    std::swap(allocator_, other.allocator_);
   }
 
   template <class... Args>
@@ -282,16 +288,40 @@ class vector {
   }
 
  private:
+  using allocator_traits = std::allocator_traits<Allocator>;
+
   value_type *data_, *back_;
   size_type capacity_;
+  allocator_type allocator_;
+
+  // Every slot of the storage holds a constructed element, as elements are
+  // assigned in place when the vector grows.
+  value_type* allocate_data(size_type n) {
+    value_type* data = allocator_traits::allocate(allocator_, n);
+    size_type i = 0;
+    try {
+      for (; i < n; ++i) allocator_traits::construct(allocator_, data + i);
+    } catch (...) {
+      while (i) allocator_traits::destroy(allocator_, data + --i);
+      allocator_traits::deallocate(allocator_, data, n);
+      throw;
+    }
+    return data;
+  }
+
+  void deallocate_data(value_type* data, size_type n) {
+    for (size_type i = 0; i < n; ++i)
+      allocator_traits::destroy(allocator_, data + i);
+    allocator_traits::deallocate(allocator_, data, n);
+  }
 
   void reallocate(size_type size) {
-    value_type* new_data = new value_type[size];
+    value_type* new_data = allocate_data(size);
     if (!empty()) {
       for (size_type i = 0; i < this->size(); ++i) new_data[i] = data_[i];
     }
-    back_ = this->size() ? new_data + this->size() - 1 : new_data;
-    if (data_ != nullptr) delete[] data_;
+    back_ = this->size() ? new_data + this->size() - 1 : nullptr;
+    if (data_ != nullptr) deallocate_data(data_, capacity_);
     data_ = new_data;
     capacity_ = size;
   }